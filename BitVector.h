@@ -0,0 +1,166 @@
+#ifndef BITVECTOR_H
+#define BITVECTOR_H
+
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include <initializer_list>
+
+#include <QtGlobal>
+#include <QVarLengthArray>
+
+/**
+ * BitVector is a string of bits packed into 64-bit words, most
+ * significant bit first, for the frame packers in Varicode and JSC.
+ *
+ * Values go in and come out up to 64 bits at a time, so a field of a
+ * frame is one shift and mask instead of a loop over bools. The first
+ * 128 bits are stored inline, so building a 72 bit frame never touches
+ * the heap.
+ *
+ * Bits past size() in the last word are always zero.
+ */
+class BitVector
+{
+public:
+    BitVector() : m_size(0) {}
+
+    BitVector(std::initializer_list<bool> bits) : m_size(0) {
+        for(bool bit : bits){
+            append(bit);
+        }
+    }
+
+    int size() const { return m_size; }
+    int length() const { return m_size; }
+    int count() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    void clear(){
+        m_words.clear();
+        m_size = 0;
+    }
+
+    bool at(int i) const {
+        Q_ASSERT(i >= 0 && i < m_size);
+        return (m_words[i >> 6] >> (63 - (i & 63))) & 1;
+    }
+
+    // the n bits from pos as an integer, n at most 64
+    quint64 value(int pos, int n) const {
+        Q_ASSERT(n >= 0 && n <= 64 && pos >= 0 && pos + n <= m_size);
+        if(n == 0){
+            return 0;
+        }
+
+        int word = pos >> 6;
+        int offset = pos & 63;
+        quint64 bits = m_words[word] << offset;
+        if(offset + n > 64){
+            bits |= m_words[word + 1] >> (64 - offset);
+        }
+        return bits >> (64 - n);
+    }
+
+    // the bits from pos, to the end where n is negative or runs past it
+    BitVector mid(int pos, int n=-1) const {
+        BitVector out;
+        if(pos < 0 || pos > m_size){
+            return out;
+        }
+        if(n < 0 || n > m_size - pos){
+            n = m_size - pos;
+        }
+        for(int i = 0; i < n; i += 64){
+            int chunk = qMin(64, n - i);
+            out.append(value(pos + i, chunk), chunk);
+        }
+        return out;
+    }
+
+    int lastIndexOf(bool bit) const {
+        for(int i = m_size - 1; i >= 0; i--){
+            if(at(i) == bit){
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void append(bool bit){
+        append(bit ? 1 : 0, 1);
+    }
+
+    // the low n bits of value, n at most 64
+    void append(quint64 value, int n){
+        Q_ASSERT(n >= 0 && n <= 64);
+        if(n == 0){
+            return;
+        }
+        if(n < 64){
+            value &= (quint64(1) << n) - 1;
+        }
+
+        int offset = m_size & 63;
+        if(offset == 0){
+            m_words.append(0);
+        }
+
+        int room = 64 - offset;
+        if(n <= room){
+            m_words[m_words.size() - 1] |= value << (room - n);
+        } else {
+            m_words[m_words.size() - 1] |= value >> (n - room);
+            m_words.append(value << (64 - (n - room)));
+        }
+        m_size += n;
+    }
+
+    void append(BitVector const &other){
+        if(m_size & 63){
+            for(int i = 0; i < other.m_size; i += 64){
+                int chunk = qMin(64, other.m_size - i);
+                append(other.value(i, chunk), chunk);
+            }
+        } else {
+            // word aligned, the words copy straight over
+            m_words.append(other.m_words.constData(), other.m_words.size());
+            m_size += other.m_size;
+        }
+    }
+
+    BitVector &operator+=(BitVector const &other){ append(other); return *this; }
+    BitVector &operator<<(BitVector const &other){ append(other); return *this; }
+    BitVector &operator<<(bool bit){ append(bit); return *this; }
+
+    bool operator==(BitVector const &other) const {
+        return m_size == other.m_size && m_words == other.m_words;
+    }
+    bool operator!=(BitVector const &other) const { return !(*this == other); }
+
+private:
+    QVarLengthArray<quint64, 2> m_words;
+    int m_size;
+};
+
+inline BitVector operator+(BitVector left, BitVector const &right){
+    left.append(right);
+    return left;
+}
+
+#endif // BITVECTOR_H
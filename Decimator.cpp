@@ -0,0 +1,132 @@
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+
+#include "Decimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define DECIMATOR_SSE 1
+#endif
+
+size_t const Decimator::factor;
+size_t const Decimator::taps;
+size_t const Decimator::chunk;
+
+namespace
+{
+  // the coefficients of fil4.f90, after three zeros so the first real
+  // tap lines up with the first sample of its window
+  float const w[52] = {
+    0.f, 0.f, 0.f,
+    0.000861074040f, 0.010051920210f, 0.010161983649f, 0.011363155076f,
+    0.008706594219f, 0.002613872664f,-0.005202883094f,-0.011720748164f,
+   -0.013752163325f,-0.009431602741f, 0.000539063909f, 0.012636767098f,
+    0.021494659597f, 0.021951235065f, 0.011564169382f,-0.007656470131f,
+   -0.028965787341f,-0.042637874109f,-0.039203309748f,-0.013153301537f,
+    0.034320769178f, 0.094717832646f, 0.154224604789f, 0.197758325022f,
+    0.213715139513f, 0.197758325022f, 0.154224604789f, 0.094717832646f,
+    0.034320769178f,-0.013153301537f,-0.039203309748f,-0.042637874109f,
+   -0.028965787341f,-0.007656470131f, 0.011564169382f, 0.021951235065f,
+    0.021494659597f, 0.012636767098f, 0.000539063909f,-0.009431602741f,
+   -0.013752163325f,-0.011720748164f,-0.005202883094f, 0.002613872664f,
+    0.008706594219f, 0.011363155076f, 0.010161983649f, 0.010051920210f,
+    0.000861074040f
+  };
+
+  inline float dot52 (float const * x)
+  {
+#if DECIMATOR_SSE
+    __m128 a0 = _mm_setzero_ps ();
+    __m128 a1 = _mm_setzero_ps ();
+    for (int i = 0; i < 48; i += 8)
+      {
+        a0 = _mm_add_ps (a0, _mm_mul_ps (_mm_loadu_ps (w + i), _mm_loadu_ps (x + i)));
+        a1 = _mm_add_ps (a1, _mm_mul_ps (_mm_loadu_ps (w + i + 4), _mm_loadu_ps (x + i + 4)));
+      }
+    a0 = _mm_add_ps (a0, _mm_mul_ps (_mm_loadu_ps (w + 48), _mm_loadu_ps (x + 48)));
+    a0 = _mm_add_ps (a0, a1);
+    float s[4];
+    _mm_storeu_ps (s, a0);
+    return (s[0] + s[1]) + (s[2] + s[3]);
+#else
+    // four running sums the compiler can keep in one vector register
+    float s[4] = {0.f, 0.f, 0.f, 0.f};
+    for (int i = 0; i < 52; i += 4)
+      {
+        for (int j = 0; j < 4; ++j)
+          {
+            s[j] += w[i + j] * x[i + j];
+          }
+      }
+    return (s[0] + s[1]) + (s[2] + s[3]);
+#endif
+  }
+
+  inline short saturate (float y)
+  {
+    // nint() rounds half away from zero, as std::lround does
+    long v = std::lround (y);
+    return static_cast<short> (std::max (-32768L, std::min (32767L, v)));
+  }
+}
+
+Decimator::Decimator ()
+{
+  reset ();
+}
+
+void Decimator::reset ()
+{
+  // fil4 starts with an all zero delay line, so does this: the window
+  // of the first output is 45 zeros and the first 4 input samples
+  m_fill = taps - factor;
+  std::fill (m_x, m_x + m_fill, 0.f);
+}
+
+size_t Decimator::process (short const * in, size_t numFrames, short * out)
+{
+  size_t written {0};
+  while (numFrames)
+    {
+      size_t n {std::min (numFrames, taps + chunk - m_fill)};
+      for (size_t i = 0; i < n; ++i)
+        {
+          m_x[m_fill + i] = in[i];
+        }
+      m_fill += n;
+      in += n;
+      numFrames -= n;
+
+      // one output for each full window, stepping four samples at a time
+      size_t start {0};
+      for (; start + taps <= m_fill; start += factor)
+        {
+          out[written++] = saturate (dot52 (&m_x[start]));
+        }
+
+      // keep what the next window needs, at least the last 48 samples
+      m_fill -= start;
+      std::memmove (m_x, m_x + start, m_fill * sizeof (m_x[0]));
+    }
+  return written;
+}
@@ -0,0 +1,65 @@
+#ifndef DECIMATOR_HPP__
+#define DECIMATOR_HPP__
+
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+
+#include <cstddef>
+
+//
+// streaming 4:1 down sampler, 48000 Hz to 12000 Hz
+//
+// this is the low pass FIR of lib/fil4.f90 (49 taps, fc 4500 Hz, 40 dB
+// stop band from 6000 Hz) with the output rate reduced by four, but
+// only every fourth output is ever computed and the history is carried
+// across calls so the input can come in blocks of any size, not only
+// multiples of four
+//
+// the state is not shared, a Decimator is meant to be used from one
+// thread at a time
+//
+class Decimator
+{
+public:
+  static size_t const factor {4};
+
+  Decimator ();
+
+  void reset ();		// forget the history, as if fed silence
+
+  // the most samples process() can produce from numFrames more input
+  size_t maxOutput (size_t numFrames) const
+  {
+    return (m_fill - (taps - factor) + numFrames) / factor;
+  }
+
+  // down sample numFrames input samples into out, returns the number
+  // of output samples written
+  size_t process (short const * in, size_t numFrames, short * out);
+
+private:
+  // 49 taps with three leading zeros so an inner product is 13 lots of 4
+  static size_t const taps {52};
+  static size_t const chunk {1024};
+
+  size_t m_fill;		// samples held in m_x, the history
+  float m_x[taps + chunk];
+};
+
+#endif
@@ -0,0 +1,215 @@
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+
+#include "DecodeTrace.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QVector>
+
+namespace {
+    // samples kept per stage, enough for the tail percentiles to mean
+    // something without holding on to stale conditions for too long
+    int const WINDOW = 1024;
+
+    struct Samples {
+        QVector<qint64> ns;
+        int next = 0;
+        qint64 total = 0;
+    };
+
+    QMutex traceLock;
+    QMap<QString, Samples> traceSamples;
+    QMap<QString, qint64> traceMarks;
+    QMap<QString, qint64> traceCounts;
+
+    // started once, reading it needs no lock
+    QElapsedTimer const &clock(){
+        static QElapsedTimer const timer = [](){
+            QElapsedTimer t;
+            t.start();
+            return t;
+        }();
+        return timer;
+    }
+
+    double percentile(QVector<qint64> const &sorted, double p){
+        if(sorted.isEmpty()){
+            return 0;
+        }
+        // nearest rank
+        int rank = qBound(1, (int)std::ceil(p * sorted.size()), sorted.size());
+        return sorted.at(rank - 1) / 1e6;
+    }
+}
+
+/**
+ * @brief DecodeTrace::now
+ * @return monotonic nanoseconds, only meaningful relative to each other
+ */
+qint64 DecodeTrace::now(){
+    return clock().nsecsElapsed();
+}
+
+void DecodeTrace::mark(QString const &key){
+    mark(key, now());
+}
+
+void DecodeTrace::mark(QString const &key, qint64 ns){
+    QMutexLocker lock(&traceLock);
+    traceMarks[key] = ns;
+}
+
+/**
+ * @brief DecodeTrace::since
+ * @param key
+ * @return nanoseconds since key was marked, -1 if it never was
+ */
+qint64 DecodeTrace::since(QString const &key){
+    qint64 t = now();
+
+    QMutexLocker lock(&traceLock);
+    if(!traceMarks.contains(key)){
+        return -1;
+    }
+    return t - traceMarks.value(key);
+}
+
+void DecodeTrace::record(QString const &stage, qint64 ns){
+    if(ns < 0){
+        return;
+    }
+
+    QMutexLocker lock(&traceLock);
+    auto &s = traceSamples[stage];
+    if(s.ns.size() < WINDOW){
+        s.ns.append(ns);
+    } else {
+        s.ns[s.next] = ns;
+    }
+    s.next = (s.next + 1) % WINDOW;
+    s.total++;
+}
+
+void DecodeTrace::recordSince(QString const &stage, QString const &key){
+    record(stage, since(key));
+}
+
+/**
+ * @brief DecodeTrace::stage
+ * @param name
+ * @param submode - JS8 submode
+ * @return the per submode stage name, i.e. "decode.A"
+ */
+QString DecodeTrace::stage(QString const &name, int submode){
+    static char const modes[] = "ABC~E~~~I";
+    char mode = (submode >= 0 && submode <= 8) ? modes[submode] : '~';
+    return QString("%1.%2").arg(name).arg(mode);
+}
+
+void DecodeTrace::count(QString const &counter, qint64 n){
+    QMutexLocker lock(&traceLock);
+    traceCounts[counter] += n;
+}
+
+/**
+ * @brief DecodeTrace::counts
+ * @return the counters' totals since the last reset
+ */
+QMap<QString, qint64> DecodeTrace::counts(){
+    QMutexLocker lock(&traceLock);
+    return traceCounts;
+}
+
+QMap<QString, DecodeTrace::Stats> DecodeTrace::stats(){
+    QMap<QString, Samples> samples;
+    {
+        QMutexLocker lock(&traceLock);
+        samples = traceSamples;
+    }
+
+    QMap<QString, Stats> stats;
+    foreach(auto stage, samples.keys()){
+        auto s = samples.value(stage);
+        auto sorted = s.ns;
+        std::sort(sorted.begin(), sorted.end());
+
+        Stats st;
+        st.count = sorted.size();
+        st.total = s.total;
+        st.p50 = percentile(sorted, 0.50);
+        st.p95 = percentile(sorted, 0.95);
+        st.p99 = percentile(sorted, 0.99);
+        st.max = sorted.isEmpty() ? 0 : sorted.last() / 1e6;
+        stats[stage] = st;
+    }
+    return stats;
+}
+
+/**
+ * @brief DecodeTrace::writeCsv
+ *        write the current per stage percentiles, in milliseconds
+ * @param path
+ * @return true if the file was written
+ */
+bool DecodeTrace::writeCsv(QString const &path){
+    QFile f(path);
+    if(!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)){
+        return false;
+    }
+
+    QTextStream out(&f);
+    out << "stage,count,total,p50_ms,p95_ms,p99_ms,max_ms\n";
+
+    auto all = stats();
+    foreach(auto stage, all.keys()){
+        auto st = all.value(stage);
+        out << stage << ","
+            << st.count << ","
+            << st.total << ","
+            << QString::number(st.p50, 'f', 3) << ","
+            << QString::number(st.p95, 'f', 3) << ","
+            << QString::number(st.p99, 'f', 3) << ","
+            << QString::number(st.max, 'f', 3) << "\n";
+    }
+
+    auto totals = counts();
+    if(!totals.isEmpty()){
+        out << "\ncounter,total\n";
+        foreach(auto counter, totals.keys()){
+            out << counter << "," << totals.value(counter) << "\n";
+        }
+    }
+
+    out.flush();
+    return f.error() == QFile::NoError;
+}
+
+void DecodeTrace::reset(){
+    QMutexLocker lock(&traceLock);
+    traceSamples.clear();
+    traceMarks.clear();
+    traceCounts.clear();
+}
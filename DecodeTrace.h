@@ -0,0 +1,64 @@
+#ifndef DECODETRACE_H
+#define DECODETRACE_H
+
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include <QMap>
+#include <QString>
+
+/**
+ * DecodeTrace keeps per stage latencies of the decode pipeline, from
+ * the audio frames leaving the detector to a decode being displayed.
+ *
+ * Timestamps come from a monotonic clock and each stage keeps a rolling
+ * window of its most recent samples so the percentiles follow current
+ * conditions. Counters keep running totals of things that happen along
+ * the way, like the decoder's long FFTs. Safe to use from any thread.
+ */
+namespace DecodeTrace
+{
+    struct Stats {
+        int count;      // samples in the window
+        qint64 total;   // samples since the last reset
+        double p50;     // milliseconds
+        double p95;
+        double p99;
+        double max;
+    };
+
+    qint64 now();
+
+    void mark(QString const &key);
+    void mark(QString const &key, qint64 ns);
+    qint64 since(QString const &key);
+
+    void record(QString const &stage, qint64 ns);
+    void recordSince(QString const &stage, QString const &key);
+
+    QString stage(QString const &name, int submode);
+
+    void count(QString const &counter, qint64 n);
+    QMap<QString, qint64> counts();
+
+    QMap<QString, Stats> stats();
+    bool writeCsv(QString const &path);
+    void reset();
+}
+
+#endif // DECODETRACE_H
@@ -22,12 +22,15 @@
 
 #include "commons.h"
 
+#include <cstring>
+
 #include <QTimer>
 
 
 Decoder::Decoder(QObject *parent):
     QObject(parent)
 {
+    qRegisterMetaType<QVector<decode_event>>("QVector<decode_event>");
 }
 
 Decoder::~Decoder(){
@@ -51,6 +54,7 @@ Worker* Decoder::createWorker(){
     connect(this, &Decoder::startWorker, worker, &Worker::start);
     connect(this, &Decoder::quitWorker, worker, &Worker::quit);
     connect(worker, &Worker::ready, this, &Decoder::processReady);
+    connect(worker, &Worker::events, this, &Decoder::processEvents);
     connect(worker, &Worker::error, this, &Decoder::processError);
     connect(worker, &Worker::finished, this, &Decoder::processFinished);
     return worker;
@@ -85,6 +89,11 @@ void Decoder::processReady(QByteArray t){
     emit ready(t);
 }
 
+//
+void Decoder::processEvents(QVector<decode_event> events){
+    emit this->events(events);
+}
+
 //
 void Decoder::processQuit(){
     emit quitWorker();
@@ -118,6 +127,9 @@ void Worker::setProcess(QProcess *proc, int msecs){
         m_proc.reset();
     }
 
+    // what is left of the last process' output is of no use to the next
+    m_output.clear();
+
     if(proc){
         m_proc.reset(proc);
     }
@@ -131,9 +143,7 @@ void Worker::start(QString path, QStringList args){
 
     connect(proc, &QProcess::readyReadStandardOutput,
             [this, proc](){
-                while(proc->canReadLine()){
-                    emit ready(proc->readLine());
-                }
+                readOutput(proc);
             });
 
     connect(proc, static_cast<void (QProcess::*) (QProcess::ProcessError)> (&QProcess::error),
@@ -154,6 +164,77 @@ void Worker::start(QString path, QStringList args){
     setProcess(proc);
 }
 
+/**
+ * @brief Worker::readOutput
+ *        split the decoder's output into its binary event frames, which
+ *        are handed on together as one batch per read, and the lines of
+ *        text a decoder started without --binary-events writes
+ * @param proc
+ */
+void Worker::readOutput(QProcess *proc){
+    m_output.append(proc->readAllStandardOutput());
+
+    int const header = DECODE_FRAME_MAGIC_SIZE + sizeof(int);
+    char const *data = m_output.constData();
+    int size = m_output.size();
+    int pos = 0;
+
+    QVector<decode_event> batch;
+    while(pos < size){
+        // frames start with a NUL, which never appears in the text
+        if(data[pos] == DECODE_FRAME_MAGIC[0]){
+            if(size - pos < header){
+                break;
+            }
+
+            int payload = 0;
+            memcpy(&payload, data + pos + DECODE_FRAME_MAGIC_SIZE, sizeof(payload));
+            if(memcmp(data + pos, DECODE_FRAME_MAGIC, DECODE_FRAME_MAGIC_SIZE) != 0 || payload != sizeof(decode_event)){
+                // not a frame we understand, skip ahead to resync
+                pos++;
+                continue;
+            }
+
+            if(size - pos < header + payload){
+                break;
+            }
+
+            decode_event event;
+            memcpy(&event, data + pos + header, sizeof(event));
+            batch.append(event);
+            pos += header + payload;
+            continue;
+        }
+
+        // text runs to the end of the line or the next frame
+        int end = pos;
+        while(end < size && data[end] != '\n' && data[end] != DECODE_FRAME_MAGIC[0]){
+            end++;
+        }
+        if(end == size){
+            break;
+        }
+        if(data[end] == '\n'){
+            end++;
+        }
+
+        // keep the order the decoder wrote things in
+        if(!batch.isEmpty()){
+            emit events(batch);
+            batch.clear();
+        }
+
+        emit ready(m_output.mid(pos, end - pos));
+        pos = end;
+    }
+
+    m_output.remove(0, pos);
+
+    if(!batch.isEmpty()){
+        emit events(batch);
+    }
+}
+
 //
 void Worker::quit(){
     setProcess(nullptr);
@@ -6,11 +6,13 @@
  **/
 
 #include "ProcessThread.h"
+#include "DecoderEngine.h"
 
 #include <QDebug>
 #include <QByteArray>
 #include <QPointer>
 #include <QProcess>
+#include <QVector>
 
 
 class Worker : public QObject{
@@ -24,14 +26,17 @@ public slots:
     QProcess* process() const { return m_proc.data(); }
 private:
     void setProcess(QProcess *proc, int msecs=1000);
+    void readOutput(QProcess *proc);
 
 signals:
     void ready(QByteArray t);
+    void events(QVector<decode_event> events);
     void error(int errorCode, QString errorString);
     void finished(int exitCode, int statusCode, QString errorString);
 
 private:
     QScopedPointer<QProcess> m_proc;
+    QByteArray m_output;
 };
 
 
@@ -69,6 +74,7 @@ public slots:
 
     void processStart(QString path, QStringList args);
     void processReady(QByteArray t);
+    void processEvents(QVector<decode_event> events);
     void processQuit();
 
     void processError(int errorCode, QString errorString);
@@ -79,6 +85,7 @@ signals:
     void quitWorker();
 
     void ready(QByteArray t);
+    void events(QVector<decode_event> events);
     void error(int errorCode, QString errorString);
     void finished(int exitCode, int statusCode, QString errorString);
 
@@ -0,0 +1,241 @@
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "DecoderEngine.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+
+extern "C" {
+  // lib/decoder_engine.f90
+  void c_init_decoder(void *context, void (*callback)(void *, decode_event const *), int patience);
+  void c_plan_decoder(char const *wisfile);
+  void c_decode_cycle(float const *ss, short int const *id2, void const *params, int ndecoders);
+}
+
+DecoderEngine::DecoderEngine(QObject *parent):
+    QThread(parent),
+    m_data(nullptr),
+    m_params(),
+    m_threads(0),
+    m_patience(1),
+    m_pending(false),
+    m_busy(false),
+    m_finished(false),
+    m_quit(false)
+{
+    qRegisterMetaType<decode_event>("decode_event");
+    qRegisterMetaType<QVector<decode_event>>("QVector<decode_event>");
+
+    // match the js8 subprocess main thread. The OpenMP workers the
+    // decoder starts get the runtime's default stack, OMP_STACKSIZE is
+    // read when the runtime loads, before we could set it, so the
+    // decoder keeps its large arrays (syncjs8's sync2d) off the stack
+    setStackSize(16 * 1024 * 1024);
+}
+
+DecoderEngine::~DecoderEngine(){
+    stop();
+}
+
+//
+void DecoderEngine::setCallback(Callback callback){
+    QMutexLocker lock(&m_lock);
+    m_callback = callback;
+}
+
+//
+void DecoderEngine::setThreads(int threads){
+    QMutexLocker lock(&m_lock);
+    m_threads = qMax(threads, 0);
+}
+
+//
+void DecoderEngine::setPatience(int patience){
+    QMutexLocker lock(&m_lock);
+    m_patience = patience;
+}
+
+/**
+ * @brief DecoderEngine::setWisdomFile
+ *        where to save the FFTW wisdom once the decoder's FFTs are planned
+ * @param path - empty to not save it
+ */
+void DecoderEngine::setWisdomFile(QString const &path){
+    QMutexLocker lock(&m_lock);
+    m_wisdomFile = path.toLocal8Bit();
+}
+
+/**
+ * @brief DecoderEngine::isBusy
+ * @return true from submit until the cycle's DECODE_FINISHED event
+ */
+bool DecoderEngine::isBusy() const {
+    QMutexLocker lock(&m_lock);
+    return m_busy;
+}
+
+/**
+ * @brief DecoderEngine::submit
+ *        queue a decode cycle and wake the decoder thread
+ * @param data - the params are copied, the audio is referenced
+ * @return true if the cycle was queued, false if the engine is busy
+ */
+bool DecoderEngine::submit(struct dec_data const *data){
+    QMutexLocker lock(&m_lock);
+    if(m_busy || m_quit){
+        return false;
+    }
+
+    m_data = data;
+    m_params = data->params;
+    m_pending = true;
+    m_busy = true;
+    m_wake.wakeOne();
+    return true;
+}
+
+//
+void DecoderEngine::stop(){
+    {
+        QMutexLocker lock(&m_lock);
+        m_quit = true;
+        m_wake.wakeOne();
+    }
+    wait();
+}
+
+//
+void DecoderEngine::run(){
+    if(JS8_DEBUG_DECODE) qDebug() << "decoder engine starting...";
+
+    QByteArray wisdomFile;
+    {
+        QMutexLocker lock(&m_lock);
+        c_init_decoder(this, &DecoderEngine::deliver, m_patience);
+        wisdomFile = m_wisdomFile;
+    }
+
+    // plan ahead so the first cycle is not held up by the FFTW planner
+    c_plan_decoder(wisdomFile.constData());
+
+    forever {
+        struct dec_data const *data;
+        decltype(dec_data::params) params;
+        int threads;
+
+        {
+            QMutexLocker lock(&m_lock);
+            while(!m_pending && !m_quit){
+                m_wake.wait(&m_lock);
+            }
+            if(m_quit){
+                break;
+            }
+            data = m_data;
+            params = m_params;
+            threads = m_threads;
+            m_pending = false;
+            m_finished = false;
+        }
+
+        c_decode_cycle(data->ss, data->d2, &params, threads);
+
+        // a cycle that returned without its finished event still ends, so
+        // neither the engine nor whoever is waiting on it is left busy
+        bool finished;
+        {
+            QMutexLocker lock(&m_lock);
+            finished = m_finished;
+        }
+        if(!finished){
+            decode_event event = {};
+            event.kind = DECODE_FINISHED;
+            event.submode = params.nsubmode;
+            deliver(this, &event);
+        }
+    }
+
+    c_init_decoder(nullptr, nullptr, m_patience);
+
+    if(JS8_DEBUG_DECODE) qDebug() << "decoder engine stopped";
+}
+
+//
+void DecoderEngine::deliver(void *context, decode_event const *event){
+    auto engine = static_cast<DecoderEngine *>(context);
+
+    Callback callback;
+    {
+        QMutexLocker lock(&engine->m_lock);
+        if(event->kind == DECODE_FINISHED){
+            engine->m_busy = false;
+            engine->m_finished = true;
+        }
+        callback = engine->m_callback;
+    }
+
+    if(callback){
+        callback(*event);
+    }
+
+    // everything between a cycle's started and finished events is
+    // delivered in one go at the end of the cycle anyway
+    engine->m_events.append(*event);
+    switch(event->kind){
+        case DECODE_STARTED:
+        case DECODE_FINISHED:
+        case DECODE_PLANNED:
+            emit engine->decodeEvents(engine->m_events);
+            engine->m_events.clear();
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief DecoderEngine::decodedLine
+ *        format a DECODE_DECODED event the way the js8 subprocess
+ *        writes it, the format ALL.txt keeps its decodes in
+ * @param event
+ * @return the decode line
+ */
+QString DecoderEngine::decodedLine(decode_event const &event){
+    static char const modes[] = "ABC~E~~~I";
+    char mode = (event.submode >= 0 && event.submode <= 8) ? modes[event.submode] : '~';
+    QString text = QString::fromLatin1(event.text);
+
+    QString line;
+    if(text.contains(';')){
+        line = QString::asprintf("%06d%4d%5.1f%5d %c  %-37s",
+                                 event.utc, event.snr, event.dt, qRound(event.freq), mode,
+                                 text.toLatin1().constData());
+    } else {
+        QString annot = event.nap ? QString("a%1").arg(event.nap) : QString("  ");
+        line = QString::asprintf("%06d%4d%5.1f%5d %c  %-22s %s",
+                                 event.utc, event.snr, event.dt, qRound(event.freq), mode,
+                                 text.toLatin1().constData(), annot.toLatin1().constData());
+    }
+
+    while(line.endsWith(' ')){
+        line.chop(1);
+    }
+
+    return line;
+}
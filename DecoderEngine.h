@@ -0,0 +1,104 @@
+#ifndef DECODERENGINE_H
+#define DECODERENGINE_H
+
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "commons.h"
+
+#include <functional>
+
+#include <QByteArray>
+#include <QMetaType>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+Q_DECLARE_METATYPE(decode_event)
+
+/**
+ * DecoderEngine runs the JS8 decoder in process on a dedicated thread
+ * as an alternative to the js8 subprocess. A decode cycle is handed
+ * over with submit() and the thread is woken by a wait condition, the
+ * results come back as typed decode_event records.
+ *
+ * Only the decode parameters are copied per cycle, the audio is read in
+ * place from the caller's dec_data. The decoder reads each submode's
+ * window from the ring buffer as it starts, and those windows are
+ * complete periods the detector is no longer writing to.
+ *
+ * The callback sees each event as it is delivered, the decodeEvents
+ * signal hands them to other threads a batch at a time.
+ *
+ * When the thread starts it plans all of the decoder's FFTs before
+ * taking the first cycle and saves the FFTW wisdom to the wisdom file,
+ * reporting the time taken as a DECODE_PLANNED event.
+ *
+ * The Fortran decoder keeps global state so there can only be one
+ * engine running in a process.
+ */
+class DecoderEngine : public QThread
+{
+    Q_OBJECT
+public:
+    // called on a decoder thread, never concurrently
+    using Callback = std::function<void (decode_event const &)>;
+
+    DecoderEngine(QObject *parent=nullptr);
+    ~DecoderEngine();
+
+    void setCallback(Callback callback);
+    void setThreads(int threads);
+    void setPatience(int patience);
+    void setWisdomFile(QString const &path);
+
+    bool isBusy() const;
+    bool submit(struct dec_data const *data);
+    void stop();
+
+    static QString decodedLine(decode_event const &event);
+
+signals:
+    // the events of a cycle, batched up between its started and
+    // finished events
+    void decodeEvents(QVector<decode_event> events);
+
+protected:
+    void run() override;
+
+private:
+    static void deliver(void *context, decode_event const *event);
+
+    mutable QMutex m_lock;
+    QWaitCondition m_wake;
+    Callback m_callback;
+    QVector<decode_event> m_events;
+    struct dec_data const *m_data;
+    decltype(dec_data::params) m_params;
+    int m_threads;
+    int m_patience;
+    QByteArray m_wisdomFile;
+    bool m_pending;
+    bool m_busy;
+    bool m_finished;    // the running cycle delivered its finished event
+    bool m_quit;
+};
+
+#endif // DECODERENGINE_H
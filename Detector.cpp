@@ -5,11 +5,22 @@
 #include "commons.h"
 
 #include "DriftingDateTime.h"
+#include "DecodeTrace.h"
 
 #include "moc_Detector.cpp"
 
-extern "C" {
-  void   fil4_(qint16*, qint32*, qint16*, qint32*);
+static_assert (Detector::ring_size == sizeof (dec_data.d2) / sizeof (dec_data.d2[0]),
+               "the ring is dec_data.d2");
+static_assert (Detector::ring_size < (1 << 20), "the origin must fit in the head");
+#if ATOMIC_LLONG_LOCK_FREE != 2
+static_assert (Detector::ring_size < 0x7fffffff / 2048, "the sequence must fit in a QAtomicInt");
+#endif
+
+namespace
+{
+  // samples ahead of the head left alone by clearContent, the writer may
+  // be writing there meanwhile and they are the oldest in the ring
+  qint32 const clear_margin {RX_SAMPLE_RATE};
 }
 
 Detector::Detector (unsigned frameRate, unsigned periodLengthInSeconds,
@@ -22,9 +33,20 @@ Detector::Detector (unsigned frameRate, unsigned periodLengthInSeconds,
   , m_ns (999)
   , m_buffer ((downSampleFactor > 1) ?
               new short [max_buffer_size * downSampleFactor] : nullptr)
+  , m_output (new short [max_buffer_size])
   , m_bufferPos (0)
+#if ATOMIC_LLONG_LOCK_FREE == 2
+  , m_head (0)
+#else
+  , m_version (0)
+  , m_sequence (0)
+  , m_origin (0)
+#endif
+  , m_resync (-1)
+  , m_framesWrittenAt (-1)
 {
   (void)m_frameRate;            // quell compiler warning
+  Q_ASSERT (downSampleFactor == 1 || downSampleFactor == Decimator::factor);
   clear ();
 }
 
@@ -47,138 +69,146 @@ void Detector::clear ()
   resetBufferPosition();
   resetBufferContent();
 #else
-  dec_data.params.kin = 0;
-  m_bufferPos = 0;
+  m_resync.storeRelease (0);
 #endif
 
   // fill buffer with zeros (G4WJS commented out because it might cause decoder hangs)
   // qFill (dec_data.d2, dec_data.d2 + sizeof (dec_data.d2) / sizeof (dec_data.d2[0]), 0);
 }
 
-/**
- * shift the elements of an array left by n items using a temporary array for efficient moving
- *
- * this function moves the leading n elements to the end of the array
- *
- * the temporary array needs to be allocated to accept at least n items
- */
-template<typename T> void rotate_array_left(T array[], qint64 size, T temp[], qint64 n) {
-    memcpy(temp, array, n * sizeof(T));                  // temporarily save leading n elements
-    memmove(array, array + n, (size - n) * sizeof(T));   // shift array to the left
-    memmove(array + size - n, temp, n * sizeof(T));      // append saved
+//
+// move the head to roughly where we are in time (1ms resolution)
+//
+// this only asks for it, the writer moves the origin of the period the
+// next time it writes, so the samples already in the ring line up with
+// the clock again without being moved
+//
+void Detector::resetBufferPosition(){
+    qint64 now (DriftingDateTime::currentMSecsSinceEpoch ());
+    unsigned msInPeriod ((now % 86400000LL) % (m_period * 1000));
+    m_resync.storeRelease (qMin ((msInPeriod * m_frameRate) / 1000, static_cast<unsigned> (ring_size - 1)));
 }
 
-/**
- * shift the elements of an array right by n items using a temporary array for efficient moving
- *
- * this function moves the trailing n elements to the start of the array
- *
- * the temporary array needs to be allocated to accept at least n items
- */
-template<typename T> void rotate_array_right(T array[], qint64 size, T temp[], qint64 n) {
-    memcpy(temp, array + size - n, n * sizeof(T));      // temporarily save trailing n elements
-    memmove(array + n, array, (size - n) * sizeof(T));  // shift array to the right
-    memcpy(array, temp, n * sizeof(T));                 // prepend saved
+void Detector::resetBufferContent(){
+    Q_EMIT clearRequested (position ().sequence);
 }
 
-void Detector::resetBufferPosition(){
-    // temporary buffer for efficient copies
-    static short int d0[NTMAX*RX_SAMPLE_RATE];
-
-    QMutexLocker mutex(&m_lock);
+void Detector::clearContent (qint64 sequence)
+{
+  Position p (position ());
+  qint64 written (p.sequence - sequence);
+#if ATOMIC_LLONG_LOCK_FREE != 2
+  if (written < 0) written += sequence_wrap;
+#endif
+  qint64 keep (qMin<qint64> (written, ring_size) + clear_margin);
+  if (keep >= ring_size) {
+    return;                     // nothing is left from before the request
+  }
 
-    // set index to roughly where we are in time (1ms resolution)
-    qint64 now (DriftingDateTime::currentMSecsSinceEpoch ());
-    unsigned msInPeriod ((now % 86400000LL) % (m_period * 1000));
-    int prevKin = dec_data.params.kin;
-    dec_data.params.kin = qMin ((msInPeriod * m_frameRate) / 1000, static_cast<unsigned> (sizeof (dec_data.d2) / sizeof (dec_data.d2[0])));
-    m_bufferPos = 0;
-    m_ns=secondInPeriod();
-    int delta = dec_data.params.kin - prevKin;
-    qDebug() << "advancing detector buffer from" << prevKin << "to" << dec_data.params.kin << "delta" << delta;
+  // from past the margin ahead of the head round to the oldest sample
+  // written since the request
+  qint32 from ((p.head () + clear_margin) % ring_size);
+  qint32 n (ring_size - keep);
+  qint32 first (qMin (n, ring_size - from));
+  memset (&dec_data.d2[from], 0, first * sizeof (dec_data.d2[0]));
+  memset (&dec_data.d2[0], 0, (n - first) * sizeof (dec_data.d2[0]));
+  if (JS8_DEBUG_DECODE) qDebug () << "cleared detector buffer content, kept" << keep << "samples";
+}
 
-    // rotate buffer moving the contents that were at prevKin to the new kin position
-    if(delta < 0){
-        rotate_array_left<short int>(dec_data.d2, NTMAX*RX_SAMPLE_RATE, d0, -delta);
-    } else {
-        rotate_array_right<short int>(dec_data.d2, NTMAX*RX_SAMPLE_RATE, d0, delta);
-    }
+#if ATOMIC_LLONG_LOCK_FREE == 2
+Detector::Position Detector::position () const
+{
+  quint64 head (m_head.load (std::memory_order_acquire));
+  return {static_cast<qint64> (head >> origin_bits),
+          static_cast<qint32> (head & ((1u << origin_bits) - 1))};
 }
 
-void Detector::resetBufferContent(){
-    QMutexLocker mutex(&m_lock);
+void Detector::setPosition (Position const& p)
+{
+  m_head.store ((static_cast<quint64> (p.sequence) << origin_bits) | p.origin, std::memory_order_release);
+}
+#else
+Detector::Position Detector::position () const
+{
+  Position p;
+  int version;
+  do {
+    while ((version = m_version.loadAcquire ()) & 1) {}
+    p.sequence = m_sequence.loadAcquire ();
+    p.origin = m_origin.loadAcquire ();
+  } while (m_version.loadAcquire () != version);
+  return p;
+}
 
-    memset(dec_data.d2, 0, sizeof(dec_data.d2));
-    qDebug() << "clearing detector buffer content";
+void Detector::setPosition (Position const& p)
+{
+  int version (m_version.load ()); // only the writer stores it
+  m_version.storeRelease (version + 1);
+  m_sequence.storeRelease (static_cast<qint32> (p.sequence % sequence_wrap));
+  m_origin.storeRelease (p.origin);
+  m_version.storeRelease (version + 2);
 }
+#endif
 
 qint64 Detector::writeData (char const * data, qint64 maxSize)
 {
-  QMutexLocker mutex(&m_lock);
+  // no torn frames
+  Q_ASSERT (!(maxSize % static_cast<qint64> (bytesPerFrame ())));
+
+  // the audio is de-interleaved, down sampled and published as it
+  // arrives, in whatever size blocks the device delivers, without
+  // taking any lock
+  size_t frames (maxSize / bytesPerFrame ());
+  size_t const framesPerBlock (max_buffer_size * m_downSampleFactor);
+  for (size_t done = 0; done < frames; ) {
+    size_t numFrames (qMin (framesPerBlock, frames - done));
+    if (m_downSampleFactor > 1) {
+      store (&data[done * bytesPerFrame ()], numFrames, m_buffer.data ());
+      publish (m_output.data (), m_decimator.process (m_buffer.data (), numFrames, m_output.data ()));
+    } else {
+      store (&data[done * bytesPerFrame ()], numFrames, m_output.data ());
+      publish (m_output.data (), numFrames);
+    }
+    done += numFrames;
+  }
+
+  return maxSize;
+}
+
+//
+// copy down sampled samples into the ring at the head, publish the new
+// head and signal every m_samplesPerFFT samples
+//
+void Detector::publish (short const * samples, size_t numSamples)
+{
+  Position p (position ());
 
   int ns=secondInPeriod();
-  if(ns < m_ns) {                      // When ns has wrapped around to zero, restart the buffers
-    dec_data.params.kin = 0;
+  int resync (m_resync.fetchAndStoreAcquire (-1));
+  if (resync >= 0) {
+    if (JS8_DEBUG_DECODE) qDebug() << "advancing detector buffer from" << p.kin () << "to" << resync << "delta" << resync - p.kin ();
+    p.origin = (p.head () - resync + ring_size) % ring_size;
+    m_bufferPos = 0;
+  } else if(ns < m_ns) {               // When ns has wrapped around to zero, restart the period
+    p.origin = p.head ();
     m_bufferPos = 0;
   }
   m_ns=ns;
 
-  // no torn frames
-  Q_ASSERT (!(maxSize % static_cast<qint64> (bytesPerFrame ())));
-  // these are in terms of input frames (not down sampled)
-  size_t framesAcceptable ((sizeof (dec_data.d2) /
-                            sizeof (dec_data.d2[0]) - dec_data.params.kin) * m_downSampleFactor);
-  size_t framesAccepted (qMin (static_cast<size_t> (maxSize /
-                                                    bytesPerFrame ()), framesAcceptable));
-
-  if (framesAccepted < static_cast<size_t> (maxSize / bytesPerFrame ())) {
-    qDebug () << "dropped " << maxSize / bytesPerFrame () - framesAccepted
-                << " frames of data on the floor!"
-                << dec_data.params.kin << ns;
-    }
-
-    for (unsigned remaining = framesAccepted; remaining; ) {
-      size_t numFramesProcessed (qMin (m_samplesPerFFT *
-                                       m_downSampleFactor - m_bufferPos, remaining));
-
-      if(m_downSampleFactor > 1) {
-        store (&data[(framesAccepted - remaining) * bytesPerFrame ()],
-               numFramesProcessed, &m_buffer[m_bufferPos]);
-        m_bufferPos += numFramesProcessed;
-
-        if(m_bufferPos==m_samplesPerFFT*m_downSampleFactor) {
-          qint32 framesToProcess (m_samplesPerFFT * m_downSampleFactor);
-          qint32 framesAfterDownSample (m_samplesPerFFT);
-          if(m_downSampleFactor > 1 && dec_data.params.kin>=0 &&
-             dec_data.params.kin < (NTMAX*12000 - framesAfterDownSample)) {
-            fil4_(&m_buffer[0], &framesToProcess, &dec_data.d2[dec_data.params.kin],
-                  &framesAfterDownSample);
-            dec_data.params.kin += framesAfterDownSample;
-          } else {
-            // qDebug() << "framesToProcess     = " << framesToProcess;
-            // qDebug() << "dec_data.params.kin = " << dec_data.params.kin;
-            // qDebug() << "secondInPeriod      = " << secondInPeriod();
-            // qDebug() << "framesAfterDownSample" << framesAfterDownSample;
-          }
-          Q_EMIT framesWritten (dec_data.params.kin);
-          m_bufferPos = 0;
-        }
-
-      } else {
-        store (&data[(framesAccepted - remaining) * bytesPerFrame ()],
-               numFramesProcessed, &dec_data.d2[dec_data.params.kin]);
-        m_bufferPos += numFramesProcessed;
-        dec_data.params.kin += numFramesProcessed;
-        if (m_bufferPos == static_cast<unsigned> (m_samplesPerFFT)) {
-          Q_EMIT framesWritten (dec_data.params.kin);
-          m_bufferPos = 0;
-        }
-      }
-      remaining -= numFramesProcessed;
-    }
-
-  return maxSize;    // we drop any data past the end of the buffer on
-  // the floor until the next period starts
+  // at most a block is published at a time, far less than the ring
+  size_t head (p.head ());
+  size_t first (qMin (numSamples, static_cast<size_t> (ring_size) - head));
+  memcpy (&dec_data.d2[head], samples, first * sizeof (samples[0]));
+  memcpy (&dec_data.d2[0], samples + first, (numSamples - first) * sizeof (samples[0]));
+  p.sequence += numSamples;
+  setPosition (p);
+
+  m_bufferPos += numSamples;
+  if (m_samplesPerFFT > 0 && m_bufferPos >= static_cast<unsigned> (m_samplesPerFFT)) {
+    m_bufferPos %= m_samplesPerFFT;
+    m_framesWrittenAt.store (DecodeTrace::now (), std::memory_order_relaxed);
+    Q_EMIT framesWritten (p.kin ());
+  }
 }
 
 unsigned Detector::secondInPeriod () const
@@ -1,6 +1,9 @@
 #ifndef DETECTOR_HPP__
 #define DETECTOR_HPP__
 #include "AudioDevice.hpp"
+#include "Decimator.hpp"
+#include "commons.h"
+#include <atomic>
 #include <QScopedArrayPointer>
 #include <QMutex>
 #include <QMutexLocker>
@@ -11,11 +14,44 @@
 // the underlying device for this abstraction is just the buffer that
 // stores samples throughout a receiving period
 //
+// dec_data.d2 is a ring with a single writer, writeData on the audio
+// thread, that never blocks: samples are copied in at the head and then
+// the head is published with one atomic store, readers take a Position
+// with one atomic load and may read anything behind the head without a
+// lock
+//
+// sample k of the period (the decoder's k, which follows the clock) is
+// at index (origin + k) % size of the ring, re-synchronising to the
+// clock moves the origin rather than the samples
+//
+// clearing the ring is too much work for the audio thread, it is asked
+// for with clearRequested and done by whoever owns the detector
+//
 class Detector : public AudioDevice
 {
   Q_OBJECT;
 
 public:
+  static qint32 const ring_size {NTMAX * RX_SAMPLE_RATE};
+
+  //
+  // a consistent view of the ring at one moment
+  //
+  struct Position
+  {
+    qint64 sequence;		// samples written since the detector started
+    qint32 origin;		// index of the first sample of the period
+
+    // index the next sample will be written to
+    qint32 head () const {return sequence % ring_size;}
+
+    // samples written in the period so far, the decoder's k
+    qint32 kin () const {return (head () - origin + ring_size) % ring_size;}
+
+    // index of sample k of the period
+    qint32 index (qint32 k) const {return (origin + k % ring_size + ring_size) % ring_size;}
+  };
+
   //
   // if the data buffer were not global storage and fixed size then we
   // might want maximum size passed as constructor arguments
@@ -26,18 +62,30 @@ public:
   //
   Detector (unsigned frameRate, unsigned periodLengthInSeconds, unsigned downSampleFactor = 4u, QObject * parent = 0);
 
+  // not taken by the detector, serializes the other users of dec_data
   QMutex * getMutex(){ return &m_lock; }
   unsigned period() const {return m_period;}
   void setTRPeriod(unsigned p) {m_period=p;}
   bool reset () override;
 
   Q_SIGNAL void framesWritten (qint64) const;
+  // the ring should be cleared, keeping what was written after sequence
+  Q_SIGNAL void clearRequested (qint64 sequence) const;
   Q_SLOT void setBlockSize (unsigned);
 
   void clear ();		// discard buffer contents
   void resetBufferPosition();
   void resetBufferContent();
 
+  Position position () const;
+
+  // zero the ring apart from what was written after sequence, never
+  // from the audio thread, with the mutex held against other readers
+  void clearContent (qint64 sequence);
+
+  // when framesWritten was last emitted on the DecodeTrace clock, -1 if never
+  qint64 framesWrittenAt () const {return m_framesWrittenAt.load (std::memory_order_relaxed);}
+
   unsigned secondInPeriod () const;
 
 protected:
@@ -49,6 +97,9 @@ protected:
   qint64 writeData (char const * data, qint64 maxSize) override;
 
 private:
+  void publish (short const * samples, size_t numSamples);
+  void setPosition (Position const&);
+
   unsigned m_frameRate;
   unsigned m_period;
   unsigned m_downSampleFactor;
@@ -60,7 +111,30 @@ private:
   // samples for one increment of
   // data (a signals worth) at
   // the input sample rate
-  unsigned m_bufferPos;
+  QScopedArrayPointer<short> m_output; // samples after down sampling
+  Decimator m_decimator;	// only touched by writeData, needs no lock
+  unsigned m_bufferPos;		// samples published since the last signal
+
+#if ATOMIC_LLONG_LOCK_FREE == 2
+  // sequence << 20 | origin, so a Position is one atomic value
+  static int const origin_bits {20};
+  std::atomic<quint64> m_head;
+#else
+  // without lock free 64 bit atomics the sequence wraps at a multiple of
+  // the ring, and the writer bumps m_version to odd and back around
+  // updating the pair, readers retry if it changed under them
+  static qint32 const sequence_wrap {ring_size * 2048};
+  QAtomicInt m_version;
+  QAtomicInt m_sequence;
+  QAtomicInt m_origin;
+#endif
+
+  // asked for by other threads, carried out by the writer
+  QAtomicInt m_resync;		// the k to move the head to, or -1
+
+  // stamped by writeData, the audio thread must not lock for the trace
+  std::atomic<qint64> m_framesWrittenAt;
+
   QMutex m_lock;
 };
 
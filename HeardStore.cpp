@@ -0,0 +1,484 @@
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "HeardStore.h"
+#include "commons.h"
+
+#include <QDebug>
+
+
+namespace {
+    // rows are bucketed by the hour they were heard in
+    const qint64 BUCKET_SECS = 3600;
+
+    const char* SCHEMA = "PRAGMA journal_mode = WAL;"
+                         "PRAGMA synchronous = NORMAL;"
+                         "CREATE TABLE IF NOT EXISTS heard_calls_v1 ("
+                         "  id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                         "  bucket INTEGER, "
+                         "  utc INTEGER, "
+                         "  band TEXT, "
+                         "  call TEXT, "
+                         "  grid TEXT, "
+                         "  dial INTEGER, "
+                         "  offset INTEGER, "
+                         "  snr INTEGER, "
+                         "  submode INTEGER, "
+                         "  tdrift REAL"
+                         ");"
+                         "CREATE INDEX IF NOT EXISTS idx_heard_calls_v1__call ON"
+                         "  heard_calls_v1(call, utc);"
+                         "CREATE INDEX IF NOT EXISTS idx_heard_calls_v1__band ON"
+                         "  heard_calls_v1(band, utc);"
+                         "CREATE INDEX IF NOT EXISTS idx_heard_calls_v1__bucket ON"
+                         "  heard_calls_v1(bucket);"
+                         "CREATE TABLE IF NOT EXISTS heard_graph_v1 ("
+                         "  id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                         "  bucket INTEGER, "
+                         "  utc INTEGER, "
+                         "  band TEXT, "
+                         "  from_call TEXT, "
+                         "  to_call TEXT"
+                         ");"
+                         "CREATE INDEX IF NOT EXISTS idx_heard_graph_v1__from ON"
+                         "  heard_graph_v1(from_call, utc);"
+                         "CREATE INDEX IF NOT EXISTS idx_heard_graph_v1__to ON"
+                         "  heard_graph_v1(to_call, utc);"
+                         "CREATE INDEX IF NOT EXISTS idx_heard_graph_v1__band ON"
+                         "  heard_graph_v1(band, utc);"
+                         "CREATE INDEX IF NOT EXISTS idx_heard_graph_v1__bucket ON"
+                         "  heard_graph_v1(bucket)";
+
+    const char* CALL_COLUMNS = "call, band, grid, dial, offset, snr, submode, tdrift";
+
+    qint64 secs(QDateTime const &timestamp){
+        return timestamp.isValid() ? timestamp.toMSecsSinceEpoch() / 1000 : 0;
+    }
+
+    void bindText(sqlite3_stmt *stmt, int i, QString const &value){
+        auto v8 = value.toUtf8();
+        sqlite3_bind_text(stmt, i, v8.constData(), v8.size(), SQLITE_TRANSIENT);
+    }
+
+    QString columnText(sqlite3_stmt *stmt, int i){
+        return QString::fromUtf8((const char*)sqlite3_column_text(stmt, i), sqlite3_column_bytes(stmt, i));
+    }
+}
+
+HeardStore::HeardStore(QString path, int retentionDays) :
+    path_{ path },
+    retentionDays_{ retentionDays },
+    prunedBucket_{ -1 },
+    db_{ nullptr },
+    appendCall_{ nullptr },
+    appendHeard_{ nullptr }
+{
+}
+
+HeardStore::~HeardStore(){
+    flush();
+    close();
+}
+
+
+/**
+ * Low-Level Interface
+ **/
+
+bool HeardStore::isOpen(){
+    return db_ != nullptr;
+}
+
+bool HeardStore::open(){
+    openError_.clear();
+
+    int rc = sqlite3_open(path_.toLocal8Bit().data(), &db_);
+    if(rc != SQLITE_OK){
+        return failOpen();
+    }
+
+    rc = sqlite3_exec(db_, SCHEMA, nullptr, nullptr, nullptr);
+    if(rc != SQLITE_OK){
+        return failOpen();
+    }
+
+    // flushes happen all session long, so the append statements are prepared once
+    auto appendCallSql = QString("INSERT INTO heard_calls_v1 (bucket, utc, %1) "
+                                 "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);").arg(CALL_COLUMNS).toLatin1();
+    rc = sqlite3_prepare_v2(db_, appendCallSql.constData(), -1, &appendCall_, nullptr);
+    if(rc != SQLITE_OK){
+        return failOpen();
+    }
+
+    const char* appendHeardSql = "INSERT INTO heard_graph_v1 (bucket, utc, band, from_call, to_call) "
+                                 "VALUES (?, ?, ?, ?, ?);";
+    rc = sqlite3_prepare_v2(db_, appendHeardSql, -1, &appendHeard_, nullptr);
+    if(rc != SQLITE_OK){
+        return failOpen();
+    }
+
+    return true;
+}
+
+// close on any failure to open, keeping sqlite's reason for error()
+bool HeardStore::failOpen(){
+    openError_ = error();
+    close();
+    return false;
+}
+
+void HeardStore::close(){
+    if(appendCall_){
+        sqlite3_finalize(appendCall_);
+        appendCall_ = nullptr;
+    }
+    if(appendHeard_){
+        sqlite3_finalize(appendHeard_);
+        appendHeard_ = nullptr;
+    }
+    if(db_){
+        sqlite3_close(db_);
+        db_ = nullptr;
+    }
+}
+
+QString HeardStore::error(){
+    if(db_){
+        return QString::fromLocal8Bit(sqlite3_errmsg(db_));
+    }
+    return openError_;
+}
+
+bool HeardStore::appendCall(Call const &value){
+    if(!isOpen()){
+        return false;
+    }
+
+    pendingCalls_.append(value);
+    return true;
+}
+
+bool HeardStore::appendHeard(QString band, QString from, QString to, QDateTime utcTimestamp){
+    if(!isOpen()){
+        return false;
+    }
+
+    pendingHeard_.append({ band, from, to, utcTimestamp });
+    return true;
+}
+
+/**
+ * @brief HeardStore::flush
+ *        write the queued appends in one transaction and drop expired hours
+ * @return true if every queued row was written
+ */
+bool HeardStore::flush(){
+    if(pendingCalls_.isEmpty() && pendingHeard_.isEmpty()){
+        return true;
+    }
+
+    if(!isOpen()){
+        pendingCalls_.clear();
+        pendingHeard_.clear();
+        return false;
+    }
+
+    qint64 bucket = -1;
+    bool ok = sqlite3_exec(db_, "BEGIN;", nullptr, nullptr, nullptr) == SQLITE_OK;
+
+    foreach(auto const &c, pendingCalls_){
+        ok = ok && writeCall(c);
+        bucket = qMax(bucket, secs(c.utcTimestamp) / BUCKET_SECS);
+    }
+    foreach(auto const &h, pendingHeard_){
+        ok = ok && writeHeard(h);
+        bucket = qMax(bucket, secs(h.utcTimestamp) / BUCKET_SECS);
+    }
+
+    if(ok){
+        ok = sqlite3_exec(db_, "COMMIT;", nullptr, nullptr, nullptr) == SQLITE_OK;
+    }
+    if(!ok){
+        if(JS8_DEBUG_DECODE) qDebug() << "heard store flush failed:" << error();
+        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+    }
+
+    pendingCalls_.clear();
+    pendingHeard_.clear();
+
+    pruneExpired(bucket);
+
+    return ok;
+}
+
+bool HeardStore::writeCall(Call const &value){
+    qint64 utc = secs(value.utcTimestamp);
+
+    sqlite3_bind_int64(appendCall_, 1, utc / BUCKET_SECS);
+    sqlite3_bind_int64(appendCall_, 2, utc);
+    bindText(appendCall_, 3, value.call);
+    bindText(appendCall_, 4, value.band);
+    bindText(appendCall_, 5, value.grid);
+    sqlite3_bind_int(appendCall_, 6, value.dial);
+    sqlite3_bind_int(appendCall_, 7, value.offset);
+    sqlite3_bind_int(appendCall_, 8, value.snr);
+    sqlite3_bind_int(appendCall_, 9, value.submode);
+    sqlite3_bind_double(appendCall_, 10, value.tdrift);
+
+    int rc = sqlite3_step(appendCall_);
+    sqlite3_reset(appendCall_);
+
+    return rc == SQLITE_DONE;
+}
+
+bool HeardStore::writeHeard(Heard const &value){
+    qint64 utc = secs(value.utcTimestamp);
+
+    sqlite3_bind_int64(appendHeard_, 1, utc / BUCKET_SECS);
+    sqlite3_bind_int64(appendHeard_, 2, utc);
+    bindText(appendHeard_, 3, value.band);
+    bindText(appendHeard_, 4, value.from);
+    bindText(appendHeard_, 5, value.to);
+
+    int rc = sqlite3_step(appendHeard_);
+    sqlite3_reset(appendHeard_);
+
+    return rc == SQLITE_DONE;
+}
+
+/**
+ * @brief HeardStore::prune
+ *        drop the hours that end before a time
+ * @param before
+ * @return the number of rows dropped, -1 on error
+ */
+int HeardStore::prune(QDateTime before){
+    if(!isOpen()){
+        return -1;
+    }
+
+    const char* sql = "DELETE FROM heard_calls_v1 WHERE bucket < ?1;"
+                      "DELETE FROM heard_graph_v1 WHERE bucket < ?1;";
+
+    int count = 0;
+    const char* tail = sql;
+    while(tail && *tail){
+        sqlite3_stmt *stmt;
+        int rc = sqlite3_prepare_v2(db_, tail, -1, &stmt, &tail);
+        if(rc != SQLITE_OK){
+            return -1;
+        }
+        if(!stmt){
+            break;
+        }
+
+        rc = sqlite3_bind_int64(stmt, 1, secs(before) / BUCKET_SECS);
+        rc = sqlite3_step(stmt);
+        if(rc == SQLITE_DONE){
+            count += sqlite3_changes(db_);
+        }
+
+        rc = sqlite3_finalize(stmt);
+        if(rc != SQLITE_OK){
+            return -1;
+        }
+    }
+
+    return count;
+}
+
+void HeardStore::pruneExpired(qint64 bucket){
+    if(bucket <= prunedBucket_){
+        return;
+    }
+    prunedBucket_ = bucket;
+
+    int count = prune(QDateTime::fromMSecsSinceEpoch(bucket * BUCKET_SECS * 1000, Qt::UTC).addDays(-retentionDays_));
+    if(count > 0){
+        if(JS8_DEBUG_DECODE) qDebug() << "heard store pruned" << count << "rows";
+    }
+}
+
+
+/**
+ * High-Level Interface
+ **/
+
+/**
+ * @brief HeardStore::calls
+ * @param band
+ * @param since
+ * @return the last sighting of each call heard on the band since a time
+ */
+QList<HeardStore::Call> HeardStore::calls(QString band, QDateTime since){
+    // the other columns come from the row with the max utc
+    auto sql = QString("SELECT %1, MAX(utc) FROM heard_calls_v1 "
+                       "WHERE band = ? AND utc >= ? "
+                       "GROUP BY call;").arg(CALL_COLUMNS).toLatin1();
+
+    return selectCalls(sql.constData(), band, since);
+}
+
+/**
+ * @brief HeardStore::sightings
+ * @param call
+ * @param since
+ * @return every sighting of a call on any band since a time, oldest first
+ */
+QList<HeardStore::Call> HeardStore::sightings(QString call, QDateTime since){
+    auto sql = QString("SELECT %1, utc FROM heard_calls_v1 "
+                       "WHERE call = ? AND utc >= ? "
+                       "ORDER BY utc ASC;").arg(CALL_COLUMNS).toLatin1();
+
+    return selectCalls(sql.constData(), call, since);
+}
+
+/**
+ * @brief HeardStore::heardGraph
+ * @param band
+ * @param since
+ * @return the (from, to) pairs of who heard who on the band since a time
+ */
+QList<QPair<QString, QString>> HeardStore::heardGraph(QString band, QDateTime since){
+    if(!isOpen()){
+        return {};
+    }
+
+    flush();
+
+    const char* sql = "SELECT DISTINCT from_call, to_call FROM heard_graph_v1 "
+                      "WHERE band = ? AND utc >= ?;";
+
+    sqlite3_stmt *stmt;
+    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+    if(rc != SQLITE_OK){
+        return {};
+    }
+
+    bindText(stmt, 1, band);
+    rc = sqlite3_bind_int64(stmt, 2, secs(since));
+
+    QList<QPair<QString, QString>> v;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        v.append({ columnText(stmt, 0), columnText(stmt, 1) });
+    }
+
+    rc = sqlite3_finalize(stmt);
+    if(rc != SQLITE_OK){
+        return {};
+    }
+
+    return v;
+}
+
+/**
+ * @brief HeardStore::heardBy
+ * @param call
+ * @param since
+ * @param band - or any band if empty
+ * @return the stations who have heard a call since a time
+ */
+QSet<QString> HeardStore::heardBy(QString call, QDateTime since, QString band){
+    const char* sql = "SELECT DISTINCT from_call FROM heard_graph_v1 "
+                      "WHERE to_call = ?1 AND utc >= ?2 AND (?3 = '' OR band = ?3);";
+
+    return selectCallsigns(sql, call, since, band);
+}
+
+/**
+ * @brief HeardStore::hearing
+ * @param call
+ * @param since
+ * @param band - or any band if empty
+ * @return the stations a call has heard since a time
+ */
+QSet<QString> HeardStore::hearing(QString call, QDateTime since, QString band){
+    const char* sql = "SELECT DISTINCT to_call FROM heard_graph_v1 "
+                      "WHERE from_call = ?1 AND utc >= ?2 AND (?3 = '' OR band = ?3);";
+
+    return selectCallsigns(sql, call, since, band);
+}
+
+QList<HeardStore::Call> HeardStore::selectCalls(const char *sql, QString key, QDateTime since){
+    if(!isOpen()){
+        return {};
+    }
+
+    flush();
+
+    sqlite3_stmt *stmt;
+    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+    if(rc != SQLITE_OK){
+        return {};
+    }
+
+    bindText(stmt, 1, key);
+    rc = sqlite3_bind_int64(stmt, 2, secs(since));
+
+    QList<Call> v;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        Call c;
+        c.call = columnText(stmt, 0);
+        c.band = columnText(stmt, 1);
+        c.grid = columnText(stmt, 2);
+        c.dial = sqlite3_column_int(stmt, 3);
+        c.offset = sqlite3_column_int(stmt, 4);
+        c.snr = sqlite3_column_int(stmt, 5);
+        c.submode = sqlite3_column_int(stmt, 6);
+        c.tdrift = sqlite3_column_double(stmt, 7);
+        c.utcTimestamp = QDateTime::fromMSecsSinceEpoch(sqlite3_column_int64(stmt, 8) * 1000, Qt::UTC);
+        v.append(c);
+    }
+
+    rc = sqlite3_finalize(stmt);
+    if(rc != SQLITE_OK){
+        return {};
+    }
+
+    return v;
+}
+
+QSet<QString> HeardStore::selectCallsigns(const char *sql, QString call, QDateTime since, QString band){
+    if(!isOpen()){
+        return {};
+    }
+
+    flush();
+
+    sqlite3_stmt *stmt;
+    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+    if(rc != SQLITE_OK){
+        return {};
+    }
+
+    bindText(stmt, 1, call);
+    rc = sqlite3_bind_int64(stmt, 2, secs(since));
+    bindText(stmt, 3, band);
+
+    QSet<QString> v;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        v.insert(columnText(stmt, 0));
+    }
+
+    rc = sqlite3_finalize(stmt);
+    if(rc != SQLITE_OK){
+        return {};
+    }
+
+    return v;
+}
@@ -0,0 +1,103 @@
+#ifndef HEARDSTORE_H
+#define HEARDSTORE_H
+
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include <QDateTime>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QString>
+
+#include "vendor/sqlite3/sqlite3.h"
+
+/**
+ * HeardStore keeps the callsigns heard on each band, and who heard who,
+ * across sessions in an SQLite database next to the inbox.
+ *
+ * Rows are indexed by call, by band and by the hour they were heard in.
+ * Hours older than the retention are dropped as the hours roll over, so
+ * the file stays the size of the retention however long the station runs.
+ *
+ * Appends are queued in memory and written by flush() in one transaction,
+ * so the caller pays for one commit per flush instead of one per sighting.
+ * Reads flush first, so they always see what has been appended.
+ */
+class HeardStore
+{
+public:
+    struct Call {
+        QString call;
+        QString band;
+        QString grid;
+        int dial;
+        int offset;
+        int snr;
+        int submode;
+        float tdrift;
+        QDateTime utcTimestamp;
+    };
+
+    explicit HeardStore(QString path, int retentionDays=28);
+    ~HeardStore();
+
+    // Low-Level Interface
+    bool isOpen();
+    bool open();
+    void close();
+    QString error();
+    bool appendCall(Call const &value);
+    bool appendHeard(QString band, QString from, QString to, QDateTime utcTimestamp);
+    bool flush();
+    int prune(QDateTime before);
+
+    // High-Level Interface
+    QList<Call> calls(QString band, QDateTime since);
+    QList<Call> sightings(QString call, QDateTime since);
+    QList<QPair<QString, QString>> heardGraph(QString band, QDateTime since);
+    QSet<QString> heardBy(QString call, QDateTime since, QString band="");
+    QSet<QString> hearing(QString call, QDateTime since, QString band="");
+
+private:
+    struct Heard {
+        QString band;
+        QString from;
+        QString to;
+        QDateTime utcTimestamp;
+    };
+
+    bool writeCall(Call const &value);
+    bool writeHeard(Heard const &value);
+    QList<Call> selectCalls(const char *sql, QString key, QDateTime since);
+    QSet<QString> selectCallsigns(const char *sql, QString call, QDateTime since, QString band);
+    void pruneExpired(qint64 bucket);
+    bool failOpen();
+
+    QString path_;
+    int retentionDays_;
+    qint64 prunedBucket_;
+    sqlite3 * db_;
+    sqlite3_stmt * appendCall_;
+    sqlite3_stmt * appendHeard_;
+    QList<Call> pendingCalls_;
+    QList<Heard> pendingHeard_;
+    QString openError_;
+};
+
+#endif // HEARDSTORE_H
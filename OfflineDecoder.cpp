@@ -0,0 +1,309 @@
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "OfflineDecoder.h"
+
+#include <cstring>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QtEndian>
+
+extern "C" {
+  // lib/decoder_engine.f90
+  void c_init_decoder(void *context, void (*callback)(void *, decode_event const *), int patience);
+  void c_plan_decoder(char const *wisfile);
+  void c_decode_cycle(float const *ss, short int const *id2, void const *params, int ndecoders);
+}
+
+namespace {
+    // JS8 submode number, nsubmodes bit and letter, as multimode_decoder has them
+    struct Submode {
+        int submode;
+        int bit;
+        char name;
+    };
+
+    Submode const SUBMODES[] = {
+        {0, 1, 'A'},
+        {1, 2, 'B'},
+        {2, 4, 'C'},
+        {4, 8, 'E'},
+        {8, 16, 'I'},
+    };
+}
+
+OfflineDecoder::OfflineDecoder(Options const &options):
+    m_options(options),
+    m_result(),
+    m_ss(184 * NSMAX, 0.f),
+    m_planned(false)
+{
+}
+
+OfflineDecoder::~OfflineDecoder(){
+    if(m_planned){
+        c_init_decoder(nullptr, nullptr, m_options.patience);
+    }
+}
+
+/**
+ * @brief OfflineDecoder::setOptions
+ *        options for the decodes from now on, the patience only counts
+ *        before the first decode
+ * @param options
+ */
+void OfflineDecoder::setOptions(Options const &options){
+    m_options = options;
+}
+
+/**
+ * @brief OfflineDecoder::defaults
+ * @return the submodes js8call decodes, at the js8 defaults
+ */
+OfflineDecoder::Options OfflineDecoder::defaults(){
+    Options options;
+    options.submodes = submodeBits("ABCE");
+    options.depth = 1;
+    options.low = 200;
+    options.high = 4000;
+    options.threads = 1;
+    options.patience = 1;
+    return options;
+}
+
+/**
+ * @brief OfflineDecoder::decode
+ *        decode a recording, the way js8 decodes a file
+ * @param samples - 12000 Hz, read in place
+ * @param count - samples, at most NTMAX * RX_SAMPLE_RATE are decoded
+ * @param utc - hhmmss reported with the decodes
+ * @return the decodes and the time each submode took
+ */
+OfflineDecoder::Result OfflineDecoder::decode(short const *samples, int count, int utc){
+    if(!m_planned){
+        c_init_decoder(this, &OfflineDecoder::deliver, m_options.patience);
+        c_plan_decoder("");
+        m_planned = true;
+    }
+
+    count = qMin(count, NTMAX * RX_SAMPLE_RATE);
+
+    // a window of the whole recording for every submode, the decoder
+    // zero fills whatever a submode needs past the end of it
+    decltype(dec_data::params) params;
+    memset(&params, 0, sizeof(params));
+    params.nutc = utc;
+    params.ndiskdat = true;
+    params.ntrperiod = 60;
+    params.nfqso = 1500;
+    params.newdat = true;
+    params.npts8 = 74736;
+    params.nfa = m_options.low;
+    params.nfb = m_options.high;
+    params.ntol = 20;
+    params.kin = count;
+    params.kszA = params.kszB = params.kszC = params.kszE = params.kszI = count;
+    params.nzhsym = 181;
+    params.nsubmode = -1;
+    params.nsubmodes = m_options.submodes;
+    params.ndepth = m_options.depth;
+    params.lft8apon = true;
+    params.ljt65apon = true;
+    params.napwid = 75;
+    params.ntxmode = 65;
+    params.nmode = 8;
+    params.dttol = 3.f;
+    params.n2pass = 2;
+    params.nranera = 6;
+
+    m_result = Result();
+
+    QElapsedTimer timer;
+    timer.start();
+    c_decode_cycle(m_ss.data(), samples, &params, m_options.threads);
+    m_result.decode = timer.nsecsElapsed() / 1e9;
+
+    return m_result;
+}
+
+/**
+ * @brief OfflineDecoder::decodeFile
+ *        memory map a 12000 Hz mono 16 bit WAV file and decode it
+ * @param path
+ * @param utc
+ * @param result
+ * @param error - why the file could not be decoded
+ * @return true if the file was decoded
+ */
+bool OfflineDecoder::decodeFile(QString const &path, int utc, Result *result, QString *error){
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly)){
+        *error = file.errorString();
+        return false;
+    }
+    uchar const *p = file.map(0, file.size());
+    if(!p){
+        *error = file.errorString();
+        return false;
+    }
+
+    qint64 offset = 0;
+    qint64 count = 0;
+    if(!findSamples(p, file.size(), &offset, &count, error)){
+        return false;
+    }
+    count = qMin<qint64>(count, NTMAX * RX_SAMPLE_RATE);
+
+    // the decoder reads the samples in place, unless they are not host
+    // order int16s where they lie
+    short const *samples = reinterpret_cast<short const *>(p + offset);
+    if(Q_BYTE_ORDER != Q_LITTLE_ENDIAN || (reinterpret_cast<quintptr>(samples) & 1)){
+        m_copy.resize(count);
+        for(qint64 i = 0; i < count; i++){
+            m_copy[i] = qFromLittleEndian<qint16>(p + offset + 2 * i);
+        }
+        samples = m_copy.data();
+    }
+    double read = timer.nsecsElapsed() / 1e9;
+
+    *result = decode(samples, count, utc);
+    result->read = read;
+    return true;
+}
+
+//
+QString OfflineDecoder::submodeName(int submode){
+    for(auto const &s : SUBMODES){
+        if(s.submode == submode){
+            return QString(QChar(s.name));
+        }
+    }
+    return QString::number(submode);
+}
+
+/**
+ * @brief OfflineDecoder::submodeBits
+ * @param names - submode letters, like "ABCE"
+ * @return their nsubmodes bits, 0 if a letter is not a submode
+ */
+int OfflineDecoder::submodeBits(QString const &names){
+    int bits = 0;
+    for(QChar c : names.toUpper()){
+        bool found = false;
+        for(auto const &s : SUBMODES){
+            if(c == QChar(s.name)){
+                bits |= s.bit;
+                found = true;
+            }
+        }
+        if(!found){
+            return 0;
+        }
+    }
+    return bits;
+}
+
+//
+QString OfflineDecoder::text(decode_event const &event){
+    return QString::fromLatin1(event.text, strnlen(event.text, sizeof(event.text))).trimmed();
+}
+
+/**
+ * @brief OfflineDecoder::fileUtc
+ * @param path
+ * @return the UTC js8 takes from a file name, ..._hhmmss.wav or
+ *         ..._hhmm.wav, otherwise 0
+ */
+int OfflineDecoder::fileUtc(QString const &path){
+    auto match = QRegularExpression("_(\\d{6}|\\d{4})$").match(QFileInfo(path).completeBaseName());
+    return match.hasMatch() ? match.captured(1).toInt() : 0;
+}
+
+/**
+ * @brief OfflineDecoder::findSamples
+ *        find the samples of a 12000 Hz mono 16 bit PCM WAV file, the
+ *        chunks are walked so the bext, LIST etc. chunks of a BWF file
+ *        are skipped
+ * @param p - the file
+ * @param size - of the file
+ * @param offset - of the first sample
+ * @param count - of the samples
+ * @param error - why the file is not one the decoder can read
+ * @return true if the samples were found
+ */
+bool OfflineDecoder::findSamples(uchar const *p, qint64 size, qint64 *offset, qint64 *count, QString *error){
+    if(size < 12 || memcmp(p, "RIFF", 4) || memcmp(p + 8, "WAVE", 4)){
+        *error = "not a RIFF WAVE file";
+        return false;
+    }
+
+    bool format = false;
+    for(qint64 i = 12; i + 8 <= size; ){
+        quint32 chunk = qFromLittleEndian<quint32>(p + i + 4);
+        qint64 body = i + 8;
+        if(!memcmp(p + i, "fmt ", 4)){
+            if(chunk < 16 || body + 16 > size){
+                break;
+            }
+            quint16 tag = qFromLittleEndian<quint16>(p + body);
+            quint16 channels = qFromLittleEndian<quint16>(p + body + 2);
+            quint32 rate = qFromLittleEndian<quint32>(p + body + 4);
+            quint16 bits = qFromLittleEndian<quint16>(p + body + 14);
+            // 0xfffe is WAVE_FORMAT_EXTENSIBLE, still PCM with one channel
+            if((tag != 1 && tag != 0xfffe) || channels != 1 || rate != RX_SAMPLE_RATE || bits != 16){
+                *error = QString("need 12000 Hz mono 16 bit PCM, not format %1 %2 channel(s) %3 Hz %4 bit")
+                        .arg(tag).arg(channels).arg(rate).arg(bits);
+                return false;
+            }
+            format = true;
+        } else if(!memcmp(p + i, "data", 4)){
+            if(!format){
+                break;
+            }
+            *offset = body;
+            *count = qMin<qint64>(chunk, size - body) / 2;
+            return true;
+        }
+        // chunks are word aligned
+        i = body + chunk + (chunk & 1);
+    }
+
+    *error = "no fmt and data chunks";
+    return false;
+}
+
+//
+void OfflineDecoder::deliver(void *context, decode_event const *event){
+    auto decoder = static_cast<OfflineDecoder *>(context);
+    switch(event->kind){
+    case DECODE_DECODED:
+        decoder->m_result.decodes.append(*event);
+        break;
+    case DECODE_TIMING:
+        decoder->m_result.timings.append(*event);
+        break;
+    default:
+        break;
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef OFFLINEDECODER_H
+#define OFFLINEDECODER_H
+
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "commons.h"
+
+#include <vector>
+
+#include <QString>
+#include <QVector>
+
+/**
+ * OfflineDecoder runs the JS8 decoder over recordings instead of the
+ * detector's ring buffer, for the command line tools (js8batch and
+ * decoder_bench).
+ *
+ * A decode is one synchronous cycle over a whole recording, with the
+ * window of every submode starting at its first sample. The samples are
+ * read in place, a WAV file straight out of its memory mapping. The
+ * decoder's FFTs are planned on the first decode.
+ *
+ * The Fortran decoder keeps global state so there can only be one
+ * OfflineDecoder in a process, and like DecoderEngine it should decode
+ * on a thread with a 16 MB stack.
+ */
+class OfflineDecoder
+{
+public:
+    struct Options {
+        int submodes;       // nsubmodes bits
+        int depth;
+        int low;            // decoded band, Hz
+        int high;
+        int threads;        // submodes decoded in parallel, 0 for all
+        int patience;       // FFTW planning patience
+    };
+
+    struct Result {
+        QVector<decode_event> decodes;  // DECODE_DECODED events
+        QVector<decode_event> timings;  // DECODE_TIMING events, one per submode
+        double read;                    // seconds mapping the file
+        double decode;                  // seconds in the decoder
+    };
+
+    explicit OfflineDecoder(Options const &options);
+    ~OfflineDecoder();
+
+    void setOptions(Options const &options);
+
+    Result decode(short const *samples, int count, int utc);
+    bool decodeFile(QString const &path, int utc, Result *result, QString *error);
+
+    static Options defaults();
+    static QString submodeName(int submode);
+    static int submodeBits(QString const &names);
+    static QString text(decode_event const &event);
+    static int fileUtc(QString const &path);
+    static bool findSamples(uchar const *p, qint64 size, qint64 *offset, qint64 *count, QString *error);
+
+private:
+    Q_DISABLE_COPY(OfflineDecoder)
+
+    static void deliver(void *context, decode_event const *event);
+
+    Options m_options;
+    Result m_result;
+    std::vector<float> m_ss;
+    std::vector<short> m_copy;
+    bool m_planned;
+};
+
+#endif // OFFLINEDECODER_H
@@ -0,0 +1,118 @@
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "WaterfallImage.h"
+
+WaterfallImage::WaterfallImage(){
+    setColors({});
+}
+
+//
+void WaterfallImage::resize(int width, int height){
+    if(width <= 0 || height <= 0){
+        m_image = QImage();
+    } else {
+        m_image = QImage(width, height, QImage::Format_RGB32);
+    }
+    clear();
+}
+
+//
+void WaterfallImage::clear(){
+    m_image.fill(Qt::black);
+    m_top = 0;
+}
+
+/**
+ * @brief WaterfallImage::setColors
+ *        set the palette rows are written with
+ * @param colors - up to 256 colors, the rest of the palette is black
+ */
+void WaterfallImage::setColors(QVector<QColor> const &colors){
+    m_palette.fill(qRgb(0, 0, 0), 256);
+    for(int i = 0; i < qMin(colors.size(), 256); i++){
+        m_palette[i] = colors.at(i).rgb();
+    }
+}
+
+/**
+ * @brief WaterfallImage::scroll
+ *        make room for a new row at the top, the bottom row drops off
+ * @return the new top row, with whatever the bottom row held
+ */
+QRgb *WaterfallImage::scroll(){
+    if(m_image.isNull()){
+        return nullptr;
+    }
+    m_top = (m_top + m_image.height() - 1) % m_image.height();
+    return row(0);
+}
+
+/**
+ * @brief WaterfallImage::row
+ * @param r - row counted down from the top of the waterfall
+ * @return the row's scanline, width() pixels
+ */
+QRgb *WaterfallImage::row(int r){
+    if(m_image.isNull()){
+        return nullptr;
+    }
+    int y = (m_top + r) % m_image.height();
+    return reinterpret_cast<QRgb *>(m_image.scanLine(y));
+}
+
+/**
+ * @brief WaterfallImage::paintRows
+ *        paint onto the waterfall with row 0 as the top of the
+ *        waterfall, across the wrap of the image if need be
+ * @param paint
+ */
+void WaterfallImage::paintRows(std::function<void (QPainter &)> paint){
+    if(m_image.isNull()){
+        return;
+    }
+
+    QPainter painter(&m_image);
+    painter.translate(0, m_top);
+    paint(painter);
+
+    if(m_top > 0){
+        painter.resetTransform();
+        painter.translate(0, m_top - m_image.height());
+        paint(painter);
+    }
+}
+
+/**
+ * @brief WaterfallImage::draw
+ *        draw the waterfall, top row first
+ * @param painter
+ * @param x
+ * @param y
+ */
+void WaterfallImage::draw(QPainter &painter, int x, int y) const {
+    if(m_image.isNull()){
+        return;
+    }
+
+    int h = m_image.height() - m_top;
+    painter.drawImage(QPoint(x, y), m_image, QRect(0, m_top, m_image.width(), h));
+    if(m_top > 0){
+        painter.drawImage(QPoint(x, y + h), m_image, QRect(0, 0, m_image.width(), m_top));
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef WATERFALLIMAGE_H
+#define WATERFALLIMAGE_H
+
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include <functional>
+
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+#include <QRgb>
+#include <QVector>
+
+/**
+ * WaterfallImage holds the rows of a waterfall in a circular image.
+ *
+ * Adding a row moves the top of the waterfall up by one row of the image
+ * rather than moving every pixel down, and rows are written straight into
+ * the image's scanlines through a 256 entry palette. The image is drawn in
+ * two pieces, from the top row to the bottom of the image and then from
+ * the top of the image down to the row above the top.
+ */
+class WaterfallImage
+{
+public:
+    WaterfallImage();
+
+    void resize(int width, int height);
+    void clear();
+
+    void setColors(QVector<QColor> const &colors);
+    QRgb const *palette() const { return m_palette.constData(); }
+
+    int width() const { return m_image.width(); }
+    int height() const { return m_image.height(); }
+    bool isNull() const { return m_image.isNull(); }
+
+    QRgb *scroll();
+    QRgb *row(int r);
+
+    void paintRows(std::function<void (QPainter &)> paint);
+    void draw(QPainter &painter, int x, int y) const;
+
+private:
+    QImage m_image;
+    QVector<QRgb> m_palette;
+    int m_top = 0;
+};
+
+#endif // WATERFALLIMAGE_H
@@ -156,6 +156,51 @@ extern struct {
   char  mycall[12];
 } foxcom_;
 
+  /*
+   * Events delivered by the in process decoder, these MUST be kept in
+   * sync with lib/decoder_engine.f90
+   */
+enum decode_event_kind {
+  DECODE_STARTED = 0,           // count: submodes being decoded
+  DECODE_SYNC_META = 1,         // start, size: window of a submode
+  DECODE_SYNC_CANDIDATE = 2,    // freq, sync, dt: sync candidate
+  DECODE_SYNC_DECODE = 3,       // freq, sync, dt: candidate that decoded
+  DECODE_DECODED = 4,           // a decoded frame
+  DECODE_FINISHED = 5,          // count: number of decodes
+  DECODE_TIMING = 6,            // tslot, tsync, tdecode, nfft, nfftreused: time spent on a submode
+  DECODE_PLANNED = 7            // tslot: time spent planning the decoder's FFTs
+};
+
+struct decode_event {
+  int   kind;                   // decode_event_kind
+  int   submode;                // JS8 submode, -1 if not applicable
+  int   utc;                    // hhmmss
+  int   snr;
+  float dt;
+  float freq;
+  float sync;
+  float qual;                   // [0.0,1.0]
+  int   nap;                    // a priori type, 0 if none
+  int   start;
+  int   size;
+  int   count;
+  float tslot;                  // seconds
+  float tsync;
+  float tdecode;
+  int   nfft;                   // long downsample FFTs computed
+  int   nfftreused;             // and reused
+  char  text[40];               // decoded message, NUL terminated
+};
+
+  /*
+   * With --binary-events the js8 subprocess writes its events to stdout
+   * as frames of DECODE_FRAME_MAGIC, the payload size as an int and the
+   * decode_event itself. Its text output goes to stderr instead, so only
+   * a decoder started without it writes lines of text to stdout.
+   */
+#define DECODE_FRAME_MAGIC      "\0JS8"
+#define DECODE_FRAME_MAGIC_SIZE 4
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,154 @@
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+/**
+ * decimator_bench - checks Decimator against fil4 and times them both
+ *
+ * Down samples a minute of 48 kHz audio (tones in noise) with fil4, the
+ * way the Detector used to in blocks of 4 * 3584 samples, and with the
+ * Decimator fed in blocks of the sizes audio devices tend to deliver.
+ * Every output sample is compared with fil4's and the throughput of each
+ * is reported in input samples per second.
+ *
+ * The two add the same products in a different order, so a sample right
+ * at a rounding boundary can come out one step from fil4's: over the
+ * default minute 137 of 720000 samples do. It fails (and so does the
+ * ctest) if any sample is further off than TOLERANCE, or if more than
+ * MISMATCH_FRACTION of them are off at all.
+ *
+ *   decimator_bench [seconds]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Decimator.hpp"
+
+extern "C" {
+  void   fil4_(short*, int*, short*, int*);
+}
+
+namespace {
+    int const RATE = 48000;
+    int const FIL4_BLOCK = 4 * 7 * 512;     // what Detector handed fil4
+    int const TOLERANCE = 1;                // steps from fil4's sample
+    double const MISMATCH_FRACTION = 1e-3;  // of samples not equal to fil4's
+
+    std::vector<short> audio(int seconds){
+        std::vector<short> x(seconds * RATE);
+        unsigned seed = 2463534242u;
+        double const f[] = {1000.5, 1512.25, 2048.0, 4450.0, 5800.0, 9000.0};
+        for(size_t i = 0; i < x.size(); i++){
+            double t = double(i) / RATE;
+            double y = 0;
+            for(double fk : f){
+                y += 1500 * std::sin(2 * M_PI * fk * t);
+            }
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            y += (int(seed % 4001) - 2000);
+            x[i] = short(std::lround(y));
+        }
+        return x;
+    }
+
+    double seconds(std::chrono::steady_clock::time_point start){
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double fil4Rate(std::vector<short> const &x, std::vector<short> &y){
+        std::vector<short> block(FIL4_BLOCK);
+        y.assign(x.size() / 4, 0);
+
+        auto start = std::chrono::steady_clock::now();
+        size_t k = 0;
+        for(size_t i = 0; i + FIL4_BLOCK <= x.size(); i += FIL4_BLOCK){
+            // fil4 takes a non-const buffer, give it a copy as Detector did
+            std::copy(x.begin() + i, x.begin() + i + FIL4_BLOCK, block.begin());
+            int n1 = FIL4_BLOCK;
+            int n2 = 0;
+            fil4_(block.data(), &n1, &y[k], &n2);
+            k += n2;
+        }
+        double t = seconds(start);
+        y.resize(k);
+        return k * 4 / t;
+    }
+
+    double decimatorRate(std::vector<short> const &x, size_t blockSize, std::vector<short> &y){
+        Decimator decimator;
+        y.assign(x.size() / 4 + 1, 0);
+
+        auto start = std::chrono::steady_clock::now();
+        size_t k = 0;
+        for(size_t i = 0; i < x.size(); i += blockSize){
+            size_t n = std::min(blockSize, x.size() - i);
+            k += decimator.process(&x[i], n, &y[k]);
+        }
+        double t = seconds(start);
+        y.resize(k);
+        return x.size() / t;
+    }
+}
+
+int main(int argc, char *argv[]){
+    int duration = argc > 1 ? std::atoi(argv[1]) : 60;
+    if(duration <= 0){
+        fprintf(stderr, "usage: decimator_bench [seconds]\n");
+        return 1;
+    }
+
+    auto x = audio(duration);
+    x.resize(x.size() / FIL4_BLOCK * FIL4_BLOCK);
+
+    std::vector<short> expected;
+    double before = fil4Rate(x, expected);
+
+    printf("%d s of %d Hz audio, fil4 %.1f Msamples/s\n", duration, RATE, before / 1e6);
+    printf("%8s %14s %8s %10s %8s\n", "block", "Msamples/s", "speedup", "mismatch", "maxdiff");
+
+    bool ok = true;
+    for(size_t blockSize : {1u, 441u, 480u, 512u, 1024u, 4096u, 14336u}){
+        std::vector<short> y;
+        double after = decimatorRate(x, blockSize, y);
+
+        size_t mismatch = 0;
+        int maxdiff = 0;
+        for(size_t i = 0; i < expected.size(); i++){
+            int d = std::abs(y.at(i) - expected.at(i));
+            if(d){
+                mismatch++;
+                maxdiff = std::max(maxdiff, d);
+            }
+        }
+
+        ok = ok && y.size() == expected.size() && maxdiff <= TOLERANCE && mismatch <= MISMATCH_FRACTION * expected.size();
+
+        printf("%8zu %14.1f %7.1fx %10zu %8d\n", blockSize, after / 1e6, after / before, mismatch, maxdiff);
+    }
+
+    if(!ok){
+        printf("Decimator output differs from fil4 by more than %d step(s) or in more than %g of samples\n", TOLERANCE, MISMATCH_FRACTION);
+        return 1;
+    }
+    return 0;
+}
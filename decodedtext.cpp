@@ -6,6 +6,8 @@
 
 #include <varicode.h>
 
+#include "commons.h"
+
 extern "C" {
   bool stdmsg_(char const * msg, bool contest_mode, char const * mygrid, fortran_charlen_t, fortran_charlen_t);
 }
@@ -27,6 +29,64 @@ DecodedText::DecodedText (QString const& the_string, bool contest_mode, QString
   , bits_{0}
   , submode_{ string_.mid(column_mode + padding_, 3).trimmed().at(0).cell() - 'A' }
   , frame_ { string_.mid (column_qsoText + padding_, 12).trimmed () }
+  , snr_ { string_.mid (string_.indexOf (" ") + 1, 3).toInt () }
+  , dt_ { string_.mid (column_dt + padding_, 5).toFloat () }
+  , frequencyOffset_ { string_.mid (column_freq + padding_, 4).toInt () }
+  , isLowConfidence_ { QChar {'?'} == string_.mid (padding_ + column_qsoText + 21, 1) }
+{
+    parseMessage(my_grid);
+
+    bits_ = string_.right(5).trimmed().toShort();
+
+    tryUnpack();
+}
+
+// the fields of a decoder event as they are, without going through the line format
+DecodedText::DecodedText (decode_event const& event, bool contest_mode, QString const& my_grid)
+  : padding_ {2}
+  , contest_mode_ {contest_mode}
+  , message_ {QString::fromLatin1 (event.text, qstrnlen (event.text, sizeof (event.text))).trimmed ()}
+  , is_standard_ {false}
+  , frameType_(Varicode::FrameUnknown)
+  , isHeartbeat_(false)
+  , isAlt_(false)
+  , bits_{0}
+  , submode_{event.submode}
+  , frame_ {message_.left (12).trimmed ()}
+  , snr_ {event.snr}
+  , dt_ {event.dt}
+  , frequencyOffset_ {qRound (event.freq)}
+  , isLowConfidence_ {QChar {'?'} == message_.mid (21, 1)}
+{
+    // the bits follow the frame, the ; messages have none
+    if(!message_.contains(';')){
+        bits_ = message_.mid(12, 10).trimmed().toShort();
+    }
+
+    parseMessage(my_grid);
+
+    tryUnpack();
+}
+
+DecodedText::DecodedText (QString const& js8callmessage, int bits, int submode):
+    frameType_(Varicode::FrameUnknown),
+    message_(js8callmessage),
+    isHeartbeat_(false),
+    isAlt_(false),
+    bits_(bits),
+    submode_(submode),
+    frame_(js8callmessage),
+    snr_(0),
+    dt_(0),
+    frequencyOffset_(0),
+    isLowConfidence_(false)
+{
+    is_standard_ = QRegularExpression("^(CQ|DE|QRZ)\\s").match(message_).hasMatch();
+
+    tryUnpack();
+}
+
+void DecodedText::parseMessage(QString const& my_grid)
 {
     if(message_.length() >= 1) {
         message_ = message_.left (21).remove (QRegularExpression {"[<>]"});
@@ -60,24 +120,6 @@ DecodedText::DecodedText (QString const& the_string, bool contest_mode, QString
             is_standard_ = QRegularExpression("^(CQ|DE|QRZ)\\s").match(message_).hasMatch();
         }
     }
-
-    bits_ = bits();
-
-    tryUnpack();
-}
-
-DecodedText::DecodedText (QString const& js8callmessage, int bits, int submode):
-    frameType_(Varicode::FrameUnknown),
-    message_(js8callmessage),
-    isHeartbeat_(false),
-    isAlt_(false),
-    bits_(bits),
-    submode_(submode),
-    frame_(js8callmessage)
-{
-    is_standard_ = QRegularExpression("^(CQ|DE|QRZ)\\s").match(message_).hasMatch();
-
-    tryUnpack();
 }
 
 bool DecodedText::tryUnpack(){
@@ -323,27 +365,6 @@ bool DecodedText::isTX() const
     return (i >= 0 && i < 15); // TODO guessing those numbers. Does Tx ever move?
 }
 
-bool DecodedText::isLowConfidence () const
-{
-  return QChar {'?'} == string_.mid (padding_ + column_qsoText + 21, 1);
-}
-
-int DecodedText::frequencyOffset() const
-{
-    return string_.mid(column_freq + padding_,4).toInt();
-}
-
-int DecodedText::snr() const
-{
-  int i1=string_.indexOf(" ")+1;
-  return string_.mid(i1,3).toInt();
-}
-
-float DecodedText::dt() const
-{
-  return string_.mid(column_dt + padding_,5).toFloat();
-}
-
 /*
 2343 -11  0.8 1259 # YV6BFE F6GUU R-08
 2343 -19  0.3  718 # VE6WQ SQ2NIJ -14
@@ -12,6 +12,7 @@
 #include <QString>
 #include <QStringList>
 
+struct decode_event;
 
 
 /*
@@ -31,6 +32,7 @@ class DecodedText
 {
 public:
   explicit DecodedText (QString const& message, bool, QString const& my_grid);
+  explicit DecodedText (decode_event const& event, bool, QString const& my_grid);
   explicit DecodedText (QString const& js8callmessage, int bits, int submode);
 
   bool tryUnpack();
@@ -69,12 +71,12 @@ public:
   bool isJT9() const;
   bool isTX() const;
   bool isStandardMessage () const {return is_standard_;}
-  bool isLowConfidence () const;
-  int frequencyOffset() const;  // hertz offset from the tuned dial or rx frequency, aka audio frequency
-  int snr() const;
+  bool isLowConfidence () const { return isLowConfidence_; }
+  int frequencyOffset() const { return frequencyOffset_; }  // hertz offset from the tuned dial or rx frequency, aka audio frequency
+  int snr() const { return snr_; }
   bool hasBits() const { return !string_.right(5).trimmed().isEmpty(); }
-  int bits() const { return string_.right(5).trimmed().toShort(); }
-  float dt() const;
+  int bits() const { return bits_; }
+  float dt() const { return dt_; }
   int submode() const { return submode_; }
 
   // find and extract any report. Returns true if this is a standard message
@@ -92,6 +94,8 @@ public:
   QString report() const;
 
 private:
+  void parseMessage(QString const& my_grid);
+
   // These define the columns in the decoded text where fields are to be found.
   // We rely on these columns being the same in the fortran code (lib/decoder.f90) that formats the decoded text
   enum Columns {column_time    = 0,
@@ -115,6 +119,10 @@ private:
   int bits_;
   int submode_;
   QString frame_;
+  int snr_;
+  float dt_;
+  int frequencyOffset_;
+  bool isLowConfidence_;
 };
 
 #endif // DECODEDTEXT_H
@@ -0,0 +1,515 @@
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+/**
+ * decoder_bench - decodes, false decodes and time per stage of the decoder
+ *
+ * Runs the whole decode pipeline (syncjs8, js8dec, bpdecode174/osd174 and
+ * subtractjs8) over bands synthesized with genjs8, a band per submode with
+ * signals at a spread of SNRs, frequencies and DTs in white noise, and over
+ * any recordings given on the command line. The noise is seeded so every
+ * run decodes the same audio.
+ *
+ * Decodes of a synthesized band are checked against the messages sent, a
+ * decode of anything else is a false decode. Recordings named like the
+ * ones in media/tests, {MODE}_{DEPTH}_{EXPECTED_DECODES}.wav, are decoded
+ * in that submode at that depth and checked against the expected count.
+ *
+ * Every case is decoded repeats times over and the fastest time of each
+ * stage is kept. With a golden file the run is compared against it and
+ * the exit status is 1 if a case lost a decode, gained a false decode or
+ * a stage got slower than the tolerance allows. --update writes the run
+ * as the new golden file. With --no-times only the decodes are compared
+ * and written, which is how media/tests/decoder_golden.json is kept for
+ * the decoder test, as the times depend on the machine.
+ *
+ *   decoder_bench [-d depth] [-r repeats] [-g golden.json [-u] [-t tolerance]] [--no-times] [dir|file...]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStringList>
+#include <QThread>
+
+#include "wsjtx_config.h"
+#include "OfflineDecoder.h"
+
+extern "C" {
+  void genjs8_(char* msg, int* icos, char* MyGrid, bool* bcontest, int* i3bit, char* msgsent,
+               char ft8msgbits[], int itone[], fortran_charlen_t, fortran_charlen_t,
+               fortran_charlen_t);
+}
+
+namespace {
+    double const NOISE = 1000.;     // rms of the noise, in int16 steps
+
+    struct Band {
+        int submode;
+        int nsps;
+        int seconds;
+        int delayMs;
+        int threshold;              // dB, about where decodes give out
+    };
+
+    Band const BANDS[] = {
+        {0, JS8A_SYMBOL_SAMPLES, JS8A_TX_SECONDS, JS8A_START_DELAY_MS, -24},
+        {1, JS8B_SYMBOL_SAMPLES, JS8B_TX_SECONDS, JS8B_START_DELAY_MS, -22},
+        {2, JS8C_SYMBOL_SAMPLES, JS8C_TX_SECONDS, JS8C_START_DELAY_MS, -19},
+        {4, JS8E_SYMBOL_SAMPLES, JS8E_TX_SECONDS, JS8E_START_DELAY_MS, -27},
+        {8, JS8I_SYMBOL_SAMPLES, JS8I_TX_SECONDS, JS8I_START_DELAY_MS, -17},
+    };
+
+    // offsets of the signals in a band, from the strongest to the weakest
+    int const SIGNALS = 8;
+    int const SNR_OFFSETS[SIGNALS] = {12, 9, 6, 4, 2, 1, 0, -2};
+    double const DTS[SIGNALS] = {0.0, 0.3, 0.6, 0.9, 0.15, 0.45, 0.75, 0.05};
+
+    // xorshift, so the bands are the same on every platform
+    class Random {
+    public:
+        explicit Random(quint32 seed): m_seed(seed) {}
+
+        quint32 next(){
+            m_seed ^= m_seed << 13;
+            m_seed ^= m_seed >> 17;
+            m_seed ^= m_seed << 5;
+            return m_seed;
+        }
+
+        double uniform(){
+            return (next() + 0.5) / 4294967296.0;
+        }
+
+        double gaussian(){
+            return std::sqrt(-2. * std::log(uniform())) * std::cos(2. * M_PI * uniform());
+        }
+
+    private:
+        quint32 m_seed;
+    };
+
+    struct Case {
+        QString name;
+        int submodes;
+        int depth;
+        std::vector<short> samples;     // synthesized
+        QString path;                   // or a recording
+        QStringList sent;               // the messages in a synthesized band
+        int expected;                   // decodes of a recording, -1 if unknown
+    };
+
+    struct Run {
+        QStringList decodes;
+        int found;
+        int falseDecodes;
+        double seconds;                 // fastest of the repeats
+        double sync;
+        double decode;
+        int nfft;
+        int nfftreused;
+    };
+
+    QString message(Random &random){
+        // genjs8 packs each character into 6 bits, so only the first 64
+        // of its alphabet can be sent ("/?." would overflow)
+        static char const alphabet[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz-+";
+        QString msg;
+        for(int i = 0; i < 12; i++){
+            msg.append(QChar(alphabet[random.next() % (sizeof(alphabet) - 1)]));
+        }
+        return msg;
+    }
+
+    std::vector<int> tones(QString const &msg, int submode){
+        QByteArray padded = msg.toLatin1().leftJustified(22, ' ');
+        int icos = submode == 0 ? 1 : 2;
+        bool bcontest = false;
+        int i3bit = 0;
+        char grid[6] = {' ', ' ', ' ', ' ', ' ', ' '};
+        char msgsent[22];
+        char msgbits[87];
+        std::vector<int> itone(JS8_NUM_SYMBOLS);
+        genjs8_(padded.data(), &icos, grid, &bcontest, &i3bit, msgsent, msgbits, itone.data(), 22, 6, 22);
+        return itone;
+    }
+
+    // continuous phase FSK, as Modulator sends it
+    void addSignal(std::vector<double> &band, std::vector<int> const &itone, int nsps, double f0, double start, double amp){
+        double const df = double(RX_SAMPLE_RATE) / nsps;
+        long i0 = std::lround(start * RX_SAMPLE_RATE);
+        double phi = 0.;
+        for(int j = 0; j < JS8_NUM_SYMBOLS; j++){
+            double dphi = 2. * M_PI * (f0 + itone[j] * df) / RX_SAMPLE_RATE;
+            for(int k = 0; k < nsps; k++){
+                long i = i0 + long(j) * nsps + k;
+                if(i >= 0 && i < long(band.size())){
+                    band[i] += amp * std::sin(phi);
+                }
+                phi += dphi;
+            }
+        }
+    }
+
+    /**
+     * a band of SIGNALS signals of a submode, at SNRs in 2500 Hz around
+     * the submode's threshold, spread over the passband with a gap of
+     * 50 Hz between them and a fraction of a Hz off the bin centres
+     */
+    Case synthesize(Band const &b, int depth){
+        Case c;
+        c.name = QString("synthetic %1").arg(OfflineDecoder::submodeName(b.submode));
+        c.submodes = OfflineDecoder::submodeBits(OfflineDecoder::submodeName(b.submode));
+        c.depth = depth;
+        c.expected = -1;
+
+        Random random(2463534242u + b.submode);
+        std::vector<double> band(b.seconds * RX_SAMPLE_RATE);
+        for(auto &x : band){
+            x = NOISE * random.gaussian();
+        }
+
+        double bandwidth = 8. * RX_SAMPLE_RATE / b.nsps;
+        for(int i = 0; i < SIGNALS; i++){
+            QString msg = message(random);
+            c.sent.append(msg);
+
+            double snr = b.threshold + SNR_OFFSETS[i];
+            double amp = std::sqrt(2. * NOISE * NOISE * 2500. / RX_SAMPLE_RATE * 2. * std::pow(10., snr / 10.));
+            double f0 = 500. + i * (bandwidth + 50.) + 0.37 * i;
+            double start = b.delayMs / 1000. + DTS[i];
+            addSignal(band, tones(msg, b.submode), b.nsps, f0, start, amp);
+        }
+
+        c.samples.resize(band.size());
+        for(size_t i = 0; i < band.size(); i++){
+            c.samples[i] = short(std::max(-32767L, std::min(32767L, std::lround(band[i]))));
+        }
+        return c;
+    }
+
+    // recordings, with the submode, depth and decodes from names like A_2_9.wav
+    QList<Case> recordings(QStringList const &paths, int depth){
+        QStringList files;
+        for(auto const &path : paths){
+            QFileInfo info(path);
+            if(info.isDir()){
+                QDir dir(path);
+                for(auto const &name : dir.entryList({"*.wav", "*.WAV"}, QDir::Files, QDir::Name)){
+                    files.append(dir.filePath(name));
+                }
+            } else {
+                files.append(path);
+            }
+        }
+
+        QList<Case> cases;
+        for(auto const &file : files){
+            Case c;
+            c.name = QFileInfo(file).completeBaseName();
+            c.path = file;
+            c.submodes = OfflineDecoder::defaults().submodes;
+            c.depth = depth;
+            c.expected = -1;
+
+            auto match = QRegularExpression("^([A-Z])_(\\d)_(\\d+)$").match(c.name);
+            if(match.hasMatch() && OfflineDecoder::submodeBits(match.captured(1))){
+                c.submodes = OfflineDecoder::submodeBits(match.captured(1));
+                c.depth = match.captured(2).toInt();
+                c.expected = match.captured(3).toInt();
+            }
+            cases.append(c);
+        }
+        return cases;
+    }
+
+    /**
+     * the bench itself, on a thread of its own as the decoder keeps large
+     * automatic arrays on the stack when built with OpenMP
+     */
+    class Bench : public QThread {
+    public:
+        Bench(QList<Case> const &cases, int repeats):
+            m_cases(cases),
+            m_repeats(repeats)
+        {
+            setStackSize(16 * 1024 * 1024);
+        }
+
+        QList<Run> const &runs() const { return m_runs; }
+        QString const &error() const { return m_error; }
+
+    protected:
+        void run() override {
+            OfflineDecoder decoder(OfflineDecoder::defaults());
+
+            // the cases take turns so no decode follows one of the same audio
+            for(int r = 0; r < m_repeats && m_error.isEmpty(); r++){
+                for(int i = 0; i < m_cases.size() && m_error.isEmpty(); i++){
+                    decode(decoder, m_cases.at(i), r, i);
+                }
+            }
+        }
+
+    private:
+        void decode(OfflineDecoder &decoder, Case const &c, int repeat, int index){
+            auto options = OfflineDecoder::defaults();
+            options.submodes = c.submodes;
+            options.depth = c.depth;
+            decoder.setOptions(options);
+
+            OfflineDecoder::Result result;
+            if(c.path.isEmpty()){
+                result = decoder.decode(c.samples.data(), int(c.samples.size()), 0);
+            } else if(!decoder.decodeFile(c.path, 0, &result, &m_error)){
+                m_error = c.path + ": " + m_error;
+                return;
+            }
+
+            double tsync = 0.;
+            double tdecode = 0.;
+            int nfft = 0;
+            int nfftreused = 0;
+            for(auto const &event : result.timings){
+                tsync += event.tsync;
+                tdecode += event.tdecode;
+                nfft += event.nfft;
+                nfftreused += event.nfftreused;
+            }
+
+            if(repeat > 0){
+                Run &fastest = m_runs[index];
+                fastest.seconds = std::min(fastest.seconds, result.decode);
+                fastest.sync = std::min(fastest.sync, tsync);
+                fastest.decode = std::min(fastest.decode, tdecode);
+                return;
+            }
+
+            Run run;
+            run.found = 0;
+            run.falseDecodes = 0;
+            QSet<QString> found;
+            for(auto const &event : result.decodes){
+                QString text = OfflineDecoder::text(event);
+                run.decodes.append(text);
+                if(c.sent.isEmpty()){
+                    continue;
+                }
+                QString msg = text.left(12);
+                if(c.sent.contains(msg)){
+                    found.insert(msg);
+                } else {
+                    run.falseDecodes++;
+                }
+            }
+            run.decodes.sort();
+            run.found = c.sent.isEmpty() ? run.decodes.size() : found.size();
+            run.seconds = result.decode;
+            run.sync = tsync;
+            run.decode = tdecode;
+            run.nfft = nfft;
+            run.nfftreused = nfftreused;
+            m_runs.append(run);
+        }
+
+        QList<Case> m_cases;
+        int m_repeats;
+        QList<Run> m_runs;
+        QString m_error;
+    };
+
+    QJsonObject json(Run const &run, bool times){
+        QJsonObject o{
+            {"found", run.found},
+            {"false", run.falseDecodes},
+            {"decodes", QJsonArray::fromStringList(run.decodes)},
+        };
+        if(times){
+            o.insert("seconds", run.seconds);
+            o.insert("sync", run.sync);
+            o.insert("decode", run.decode);
+            o.insert("fft", run.nfft);
+            o.insert("fftreused", run.nfftreused);
+        }
+        return o;
+    }
+
+    /**
+     * what got worse against the golden run of a case, empty if nothing,
+     * the stages are only timed if the golden run has times
+     */
+    QStringList regressions(Run const &run, QJsonObject const &golden, double tolerance){
+        QStringList worse;
+        if(golden.isEmpty()){
+            return worse;
+        }
+
+        if(run.found < golden.value("found").toInt()){
+            worse.append(QString("found %1 < %2").arg(run.found).arg(golden.value("found").toInt()));
+        }
+        if(run.falseDecodes > golden.value("false").toInt()){
+            worse.append(QString("false %1 > %2").arg(run.falseDecodes).arg(golden.value("false").toInt()));
+        }
+        for(auto const &text : golden.value("decodes").toArray()){
+            if(!run.decodes.contains(text.toString())){
+                worse.append(QString("lost \"%1\"").arg(text.toString()));
+            }
+        }
+
+        struct { char const *key; double value; } const stages[] = {
+            {"seconds", run.seconds},
+            {"sync", run.sync},
+            {"decode", run.decode},
+        };
+        for(auto const &stage : stages){
+            if(!golden.contains(stage.key)){
+                continue;
+            }
+            double limit = golden.value(stage.key).toDouble() * (1. + tolerance);
+            // below a few milliseconds a stage is all timer noise
+            if(stage.value > limit && stage.value > 0.005){
+                worse.append(QString("%1 %2 s > %3 s").arg(QString(stage.key)).arg(stage.value, 0, 'f', 3).arg(limit, 0, 'f', 3));
+            }
+        }
+        return worse;
+    }
+}
+
+int main(int argc, char *argv[]){
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Decodes synthesized bands and recordings, checks the decodes and times the stages.");
+    parser.addHelpOption();
+    QCommandLineOption depthOption(QStringList() << "d" << "depth", "Decoding depth (1-3) of the synthesized bands, default 2.", "depth", "2");
+    QCommandLineOption repeatsOption(QStringList() << "r" << "repeats", "Decode every case this many times, default 3.", "repeats", "3");
+    QCommandLineOption goldenOption(QStringList() << "g" << "golden", "Compare against the golden results in <file>.", "file");
+    QCommandLineOption updateOption(QStringList() << "u" << "update", "Write this run to the golden file instead.");
+    QCommandLineOption toleranceOption(QStringList() << "t" << "tolerance", "How much slower a stage may get, default 0.25 (25%).", "fraction", "0.25");
+    QCommandLineOption noSynthOption("no-synthetic", "Only decode the recordings.");
+    QCommandLineOption noTimesOption("no-times", "Only compare and write the decodes, not the times.");
+    parser.addOption(depthOption);
+    parser.addOption(repeatsOption);
+    parser.addOption(goldenOption);
+    parser.addOption(updateOption);
+    parser.addOption(toleranceOption);
+    parser.addOption(noSynthOption);
+    parser.addOption(noTimesOption);
+    parser.addPositionalArgument("recordings", "WAV files, or directories of them.", "[dir|file...]");
+    parser.process(app);
+
+    int depth = parser.value(depthOption).toInt();
+    int repeats = parser.value(repeatsOption).toInt();
+    double tolerance = parser.value(toleranceOption).toDouble();
+    if(depth <= 0 || repeats <= 0 || tolerance < 0 || (parser.isSet(updateOption) && !parser.isSet(goldenOption))){
+        parser.showHelp(1);
+    }
+
+    QList<Case> cases;
+    if(!parser.isSet(noSynthOption)){
+        for(auto const &b : BANDS){
+            cases.append(synthesize(b, depth));
+        }
+    }
+    cases.append(recordings(parser.positionalArguments(), depth));
+    if(cases.isEmpty()){
+        parser.showHelp(1);
+    }
+
+    QJsonObject golden;
+    if(parser.isSet(goldenOption) && !parser.isSet(updateOption)){
+        QFile file(parser.value(goldenOption));
+        if(!file.open(QIODevice::ReadOnly)){
+            fprintf(stderr, "%s: %s\n", qPrintable(file.fileName()), qPrintable(file.errorString()));
+            return 1;
+        }
+        golden = QJsonDocument::fromJson(file.readAll()).object().value("cases").toObject();
+    }
+    bool times = !parser.isSet(noTimesOption);
+
+    Bench bench(cases, repeats);
+    bench.start();
+    bench.wait();
+    if(!bench.error().isEmpty()){
+        fprintf(stderr, "%s\n", qPrintable(bench.error()));
+        return 1;
+    }
+
+    printf("depth %d, fastest of %d, times in seconds\n", depth, repeats);
+    printf("%-20s %5s %5s %5s %8s %8s %8s %9s  %s\n",
+           "case", "sent", "found", "false", "wall", "sync", "decode", "fft/reuse", "status");
+
+    QJsonObject cases_;
+    int failed = 0;
+    for(int i = 0; i < cases.size(); i++){
+        auto const &c = cases.at(i);
+        auto const &run = bench.runs().at(i);
+
+        int sent = c.sent.isEmpty() ? c.expected : c.sent.size();
+        auto goldenRun = golden.value(c.name).toObject();
+        if(!times){
+            for(auto key : {"seconds", "sync", "decode"}){
+                goldenRun.remove(key);
+            }
+        }
+        QStringList worse = regressions(run, goldenRun, tolerance);
+        if(!worse.isEmpty()){
+            failed++;
+        }
+
+        printf("%-20s %5s %5d %5s %8.3f %8.3f %8.3f %4d/%-4d  %s\n",
+               qPrintable(c.name),
+               sent < 0 ? "-" : qPrintable(QString::number(sent)),
+               run.found,
+               c.sent.isEmpty() ? "-" : qPrintable(QString::number(run.falseDecodes)),
+               run.seconds, run.sync, run.decode, run.nfft, run.nfftreused,
+               worse.isEmpty() ? "ok" : qPrintable(worse.join(", ")));
+
+        cases_.insert(c.name, json(run, times));
+    }
+
+    if(parser.isSet(updateOption)){
+        QFile file(parser.value(goldenOption));
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+            fprintf(stderr, "%s: %s\n", qPrintable(file.fileName()), qPrintable(file.errorString()));
+            return 1;
+        }
+        file.write(QJsonDocument(QJsonObject{{"depth", depth}, {"repeats", repeats}, {"cases", cases_}}).toJson());
+        printf("golden results written to %s\n", qPrintable(file.fileName()));
+        return 0;
+    }
+
+    if(failed){
+        printf("%d of %d cases regressed\n", failed, cases.size());
+        return 1;
+    }
+    return 0;
+}
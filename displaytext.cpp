@@ -312,96 +312,3 @@ void DisplayText::displayFoxToBeCalled(QString t, QColor bg)
 {
   appendText(t,bg);
 }
-
-namespace
-{
-  void update_selection (QTextCursor& cursor, QColor const& bg, QColor const& fg)
-  {
-    if (!cursor.isNull ())
-      {
-        QTextCharFormat format {cursor.charFormat ()};
-        if (bg.isValid ())
-          {
-            format.setBackground (bg);
-          }
-        else
-          {
-            format.clearBackground ();
-          }
-        if (fg.isValid ())
-          {
-            format.setForeground (fg);
-          }
-        else
-          {
-            format.clearForeground ();
-          }
-        cursor.mergeCharFormat (format);
-      }
-  }
-
-  void reset_selection (QTextCursor& cursor)
-  {
-    if (!cursor.isNull ())
-      {
-        // restore previous text format, we rely on the text
-        // char format at he start of the selection being the
-        // old one which should be the case
-        auto c2 = cursor;
-        c2.setPosition (c2.selectionStart ());
-        cursor.setCharFormat (c2.charFormat ());
-      }
-  }
-}
-
-void DisplayText::highlight_callsign (QString const& callsign, QColor const& bg, QColor const& fg, bool last_only)
-{
-  QTextCharFormat old_format {currentCharFormat ()};
-  QTextCursor cursor {document ()};
-  if (last_only)
-    {
-      cursor.movePosition (QTextCursor::End);
-      cursor = document ()->find (callsign, cursor
-                                  , QTextDocument::FindBackward | QTextDocument::FindWholeWords);
-      if (bg.isValid () || fg.isValid ())
-        {
-          update_selection (cursor, bg, fg);
-        }
-      else
-        {
-          reset_selection (cursor);
-        }
-    }
-  else
-    {
-      auto pos = highlighted_calls_.find (callsign);
-      if (bg.isValid () || fg.isValid ())
-        {
-          auto colours = qMakePair (bg, fg);
-          if (pos == highlighted_calls_.end ())
-            {
-              pos = highlighted_calls_.insert (callsign.toUpper (), colours);
-            }
-          else
-            {
-              pos.value () = colours; // update colours
-            }
-          while (!cursor.isNull ())
-            {
-              cursor = document ()->find (callsign, cursor, QTextDocument::FindWholeWords);
-              update_selection (cursor, bg, fg);
-            }
-        }
-      else if (pos != highlighted_calls_.end ())
-        {
-          highlighted_calls_.erase (pos);
-          QTextCursor cursor {document ()};
-          while (!cursor.isNull ())
-            {
-              cursor = document ()->find (callsign, cursor, QTextDocument::FindWholeWords);
-              reset_selection (cursor);
-            }
-        }
-    }
-  setCurrentCharFormat (old_format);
-}
@@ -36,7 +36,6 @@ public:
   Q_SLOT void appendText (QString const& text, QColor bg = Qt::white
                           , QString const& call1 = QString {}, QString const& call2 = QString {});
   Q_SLOT void erase ();
-  Q_SLOT void highlight_callsign (QString const& callsign, QColor const& bg, QColor const& fg, bool last_only);
 
 protected:
   void mouseDoubleClickEvent(QMouseEvent *e);
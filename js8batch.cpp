@@ -0,0 +1,346 @@
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+/**
+ * js8batch - decodes directories of WAV files, a file per core at a time
+ *
+ * The files are 12000 Hz mono 16 bit WAV files, as js8 reads and as the
+ * js8call save menu writes, with or without the extra chunks of a BWF
+ * file. Each is memory mapped and decoded with the in process decoder
+ * (lib/decoder_engine.f90) reading its windows straight out of the
+ * mapping.
+ *
+ * The decoder keeps its state in Fortran module variables so there can
+ * only be one decode running in a process. Files are decoded in parallel
+ * by worker processes, js8batch --worker, each taking the next file name
+ * from its stdin and answering with one JSON line of results. A worker
+ * plans the decoder's FFTs once and then decodes file after file.
+ *
+ * The results file has a JSON object per file, in the order the files
+ * were given, with the decodes (submode, snr, dt, freq, text...), the
+ * time spent mapping and decoding the file and the time each submode
+ * took. A summary with the files per second goes to stderr.
+ *
+ *   js8batch [-j jobs] [-b ABCE] [-d depth] [-o results.json] dir|file...
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+
+#include "OfflineDecoder.h"
+
+namespace {
+    QJsonObject json(QString const &path, OfflineDecoder::Result const &result){
+        QJsonArray decodes;
+        for(auto const &event : result.decodes){
+            decodes.append(QJsonObject{
+                {"submode", OfflineDecoder::submodeName(event.submode)},
+                {"utc", event.utc},
+                {"snr", event.snr},
+                {"dt", event.dt},
+                {"freq", event.freq},
+                {"sync", event.sync},
+                {"qual", event.qual},
+                {"nap", event.nap},
+                {"text", OfflineDecoder::text(event)},
+            });
+        }
+
+        QJsonObject submodes;
+        for(auto const &event : result.timings){
+            submodes.insert(OfflineDecoder::submodeName(event.submode), QJsonObject{
+                {"slot", event.tslot},
+                {"sync", event.tsync},
+                {"decode", event.tdecode},
+                {"fft", event.nfft},
+                {"fftreused", event.nfftreused},
+            });
+        }
+
+        return QJsonObject{
+            {"file", path},
+            {"utc", OfflineDecoder::fileUtc(path)},
+            {"read", result.read},
+            {"decode", result.decode},
+            {"decodes", decodes},
+            {"submodes", submodes},
+        };
+    }
+
+    /**
+     * a worker's decoder, on a thread of its own as the decoder keeps
+     * large automatic arrays on the stack when built with OpenMP
+     */
+    class Worker : public QThread {
+    public:
+        explicit Worker(OfflineDecoder::Options const &options):
+            m_options(options)
+        {
+            setStackSize(16 * 1024 * 1024);
+        }
+
+    protected:
+        void run() override {
+            OfflineDecoder decoder(m_options);
+
+            char line[4096];
+            while(fgets(line, sizeof(line), stdin)){
+                QString path = QString::fromLocal8Bit(line).trimmed();
+                if(path.isEmpty()){
+                    continue;
+                }
+
+                OfflineDecoder::Result result;
+                QString error;
+                QJsonObject object;
+                if(decoder.decodeFile(path, OfflineDecoder::fileUtc(path), &result, &error)){
+                    object = json(path, result);
+                } else {
+                    object = QJsonObject{{"file", path}, {"error", error}};
+                }
+
+                QByteArray record = QJsonDocument(object).toJson(QJsonDocument::Compact);
+                fwrite(record.constData(), 1, record.size(), stdout);
+                fputc('\n', stdout);
+                fflush(stdout);
+            }
+        }
+
+    private:
+        OfflineDecoder::Options m_options;
+    };
+
+    QStringList wavFiles(QStringList const &paths){
+        QStringList files;
+        for(auto const &path : paths){
+            QFileInfo info(path);
+            if(info.isDir()){
+                QDir dir(path);
+                for(auto const &name : dir.entryList({"*.wav", "*.WAV"}, QDir::Files, QDir::Name)){
+                    files.append(dir.filePath(name));
+                }
+            } else {
+                files.append(path);
+            }
+        }
+        return files;
+    }
+
+    /**
+     * hand the files out to jobs workers a file at a time and write their
+     * results in file order, as soon as the files before them are done
+     */
+    int batch(QCoreApplication &app, QStringList const &workerArgs, QStringList const &files, int jobs, QFile &output){
+        QVector<QByteArray> results(files.size());
+        QVector<QProcess *> workers;
+        QHash<QProcess *, int> current;
+        int next = 0;
+        int done = 0;
+        int written = 0;
+        int decodes = 0;
+        int failed = 0;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        std::function<void ()> start;
+
+        auto feed = [&](QProcess *worker){
+            if(next < files.size()){
+                current.insert(worker, next);
+                worker->write(files.at(next++).toLocal8Bit() + '\n');
+            } else {
+                current.remove(worker);
+                worker->closeWriteChannel();
+            }
+        };
+
+        auto finish = [&](int index, QByteArray const &json){
+            auto result = QJsonDocument::fromJson(json).object();
+            decodes += result.value("decodes").toArray().size();
+            if(result.contains("error")){
+                failed++;
+                fprintf(stderr, "%s: %s\n", qPrintable(files.at(index)), qPrintable(result.value("error").toString()));
+            }
+            results[index] = json;
+            done++;
+            while(written < results.size() && !results.at(written).isEmpty()){
+                output.write(results.at(written) + '\n');
+                results[written++].clear();
+            }
+            output.flush();
+            if(done == files.size()){
+                app.quit();
+            }
+        };
+
+        start = [&](){
+            auto worker = new QProcess(&app);
+            worker->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+            // as the js8 subprocess gets, for the decoder's OpenMP workers
+            QProcessEnvironment env {QProcessEnvironment::systemEnvironment()};
+            env.insert("OMP_STACKSIZE", "4M");
+            worker->setProcessEnvironment(env);
+            workers.append(worker);
+
+            QObject::connect(worker, &QProcess::readyReadStandardOutput, [&, worker](){
+                while(worker->canReadLine()){
+                    QByteArray line = worker->readLine().trimmed();
+                    // the decoder may write the odd line of its own
+                    if(!line.startsWith('{') || !current.contains(worker)){
+                        continue;
+                    }
+                    int index = current.value(worker);
+                    feed(worker);
+                    finish(index, line);
+                }
+            });
+
+            QObject::connect(worker, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), [&, worker](int, QProcess::ExitStatus){
+                // a worker that dies takes its file with it, another takes its place
+                if(current.contains(worker)){
+                    int index = current.take(worker);
+                    QJsonObject result {{"file", files.at(index)}, {"error", "worker exited"}};
+                    finish(index, QJsonDocument(result).toJson(QJsonDocument::Compact));
+                    if(next < files.size()){
+                        start();
+                    }
+                }
+            });
+
+            worker->start(QCoreApplication::applicationFilePath(), workerArgs);
+            if(!worker->waitForStarted()){
+                // the workers already running exit when their stdin closes
+                fprintf(stderr, "js8batch: cannot start a worker: %s\n", qPrintable(worker->errorString()));
+                std::exit(1);
+            }
+            feed(worker);
+        };
+
+        for(int i = 0; i < qMin(jobs, files.size()); i++){
+            start();
+        }
+        if(!files.isEmpty()){
+            app.exec();
+        }
+
+        for(auto worker : workers){
+            worker->closeWriteChannel();
+            worker->waitForFinished();
+        }
+
+        double t = timer.nsecsElapsed() / 1e9;
+        fprintf(stderr, "%d files, %d decodes, %d failed in %.2f s with %d jobs, %.2f files/s\n",
+                files.size(), decodes, failed, t, jobs, t > 0 ? files.size() / t : 0.);
+        return failed ? 1 : 0;
+    }
+}
+
+int main(int argc, char *argv[]){
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Decodes the JS8 signals in 12000 Hz mono WAV files, a file per core at a time.");
+    parser.addHelpOption();
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs", "Files decoded in parallel, default the number of cores.", "jobs", QString::number(QThread::idealThreadCount()));
+    QCommandLineOption submodesOption(QStringList() << "b" << "sub-modes", "Submodes decoded, default ABCE.", "letters", "ABCE");
+    QCommandLineOption depthOption(QStringList() << "d" << "depth", "Decoding depth (1-3), default 1.", "depth", "1");
+    QCommandLineOption lowOption(QStringList() << "L" << "lowest", "Lowest frequency decoded, default 200 Hz.", "hertz", "200");
+    QCommandLineOption highOption(QStringList() << "H" << "highest", "Highest frequency decoded, default 4000 Hz.", "hertz", "4000");
+    QCommandLineOption threadsOption(QStringList() << "t" << "decoder-threads", "Submodes of a file decoded in parallel, default 1.", "threads", "1");
+    QCommandLineOption patienceOption(QStringList() << "w" << "patience", "FFTW3 planning patience (0-4), default 1.", "patience", "1");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "Write the results to <file> instead of stdout.", "file");
+    QCommandLineOption workerOption("worker", "Decode the files named on stdin (used by js8batch itself).");
+    parser.addOption(jobsOption);
+    parser.addOption(submodesOption);
+    parser.addOption(depthOption);
+    parser.addOption(lowOption);
+    parser.addOption(highOption);
+    parser.addOption(threadsOption);
+    parser.addOption(patienceOption);
+    parser.addOption(outputOption);
+    parser.addOption(workerOption);
+    parser.addPositionalArgument("files", "WAV files, or directories of them.", "dir|file...");
+    parser.process(app);
+
+    auto options = OfflineDecoder::defaults();
+    options.submodes = OfflineDecoder::submodeBits(parser.value(submodesOption));
+    options.depth = parser.value(depthOption).toInt();
+    options.low = parser.value(lowOption).toInt();
+    options.high = parser.value(highOption).toInt();
+    options.threads = qMax(parser.value(threadsOption).toInt(), 0);
+    options.patience = parser.value(patienceOption).toInt();
+    int jobs = parser.value(jobsOption).toInt();
+
+    if(!options.submodes || jobs <= 0){
+        parser.showHelp(1);
+    }
+
+    if(parser.isSet(workerOption)){
+        Worker worker(options);
+        worker.start();
+        worker.wait();
+        return 0;
+    }
+
+    QStringList files = wavFiles(parser.positionalArguments());
+    if(files.isEmpty()){
+        parser.showHelp(1);
+    }
+
+    QFile output;
+    bool opened;
+    if(parser.isSet(outputOption)){
+        output.setFileName(parser.value(outputOption));
+        opened = output.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    } else {
+        opened = output.open(stdout, QIODevice::WriteOnly);
+    }
+    if(!opened){
+        fprintf(stderr, "%s: %s\n", qPrintable(output.fileName()), qPrintable(output.errorString()));
+        return 1;
+    }
+
+    // the workers get the same decode options
+    QStringList workerArgs {"--worker",
+        "-b", parser.value(submodesOption),
+        "-d", QString::number(options.depth),
+        "-L", QString::number(options.low),
+        "-H", QString::number(options.high),
+        "-t", QString::number(options.threads),
+        "-w", QString::number(options.patience)};
+
+    return batch(app, workerArgs, files, jobs, output);
+}
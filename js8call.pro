@@ -33,6 +33,15 @@ gfortran.commands = $$F90 -c -O2 -o ${QMAKE_FILE_OUT} ${QMAKE_FILE_NAME}
 gfortran.input = F90_SOURCES
 QMAKE_EXTRA_COMPILERS += gfortran
 
+# JSC dictionary trie, generated from JSC::list by jsc_trie_gen
+JSC_TRIE_GEN = jsc_trie_gen.cpp
+jsctrie.output = jsc_trie.cpp
+jsctrie.commands = $(CXX) $(CXXFLAGS) $(INCPATH) -o jsc_trie_gen ${QMAKE_FILE_NAME} $$PWD/jsc_list.cpp $(LIBS) && ./jsc_trie_gen ${QMAKE_FILE_OUT}
+jsctrie.depends = $$PWD/jsc_list.cpp $$PWD/jsc.h
+jsctrie.input = JSC_TRIE_GEN
+jsctrie.variable_out = SOURCES
+QMAKE_EXTRA_COMPILERS += jsctrie
+
 win32 {
 DEFINES += WIN32
 QT += axcontainer
@@ -59,7 +68,7 @@ SOURCES += \
   FrequencyList.cpp StationList.cpp ForeignKeyDelegate.cpp \
   FrequencyItemDelegate.cpp LiveFrequencyValidator.cpp \
   Configuration.cpp	psk_reporter.cpp AudioDevice.cpp \
-  Modulator.cpp Detector.cpp logqso.cpp displaytext.cpp \
+  Modulator.cpp Detector.cpp Decimator.cpp logqso.cpp displaytext.cpp \
   getfile.cpp soundout.cpp soundin.cpp meterwidget.cpp signalmeter.cpp \
   WFPalette.cpp plotter.cpp widegraph.cpp about.cpp mainwindow.cpp \
   main.cpp decodedtext.cpp messageaveraging.cpp \
@@ -80,6 +89,7 @@ SOURCES += \
     jsc_checker.cpp \
     Message.cpp \
     Inbox.cpp \
+    HeardStore.cpp \
     messagewindow.cpp \
     SpotClient.cpp \
     TCPClient.cpp \
@@ -92,6 +102,9 @@ SOURCES += \
     ProcessThread.cpp \
     DecoderThread.cpp \
     Decoder.cpp \
+    DecoderEngine.cpp \
+    DecodeTrace.cpp \
+    WaterfallImage.cpp \
     APRSISClient.cpp \
     MessageServer.cpp \
     fileutils.cpp
@@ -103,7 +116,7 @@ HEADERS  += qt_helpers.hpp \
   about.h WFPalette.hpp widegraph.h getfile.h decodedtext.h \
   commons.h sleep.h displaytext.h logqso.h LettersSpinBox.hpp \
   Bands.hpp FrequencyList.hpp StationList.hpp ForeignKeyDelegate.hpp FrequencyItemDelegate.hpp LiveFrequencyValidator.hpp \
-  FrequencyLineEdit.hpp AudioDevice.hpp Detector.hpp Modulator.hpp psk_reporter.h \
+  FrequencyLineEdit.hpp AudioDevice.hpp Detector.hpp Decimator.hpp Modulator.hpp psk_reporter.h \
   Transceiver.hpp TransceiverBase.hpp TransceiverFactory.hpp PollingTransceiver.hpp \
   EmulateSplitTransceiver.hpp DXLabSuiteCommanderTransceiver.hpp HamlibTransceiver.hpp \
   Configuration.hpp signalmeter.h meterwidget.h \
@@ -113,6 +126,7 @@ HEADERS  += qt_helpers.hpp \
   IARURegions.hpp MessageBox.hpp EqualizationToolsDialog.hpp \
     qorderedmap.h \
     varicode.h \
+    BitVector.h \
     qpriorityqueue.h \
     crc.h \
     NetworkMessage.hpp \
@@ -125,6 +139,7 @@ HEADERS  += qt_helpers.hpp \
     jsc_checker.h \
     Message.h \
     Inbox.h \
+    HeardStore.h \
     messagewindow.h \
     SpotClient.h \
     TCPClient.h \
@@ -137,6 +152,9 @@ HEADERS  += qt_helpers.hpp \
     ProcessThread.h \
     DecoderThread.h \
     Decoder.h \
+    DecoderEngine.h \
+    DecodeTrace.h \
+    WaterfallImage.h \
     APRSISClient.h \
     MessageServer.h \
     fileutils.h
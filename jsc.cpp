@@ -21,30 +21,28 @@
 #include "jsc.h"
 #include "varicode.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include <QDebug>
-#include <QCache>
-
-QMap<QString, quint32> LOOKUP_CACHE;
 
 Codeword JSC::codeword(quint32 index, bool separate, quint32 bytesize, quint32 s, quint32 c){
-    QList<Codeword> out;
-
-    quint32 v = ((index % s) << 1) + (quint32)separate;
-    out.prepend(Varicode::intToBits(v, bytesize + 1));
+    // the continuer bytes, last first, ahead of the stopper byte and its separator bit
+    quint32 bytes[8];
+    int n = 0;
 
     quint32 x = index / s;
-    while(x > 0){
+    while(x > 0 && n < 8){
         x -= 1;
-        out.prepend(Varicode::intToBits((x % c) + s, bytesize));
+        bytes[n++] = (x % c) + s;
         x /= c;
     }
 
     Codeword word;
-    foreach(auto w, out){
-        word.append(w);
+    while(n > 0){
+        word.append(bytes[--n], bytesize);
     }
+    word.append(((index % s) << 1) + (quint32)separate, bytesize + 1);
 
     return word;
 }
@@ -117,11 +115,10 @@ QString JSC::decompress(Codeword const& bitvec){
     int i = 0;
     int count = bitvec.count();
     while(i < count){
-        auto b = bitvec.mid(i, 4);
-        if(b.length() != 4){
+        if(count - i < 4){
             break;
         }
-        quint64 byte = Varicode::bitsToInt(b);
+        quint64 byte = bitvec.value(i, 4);
         bytes.append(byte);
         i += 4;
 
@@ -178,61 +175,48 @@ bool JSC::exists(QString w, quint32 *pIndex){
 }
 
 quint32 JSC::lookup(QString w, bool * ok){
-    if(LOOKUP_CACHE.contains(w)){
-        if(ok) *ok = true;
-        return LOOKUP_CACHE[w];
-    }
-
-    bool found = false;
-    quint32 result = lookup(w.toLatin1().data(), &found);
-    if(found){
-        LOOKUP_CACHE[w] = result;
-    }
-
-    if(ok) *ok = found;
-    return result;
+    return lookup(w.toLatin1().constData(), ok);
 }
 
+// the word of the list that prefixes b, walking the trie one byte at a time.
+// where more than one word prefixes b the one first in the list wins, as it
+// did when the list was scanned. the trie is read only, so this is safe to
+// call from any thread.
 quint32 JSC::lookup(char const* b, bool *ok){
-    quint32 index = 0;
-    quint32 count = 0;
-    bool found = false;
+    qint32 entry = -1;
 
-    // first find prefix match to jump into the list faster
-    for(quint32 i = 0; i < JSC::prefixSize; i++){
-        // skip obvious non-prefixes...
-        if(b[0] != JSC::prefix[i].str[0]){
-            continue;
+    qint32 node = 0;
+    for(auto p = reinterpret_cast<uchar const*>(b); *p; p++){
+        node = trieChild(node, *p);
+        if(node < 0){
+            break;
         }
 
-        // ok, we found one... let's end early for single char strings.
-        if(JSC::prefix[i].size == 1){
-            if(ok) *ok = true;
-            return JSC::list[JSC::prefix[i].index].index;
+        auto const &child = JSC::trie[node];
+        if(child.entry >= 0 && (entry < 0 || child.entry < entry)){
+            entry = child.entry;
         }
-
-        // otherwise, keep track of the first index in the list and the number of elements
-        index = JSC::prefix[i].index;
-        count = JSC::prefix[i].size;
-        found = true;
-        break;
     }
 
-    // no prefix found... no lookup
-    if(!found){
+    if(entry < 0){
         if(ok) *ok = false;
         return 0;
     }
 
-    // now that we have the first index in the list, let's just iterate through the list, comparing words along the way
-    for(quint32 i = index; i < index + count; i++){
-        quint32 len = JSC::list[i].size;
-        if(strncmp(b, JSC::list[i].str, len) == 0){
-            if(ok) *ok = true;
-            return JSC::list[i].index;
-        }
-    }
+    if(ok) *ok = true;
+    return JSC::list[entry].index;
+}
 
-    if(ok) *ok = false;
-    return 0;
+// the child of a trie node on the edge labeled label, -1 for none
+qint32 JSC::trieChild(quint32 node, quint8 label){
+    auto const &parent = JSC::trie[node];
+    auto first = JSC::trie + parent.child;
+    auto last = first + parent.count;
+    auto child = std::lower_bound(first, last, label, [](TrieNode const &n, quint8 label){
+        return n.label < label;
+    });
+    if(child == last || child->label != label){
+        return -1;
+    }
+    return child - JSC::trie;
 }
@@ -12,8 +12,10 @@
 #include <QPair>
 #include <QVector>
 
-typedef QPair<QVector<bool>, quint32> CodewordPair;        // Tuple(Codeword, N) where N = number of characters
-typedef QVector<bool> Codeword;                        // Codeword bit vector
+#include "BitVector.h"
+
+typedef QPair<BitVector, quint32> CodewordPair;        // Tuple(Codeword, N) where N = number of characters
+typedef BitVector Codeword;                            // Codeword bit vector
 
 typedef struct Tuple{
     char const * str;
@@ -21,6 +23,13 @@ typedef struct Tuple{
     int index;
 } Tuple;
 
+typedef struct TrieNode{
+    quint32 child;      // first child, the children of a node are consecutive and sorted by label
+    qint32 entry;       // position in JSC::list of the word ending here, -1 for none
+    quint16 count;      // number of children
+    quint8 label;       // latin1 byte on the edge into this node
+} TrieNode;
+
 class JSC
 {
 public:
@@ -35,6 +44,7 @@ public:
     static bool exists(QString w, quint32 *pIndex);
     static quint32 lookup(QString w, bool *ok);
     static quint32 lookup(char const* b, bool *ok);
+    static qint32 trieChild(quint32 node, quint8 label);
 
     static const quint32 size = 262144;
     static const Tuple map[262144];
@@ -42,6 +52,10 @@ public:
 
     static const quint32 prefixSize = 103;
     static const Tuple prefix[103];
+
+    // generated from list at build time by jsc_trie_gen
+    static const quint32 trieSize;
+    static const TrieNode trie[];
 };
 
 #endif // JSC_H
@@ -0,0 +1,289 @@
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+/**
+ * jsc_bench - checks the JSC trie against the list scan it replaced and
+ * times them both
+ *
+ * Looks up every word of the dictionary, every word with a few letters
+ * after it (the prefix match JSC::compress makes) and as many strings
+ * that are not words, with JSC::lookup and with the prefix table and
+ * bucket scan it used to do. Every result is compared and the lookups
+ * per second of each are reported. Then the trie is looked up from as
+ * many threads at once and checked against the single thread results.
+ *
+ * Last it asks JSCChecker for the suggestions for misspellings of the
+ * dictionary words, and builds them the way it used to, from every one
+ * edit variant of the misspelling, comparing them and timing both.
+ *
+ *   jsc_bench [threads]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+
+#include "jsc.h"
+#include "jsc_checker.h"
+
+namespace {
+    // JSC::lookup before the trie, a bucket of the list scanned with strncmp
+    quint32 scanLookup(char const* b, bool *ok){
+        quint32 index = 0;
+        quint32 count = 0;
+        bool found = false;
+
+        for(quint32 i = 0; i < JSC::prefixSize; i++){
+            if(b[0] != JSC::prefix[i].str[0]){
+                continue;
+            }
+
+            if(JSC::prefix[i].size == 1){
+                if(ok) *ok = true;
+                return JSC::list[JSC::prefix[i].index].index;
+            }
+
+            index = JSC::prefix[i].index;
+            count = JSC::prefix[i].size;
+            found = true;
+            break;
+        }
+
+        if(!found){
+            if(ok) *ok = false;
+            return 0;
+        }
+
+        for(quint32 i = index; i < index + count; i++){
+            quint32 len = JSC::list[i].size;
+            if(strncmp(b, JSC::list[i].str, len) == 0){
+                if(ok) *ok = true;
+                return JSC::list[i].index;
+            }
+        }
+
+        if(ok) *ok = false;
+        return 0;
+    }
+
+    // JSCChecker::suggestions before it followed the trie, every one edit
+    // variant of the word looked up
+    QSet<QString> oneEdit(QString word){
+        QString const alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+        QSet<QString> all;
+        for(int i = 0; i < 26; i++){
+            all.insert(alphabet.mid(i, 1) + word);
+            all.insert(word + alphabet.mid(i, 1));
+
+            for(int j = 0; j < word.length(); j++){
+                all.insert(word.mid(0, j) + alphabet.mid(i, 1) + word.mid(j + 1, word.length() - j));
+            }
+        }
+
+        for(int j = 0; j < word.length(); j++){
+            all.insert(word.mid(0, j) + word.mid(j + 1, word.length() - j));
+        }
+
+        return all;
+    }
+
+    QStringList scanSuggestions(QString word, int n){
+        QMap<quint32, QString> m;
+
+        bool found = false;
+        quint32 index = JSC::lookup(word, &found);
+        if(found && JSC::map[index].size > 1){
+            m[index] = QString::fromLatin1(JSC::map[index].str, JSC::map[index].size);
+        }
+
+        foreach(auto w, oneEdit(word)){
+            if(JSC::exists(w, &index)){
+                m[index] = w;
+            }
+        }
+
+        QStringList s;
+        foreach(auto key, m.uniqueKeys()){
+            if(s.length() >= n){
+                break;
+            }
+            s.append(m[key]);
+        }
+        return s;
+    }
+
+    // a misspelling of every 97th word: a letter changed, dropped or added
+    QStringList misspellings(){
+        unsigned seed = 88172645u;
+        QStringList out;
+        for(quint32 i = 0; i < JSC::size; i += 97){
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+
+            QString word = QString::fromLatin1(JSC::list[i].str, JSC::list[i].size);
+            int at = seed % (word.length() + 1);
+            QChar letter('A' + (seed >> 8) % 26);
+            switch((seed >> 16) % 3){
+                case 0: word.replace(qMin(at, word.length() - 1), 1, letter); break;
+                case 1: word.remove(qMin(at, word.length() - 1), 1); break;
+                case 2: word.insert(at, letter); break;
+            }
+            out.append(word);
+        }
+        return out;
+    }
+
+    QList<QByteArray> queries(){
+        QByteArray const tails[] = { "S", "ING", "/P", "73" };
+
+        // a fixed xorshift seed so every run looks up the same text
+        unsigned seed = 2463534242u;
+        QList<QByteArray> out;
+        for(quint32 i = 0; i < JSC::size; i++){
+            QByteArray word(JSC::list[i].str, JSC::list[i].size);
+            out.append(word);
+
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            out.append(word + tails[seed % 4]);
+
+            QByteArray miss = word;
+            miss[0] = "0123456789?.,"[seed % 13];
+            out.append(miss.toLower());
+        }
+        return out;
+    }
+
+    // the results of a lookup, the index or -1 where nothing was found
+    template<typename Lookup>
+    std::vector<qint64> lookupAll(QList<QByteArray> const &words, Lookup lookup, int from=0, int step=1){
+        std::vector<qint64> out(words.size(), -1);
+        for(int i = from; i < words.size(); i += step){
+            bool ok = false;
+            quint32 index = lookup(words.at(i).constData(), &ok);
+            out[i] = ok ? (qint64)index : -1;
+        }
+        return out;
+    }
+
+    double seconds(std::chrono::steady_clock::time_point start){
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char *argv[]){
+    int threads = argc > 1 ? std::atoi(argv[1]) : (int)std::thread::hardware_concurrency();
+    if(threads <= 0){
+        fprintf(stderr, "usage: jsc_bench [threads]\n");
+        return 1;
+    }
+
+    auto words = queries();
+    printf("%d lookups, %u words, %u trie nodes\n", words.size(), JSC::size, JSC::trieSize);
+
+    auto start = std::chrono::steady_clock::now();
+    auto before = lookupAll(words, scanLookup);
+    double scan = seconds(start);
+
+    start = std::chrono::steady_clock::now();
+    auto after = lookupAll(words, [](char const *b, bool *ok){ return JSC::lookup(b, ok); });
+    double trie = seconds(start);
+
+    int mismatch = 0;
+    int found = 0;
+    for(int i = 0; i < words.size(); i++){
+        if(before[i] != after[i]){
+            mismatch++;
+        }
+        if(after[i] >= 0){
+            found++;
+        }
+    }
+    printf("%-8s %14s %14s %8s %10s\n", "", "before Mlk/s", "after Mlk/s", "speedup", "mismatch");
+    printf("%-8s %14.3f %14.3f %7.1fx %10d\n", "lookup",
+           words.size() / scan / 1e6, words.size() / trie / 1e6, scan / trie, mismatch);
+    printf("%d found\n", found);
+
+    // the same lookups shared out over the threads, all at once
+    std::vector<std::vector<qint64>> results(threads);
+    std::vector<std::thread> workers;
+    start = std::chrono::steady_clock::now();
+    for(int t = 0; t < threads; t++){
+        workers.emplace_back([&, t](){
+            results[t] = lookupAll(words, [](char const *b, bool *ok){ return JSC::lookup(b, ok); }, t, threads);
+        });
+    }
+    for(auto &worker : workers){
+        worker.join();
+    }
+    double parallel = seconds(start);
+
+    int threadMismatch = 0;
+    for(int i = 0; i < words.size(); i++){
+        if(results[i % threads][i] != after[i]){
+            threadMismatch++;
+        }
+    }
+    printf("%d threads %.3f Mlk/s, %d mismatch\n", threads, words.size() / parallel / 1e6, threadMismatch);
+
+    // suggestions
+    auto misspelled = misspellings();
+
+    QList<QStringList> suggestedBefore;
+    start = std::chrono::steady_clock::now();
+    foreach(auto word, misspelled){
+        suggestedBefore.append(scanSuggestions(word, 5));
+    }
+    double suggestBefore = seconds(start);
+
+    QList<QStringList> suggestedAfter;
+    start = std::chrono::steady_clock::now();
+    foreach(auto word, misspelled){
+        suggestedAfter.append(JSCChecker::suggestions(word, 5, nullptr));
+    }
+    double suggestAfter = seconds(start);
+
+    int suggestMismatch = 0;
+    for(int i = 0; i < misspelled.size(); i++){
+        if(suggestedBefore.at(i) != suggestedAfter.at(i)){
+            suggestMismatch++;
+        }
+    }
+    printf("%-8s %14s %14s %8s %10s\n", "", "before us/wd", "after us/wd", "speedup", "mismatch");
+    printf("%-8s %14.1f %14.1f %7.1fx %10d\n", "suggest",
+           suggestBefore / misspelled.size() * 1e6, suggestAfter / misspelled.size() * 1e6,
+           suggestBefore / suggestAfter, suggestMismatch);
+
+    if(mismatch || threadMismatch || suggestMismatch){
+        printf("trie lookups or suggestions differ from the list scan\n");
+        return 1;
+    }
+    return 0;
+}
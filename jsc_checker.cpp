@@ -20,186 +20,299 @@
 
 #include "jsc_checker.h"
 
+#include <QtConcurrent/QtConcurrentRun>
 #include <QTextEdit>
-#include <QTextBlock>
 #include <QTextCursor>
 #include <QTextDocument>
-#include <QTextLayout>
 #include <QDebug>
 
 #include "jsc.h"
 #include "varicode.h"
 
-const int CORRECT = QTextFormat::UserProperty + 10;
-const QString ALPHABET = { "ABCDEFGHIJKLMNOPQRSTUVWXYZ" };
+namespace {
+    // the checked words of a session, kept between checks so only new words are looked up
+    const int MAX_CACHED_WORDS = 10000;
 
-JSCChecker::JSCChecker(QObject *parent) :
-    QObject(parent)
-{
-}
-
-bool cursorHasProperty(const QTextCursor &cursor, int property){
-    if(property < QTextFormat::UserProperty) {
-        return false;
+    bool isWordChar(QChar ch){
+        return ch.isLetterOrNumber() || ch == '_';
     }
-    if(cursor.charFormat().intProperty(property) == 1) {
-        return true;
+
+    bool isNumeric(QString const &s){
+        foreach(auto ch, s){
+            if(!ch.isDigit()){
+                return false;
+            }
+        }
+        return !s.isEmpty();
     }
-    const QList<QTextLayout::FormatRange>& formats = cursor.block().layout()->additionalFormats();
-    int pos = cursor.positionInBlock();
-    foreach(const QTextLayout::FormatRange& range, formats) {
-        if(pos > range.start && pos <= range.start + range.length && range.format.intProperty(property) == 1) {
+
+    bool isCorrect(QString const &word){
+        // three or less is always "correct"
+        if(word.length() < 4 || isNumeric(word)){
+            return true;
+        }
+
+        bool found = false;
+        quint32 index = JSC::lookup(word, &found);
+        if(found && JSC::map[index].size == word.length()){
             return true;
         }
+
+        return Varicode::isValidCallsign(word, nullptr);
+    }
+
+    // the trie node reached from node by bytes [from, to) of word, -1 where it falls off the trie
+    qint32 walk(qint32 node, QByteArray const &word, int from, int to){
+        for(int i = from; i < to && node >= 0; i++){
+            node = JSC::trieChild(node, word.at(i));
+        }
+        return node;
+    }
+
+    // the nodes under node on the letters A-Z
+    template<typename Visit>
+    void forEachLetter(qint32 node, Visit visit){
+        auto const &parent = JSC::trie[node];
+        for(quint32 i = parent.child; i < parent.child + parent.count; i++){
+            char label = JSC::trie[i].label;
+            if(label >= 'A' && label <= 'Z'){
+                visit(i, label);
+            }
+        }
+    }
+
+    bool endsWord(qint32 node){
+        return node >= 0 && JSC::trie[node].entry >= 0;
+    }
+
+    // every word of the dictionary one edit from word: a letter substituted
+    // or deleted anywhere, or added to the front or back. the edits follow
+    // the trie, so only the branches that lead to words are tried.
+    QMap<quint32, QString> candidates(QString const &word){
+        QMap<quint32, QString> m;
+
+        QByteArray w = word.toLatin1();
+        int len = w.length();
+
+        auto add = [&m](QByteArray const &candidate){
+            quint32 index = 0;
+            auto c = QString::fromLatin1(candidate);
+            if(JSC::exists(c, &index)){
+                m[index] = c;
+            }
+        };
+
+        // the nodes of the word's prefixes
+        QVector<qint32> path(len + 1, -1);
+        path[0] = 0;
+        for(int i = 0; i < len && path[i] >= 0; i++){
+            path[i + 1] = JSC::trieChild(path[i], w.at(i));
+        }
+
+        for(int j = 0; j < len && path[j] >= 0; j++){
+            // deleted
+            if(endsWord(walk(path[j], w, j + 1, len))){
+                add(w.left(j) + w.mid(j + 1));
+            }
+
+            // substituted
+            forEachLetter(path[j], [&](qint32 node, char ch){
+                if(endsWord(walk(node, w, j + 1, len))){
+                    add(w.left(j) + ch + w.mid(j + 1));
+                }
+            });
+        }
+
+        // prefixed
+        forEachLetter(0, [&](qint32 node, char ch){
+            if(endsWord(walk(node, w, 0, len))){
+                add(ch + w);
+            }
+        });
+
+        // suffixed
+        if(path[len] >= 0){
+            forEachLetter(path[len], [&](qint32 node, char ch){
+                if(endsWord(node)){
+                    add(w + ch);
+                }
+            });
+        }
+
+        return m;
     }
-    return false;
 }
 
-QString nextChar(QTextCursor c){
-    QTextCursor cur(c);
-    cur.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
-    return cur.selectedText().toUpper();
+JSCChecker::JSCChecker(QObject *parent) :
+    QObject(parent),
+    m_revision(0),
+    m_pending(false)
+{
+    connect(&m_watcher, &QFutureWatcher<Ranges>::finished, this, &JSCChecker::checked);
 }
 
-bool isNumeric(QString s){
-    return s.indexOf(QRegExp("^\\d+$")) == 0;
+JSCChecker::~JSCChecker(){
+    m_watcher.waitForFinished();
 }
 
-bool isWordChar(QString ch){
-    return ch.contains(QRegExp("^\\w$"));
+/**
+ * @brief JSCChecker::checkLater
+ * check the words of the edit on a worker thread and underline the
+ * misspelled ones when it is done, if the edit hasn't changed since
+ */
+void JSCChecker::checkLater(QTextEdit *edit){
+    m_edit = edit;
+
+    // a check is running, the latest text is checked when it finishes
+    if(m_watcher.isRunning()){
+        m_pending = true;
+        return;
+    }
+
+    check();
 }
 
-void JSCChecker::checkRange(QTextEdit* edit, int start, int end)
-{
-    if(end == -1){
-        QTextCursor tmpCursor(edit->textCursor());
-        tmpCursor.movePosition(QTextCursor::End);
-        end = tmpCursor.position();
+void JSCChecker::check(){
+    m_pending = false;
+    if(!m_edit){
+        return;
     }
 
-    // stop contentsChange signals from being emitted due to changed charFormats
-    edit->document()->blockSignals(true);
+    if(m_cache.size() > MAX_CACHED_WORDS){
+        m_cache.clear();
+    }
 
-    //qDebug() << "checking range " << start << " - " << end;
+    m_revision = m_edit->document()->revision();
 
-    QTextCharFormat errorFmt;
-    errorFmt.setFontUnderline(true);
-    errorFmt.setUnderlineColor(Qt::red);
-    errorFmt.setUnderlineStyle(QTextCharFormat::WaveUnderline);
-    QTextCharFormat defaultFormat = QTextCharFormat();
+    QString text = m_edit->document()->toPlainText();
+    QHash<QString, bool> *cache = &m_cache;
+    m_watcher.setFuture(QtConcurrent::run([text, cache](){
+        return misspelled(text, 0, -1, cache);
+    }));
+}
 
-    auto cursor = edit->textCursor();
+void JSCChecker::checked(){
+    if(!m_edit){
+        return;
+    }
 
-    cursor.beginEditBlock();
-    {
-        cursor.setPosition(start);
-        while(cursor.position() < end) {
-            bool correct = false;
-
-            cursor.movePosition(QTextCursor::EndOfWord, QTextCursor::KeepAnchor);
-            if(cursor.selectedText()/*.toUpper()*/ == "@"){
-                cursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
-                cursor.movePosition(QTextCursor::EndOfWord, QTextCursor::KeepAnchor);
-            }
+    // the text was edited while it was being checked, so check it again
+    if(m_pending || m_edit->document()->revision() != m_revision){
+        check();
+        return;
+    }
 
-            if(cursorHasProperty(cursor, CORRECT)){
-                correct = true;
-            } else {
-                QString word = cursor.selectedText().toUpper();
-
-                // three or less is always "correct"
-                if(word.length() < 4 || isNumeric(word)){
-                    correct = true;
-                } else {
-                    bool found = false;
-                    quint32 index = JSC::lookup(word, &found);
-                    if(found){
-                        correct = JSC::map[index].size == word.length();
-                    }
-
-                    if(!correct){
-                        correct = Varicode::isValidCallsign(word, nullptr);
-                    }
-                }
+    auto ranges = m_watcher.result();
+    underline(m_edit, 0, -1, ranges);
+}
 
-                //qDebug() << "word" << word << "correct" << correct;
-            }
+void JSCChecker::checkRange(QTextEdit* edit, int start, int end)
+{
+    auto ranges = misspelled(edit->document()->toPlainText(), start, end);
+    underline(edit, start, end, ranges);
+}
 
-            if(correct){
-                QTextCharFormat fmt = cursor.charFormat();
-                fmt.setFontUnderline(defaultFormat.fontUnderline());
-                fmt.setUnderlineColor(defaultFormat.underlineColor());
-                fmt.setUnderlineStyle(defaultFormat.underlineStyle());
-                cursor.setCharFormat(fmt);
-            } else {
-                cursor.mergeCharFormat(errorFmt);
-            }
+/**
+ * @brief JSCChecker::misspelled
+ * the ranges of the words in text from start to end that aren't in the
+ * dictionary and aren't callsigns. this only reads the text and the
+ * dictionary, so it can run on any thread. words already in the cache
+ * aren't looked up again.
+ */
+JSCChecker::Ranges JSCChecker::misspelled(QString const &text, int start, int end, QHash<QString, bool> *cache){
+    Ranges ranges;
+
+    int n = text.length();
+    if(end < 0 || end > n){
+        end = n;
+    }
 
-            // Go to next word start
-            //while(cursor.position() < end && !isWordChar(nextChar(cursor))){
-            //    cursor.movePosition(QTextCursor::NextCharacter);
-            //}
-            cursor.movePosition(QTextCursor::NextCharacter);
-        }
+    // back up to the start of a word
+    int i = qBound(0, start, n);
+    while(i > 0 && isWordChar(text.at(i - 1))){
+        i--;
     }
-    cursor.endEditBlock();
 
-    edit->document()->blockSignals(false);
-}
+    while(i < end){
+        auto ch = text.at(i);
+        bool group = (ch == '@' && i + 1 < n && isWordChar(text.at(i + 1)));
+        if(!isWordChar(ch) && !group){
+            i++;
+            continue;
+        }
 
-QSet<QString> oneEdit(QString word, bool includeAdditions, bool includeDeletions){
-    QSet<QString> all;
+        int from = i++;
+        while(i < n){
+            if(isWordChar(text.at(i))){
+                i++;
+                continue;
+            }
 
-    // 1-edit distance words (i.e., prefixed/suffixed/edited characters)
-    for(int i = 0; i < 26; i++){
-        if(includeAdditions){
-            auto prefixed = ALPHABET.mid(i, 1) + word;
-            all.insert(prefixed);
+            // apostrophes and periods inside a word (DON'T, 7.078) don't end it
+            if((text.at(i) == '\'' || text.at(i) == '.') && i + 1 < n && isWordChar(text.at(i + 1))){
+                i++;
+                continue;
+            }
 
-            auto suffixed = word + ALPHABET.mid(i, 1);
-            all.insert(suffixed);
+            break;
         }
 
-        for(int j = 0; j < word.length(); j++){
-            auto edited = word.mid(0, j) + ALPHABET.mid(i, 1) + word.mid(j + 1, word.length() - j);
-            all.insert(edited);
+        QString word = text.mid(from, i - from).toUpper();
+
+        bool correct = false;
+        if(cache && cache->contains(word)){
+            correct = cache->value(word);
+        } else {
+            correct = isCorrect(word);
+            if(cache) cache->insert(word, correct);
         }
-    }
 
-    // 1-edit distance words (i.e., removed characters)
-    if(includeDeletions){
-        for(int j = 0; j < word.length(); j++){
-            auto deleted = word.mid(0, j) + word.mid(j + 1, word.length() - j);
-            all.insert(deleted);
+        if(!correct){
+            ranges.append({ from, i - from });
         }
     }
 
-    return all;
+    return ranges;
 }
 
-QMap<quint32, QString> candidates(QString word, bool includeTwoEdits){
-    // one edit
-    QSet<QString> one = oneEdit(word, true, true);
-
-    // two edits
-    QSet<QString> two;
-    if(includeTwoEdits){
-        foreach(auto w, one){
-            two |= oneEdit(w, false, false);
-        }
+void JSCChecker::underline(QTextEdit *edit, int start, int end, Ranges const &ranges){
+    auto document = edit->document();
+    int last = document->characterCount() - 1;
+    if(end < 0 || end > last){
+        end = last;
     }
 
-    // existence check
-    QMap<quint32, QString> m;
+    // stop contentsChange signals from being emitted due to changed charFormats
+    document->blockSignals(true);
 
-    quint32 index;
-    foreach(auto w, one | two){
-        if(JSC::exists(w, &index)){
-            m[index] = w;
+    QTextCharFormat errorFmt;
+    errorFmt.setFontUnderline(true);
+    errorFmt.setUnderlineColor(Qt::red);
+    errorFmt.setUnderlineStyle(QTextCharFormat::WaveUnderline);
+
+    QTextCharFormat defaultFormat = QTextCharFormat();
+    QTextCharFormat correctFmt;
+    correctFmt.setFontUnderline(defaultFormat.fontUnderline());
+    correctFmt.setUnderlineColor(defaultFormat.underlineColor());
+    correctFmt.setUnderlineStyle(defaultFormat.underlineStyle());
+
+    auto cursor = edit->textCursor();
+
+    cursor.beginEditBlock();
+    {
+        cursor.setPosition(qBound(0, start, end));
+        cursor.setPosition(end, QTextCursor::KeepAnchor);
+        cursor.mergeCharFormat(correctFmt);
+
+        foreach(auto range, ranges){
+            cursor.setPosition(qMin(range.first, last));
+            cursor.setPosition(qMin(range.first + range.second, last), QTextCursor::KeepAnchor);
+            cursor.mergeCharFormat(errorFmt);
         }
     }
+    cursor.endEditBlock();
 
-    return m;
+    document->blockSignals(false);
 }
 
 QStringList JSCChecker::suggestions(QString word, int n, bool *pFound){
@@ -221,7 +334,7 @@ QStringList JSCChecker::suggestions(QString word, int n, bool *pFound){
     }
 
     // compute suggestion candidates
-    m.unite(candidates(word, false));
+    m.unite(candidates(word));
 
     // return in order of probability (i.e., index rank)
     int i = 0;
@@ -6,6 +6,12 @@
  **/
 
 #include <QObject>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QPointer>
+#include <QStringList>
 
 class QTextEdit;
 
@@ -13,9 +19,15 @@ class JSCChecker : public QObject
 {
     Q_OBJECT
 public:
+    typedef QList<QPair<int, int>> Ranges;     // (position, length) of misspelled words
+
     explicit JSCChecker(QObject *parent = nullptr);
+    ~JSCChecker();
+
+    void checkLater(QTextEdit * edit);
 
     static void checkRange(QTextEdit * edit, int start, int end);
+    static Ranges misspelled(QString const &text, int start, int end, QHash<QString, bool> *cache=nullptr);
     static QStringList suggestions(QString word, int n, bool *pFound);
 
 signals:
@@ -23,6 +35,15 @@ signals:
 public slots:
 
 private:
+    static void underline(QTextEdit * edit, int start, int end, Ranges const &ranges);
+    void check();
+    void checked();
+
+    QFutureWatcher<Ranges> m_watcher;
+    QPointer<QTextEdit> m_edit;
+    int m_revision;
+    bool m_pending;
+    QHash<QString, bool> m_cache;   // word -> correct, only touched by the running check
 };
 
 #endif // JSC_CHECKER_H
@@ -0,0 +1,127 @@
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+/**
+ * jsc_trie_gen - writes JSC::trie, the trie JSC::lookup walks, from the
+ * words of JSC::list
+ *
+ * The trie holds the words that JSC::lookup used to find by scanning
+ * the list: the words of each first character's bucket in JSC::prefix,
+ * and for a bucket of one word just its first character, which matched
+ * any word starting with it. Each node keeps the smallest list position
+ * of the words ending there. Nodes are written breadth first so that
+ * the children of a node are consecutive and sorted by their byte.
+ *
+ *   jsc_trie_gen jsc_trie.cpp
+ */
+
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "jsc.h"
+
+namespace {
+    struct Node {
+        std::map<quint8, int> children;
+        qint32 entry;
+    };
+
+    void insert(std::vector<Node> &nodes, char const *str, int size, qint32 entry){
+        int node = 0;
+        for(int i = 0; i < size; i++){
+            quint8 label = str[i];
+            auto it = nodes[node].children.find(label);
+            if(it == nodes[node].children.end()){
+                nodes.push_back({ {}, -1 });
+                it = nodes[node].children.insert({ label, (int)nodes.size() - 1 }).first;
+            }
+            node = it->second;
+        }
+
+        if(nodes[node].entry < 0 || entry < nodes[node].entry){
+            nodes[node].entry = entry;
+        }
+    }
+}
+
+int main(int argc, char *argv[]){
+    if(argc != 2){
+        fprintf(stderr, "usage: jsc_trie_gen jsc_trie.cpp\n");
+        return 1;
+    }
+
+    std::vector<Node> nodes;
+    nodes.push_back({ {}, -1 });
+
+    // only the first bucket of a character was ever scanned
+    bool seen[256] = {};
+    for(quint32 i = 0; i < JSC::prefixSize; i++){
+        auto const &p = JSC::prefix[i];
+        quint8 first = p.str[0];
+        if(seen[first]){
+            continue;
+        }
+        seen[first] = true;
+
+        if(p.size == 1){
+            insert(nodes, p.str, 1, p.index);
+            continue;
+        }
+
+        for(qint32 j = p.index; j < p.index + p.size; j++){
+            auto const &t = JSC::list[j];
+            if(t.size <= 0 || (quint8)t.str[0] != first){
+                continue;
+            }
+            insert(nodes, t.str, t.size, j);
+        }
+    }
+
+    // number the nodes breadth first, children in label order
+    std::vector<int> order;
+    std::vector<int> number(nodes.size(), 0);
+    std::vector<int> label(nodes.size(), 0);
+    order.push_back(0);
+    for(size_t i = 0; i < order.size(); i++){
+        for(auto const &child : nodes[order[i]].children){
+            number[child.second] = order.size();
+            label[child.second] = child.first;
+            order.push_back(child.second);
+        }
+    }
+
+    FILE *out = fopen(argv[1], "w");
+    if(!out){
+        perror(argv[1]);
+        return 1;
+    }
+
+    fprintf(out, "// generated by jsc_trie_gen from JSC::list, do not edit\n\n");
+    fprintf(out, "#include \"jsc.h\"\n\n");
+    fprintf(out, "const quint32 JSC::trieSize = %d;\n\n", (int)order.size());
+    fprintf(out, "const TrieNode JSC::trie[%d] = {\n", (int)order.size());
+    for(int n : order){
+        auto const &node = nodes[n];
+        int child = node.children.empty() ? 0 : number[node.children.begin()->second];
+        fprintf(out, "  {%d, %d, %d, %d},\n", child, node.entry, (int)node.children.size(), label[n]);
+    }
+    fprintf(out, "};\n");
+
+    return fclose(out) == 0 ? 0 : 1;
+}
@@ -3,11 +3,14 @@ subroutine multimode_decoder(ss,id2,params,nfsample)
   !$ use omp_lib
   use prog_args
   use timer_module, only: timer
-  use js8a_decode
-  use js8b_decode
-  use js8c_decode
-  use js8e_decode
-  use js8i_decode
+  use timer_impl, only: timer_note
+  use decoder_engine
+  use ring_window, only: window, new_window
+  use js8a_decode, only: js8a_decoder
+  use js8b_decode, only: js8b_decoder
+  use js8c_decode, only: js8c_decoder
+  use js8e_decode, only: js8e_decoder
+  use js8i_decode, only: js8i_decoder
 
   include 'jt9com.f90'
   include 'timer_common.inc'
@@ -32,11 +35,25 @@ subroutine multimode_decoder(ss,id2,params,nfsample)
      integer :: decoded
   end type counting_js8i_decoder
 
+  ! the output of a slot, buffered while the slots decode concurrently
+  type :: slot_output
+     integer :: n=0
+     character(len=80), allocatable :: lines(:)
+     type(decode_event), allocatable :: events(:)
+     logical, allocatable :: hasevent(:)
+  end type slot_output
+
+  integer, parameter :: NSLOTS=5           !One slot per JS8 submode
+  integer, parameter :: MAXLINES=200        !Initial buffered output lines per slot, grown as needed
   real ss(184,NSMAX)
-  logical baddata,newdat65,newdat9,single_decode,bVHF,bad0,newdat,trydecode
-  integer pos, sz
-  integer*2 id0(NTMAX*12000)
+  logical baddata,newdat65,newdat9,single_decode,bVHF,bad0,trydecode
+  logical enabled(NSLOTS)
   integer*2 id2(NTMAX*12000)
+  integer islot,nslot,nthreads
+  integer*8 count0,count1,clkrate,nclk(NSLOTS)
+  type(slot_output) :: output(NSLOTS)
+  type(decode_event) :: event
+  character(len=120) :: timing
   type(params_block) :: params
   character(len=20) :: datetime
   character(len=12) :: mycall, hiscall
@@ -48,6 +65,13 @@ subroutine multimode_decoder(ss,id2,params,nfsample)
   type(counting_js8e_decoder) :: my_js8e
   type(counting_js8i_decoder) :: my_js8i
 
+  ! Slots are decoded concurrently but their output is always written
+  ! in this fixed order: I, E, C, B, A
+  integer :: slot_submode(NSLOTS) = (/8, 4, 2, 1, 0/)
+  integer :: slot_bit(NSLOTS)     = (/16, 8, 4, 2, 1/)
+  character(len=1) :: slot_name(NSLOTS) = (/'I', 'E', 'C', 'B', 'A'/)
+  character(len=8) :: slot_timer(NSLOTS) = (/'decjs8i ', 'decjs8e ', 'decjs8c ', 'decjs8b ', 'decjs8a '/)
+
   !cast C character arrays to Fortran character strings
   datetime=transfer(params%datetime, datetime)
   mycall=transfer(params%mycall,mycall)
@@ -75,204 +99,71 @@ subroutine multimode_decoder(ss,id2,params,nfsample)
     nfox=0
   endif
 
-  write(*,1012) params%nsubmode, params%nsubmodes
+  if(sink_active()) then
+     event=new_event(DECODE_STARTED,params%nsubmode)
+     event%count=params%nsubmodes
+     call sink_event(event)
+  else
+     write(*,1012) params%nsubmode, params%nsubmodes
 1012 format('<DecodeStarted>',2i4)
-
-  if(params%nmode.eq.8 .and. (params%nsubmode.eq.8 .or. iand(params%nsubmodes, 16).eq.16)) then
-! We're in JS8 mode I
-     call timer('decjs8i ',0)
-     newdat=params%newdat
-     write(*,*) '<DecodeDebug> mode I decode started'
-
-     ! copy the relevant frames for decoding
-     pos = max(0,params%kposI)
-     sz = max(0,params%kszI)
-     id0=0
-     imax=int(NTMAX*12000)
-
-     if(params%syncStats) then
-        write(*,*) '<DecodeSyncMeta> sync start', pos, sz
-     endif
-
-     if((imax-pos).lt.sz) then
-       ! this means that the first part of the id0 is at the end of the buffer
-       ! and the second half is at the beginning of the buffer
-       firstsize=int(imax-pos)-1
-       secondsize=int(sz-firstsize)+1
-       id0(1:firstsize+1)=id2(pos+1:pos+firstsize+1)
-       id0(firstsize+1:firstsize+secondsize+1)=id2(1:secondsize+1)
-     else
-       id0(1:sz+1)=id2(pos+1:pos+sz+1)
-     endif
-     
-     call my_js8i%decode(js8i_decoded,id0,params%nQSOProgress,params%nfqso,  &
-          params%nftx,newdat,params%nutc,params%nfa,params%nfb,              &
-          params%nexp_decode,params%ndepth,logical(params%nagain),           &
-          logical(params%lft8apon),logical(params%lapcqonly),params%napwid,  &
-          mycall,mygrid,hiscall,hisgrid,logical(params%syncStats))
-
-     write(*,*) '<DecodeDebug> mode I decode finished'
-     
-     call timer('decjs8i ',1)
   endif
 
-  if(params%nmode.eq.8 .and. (params%nsubmode.eq.4 .or. iand(params%nsubmodes, 8).eq.8)) then
-! We're in JS8 mode E
-     call timer('decjs8e ',0)
-     newdat=params%newdat
-     write(*,*) '<DecodeDebug> mode E decode started'
-
-     ! copy the relevant frames for decoding
-     pos = max(0,params%kposE)
-     sz = max(0,params%kszE)
-     id0=0
-     imax=int(NTMAX*12000)
-
-     if(params%syncStats) then
-        write(*,*) '<DecodeSyncMeta> sync start', pos, sz
-     endif
-
-     if((imax-pos).lt.sz) then
-       ! this means that the first part of the id0 is at the end of the buffer
-       ! and the second half is at the beginning of the buffer
-       firstsize=int(imax-pos)-1
-       secondsize=int(sz-firstsize)+1
-       id0(1:firstsize+1)=id2(pos+1:pos+firstsize+1)
-       id0(firstsize+1:firstsize+secondsize+1)=id2(1:secondsize+1)
-     else
-       id0(1:sz+1)=id2(pos+1:pos+sz+1)
-     endif
-     
-     call my_js8e%decode(js8e_decoded,id0,params%nQSOProgress,params%nfqso,  &
-          params%nftx,newdat,params%nutc,params%nfa,params%nfb,              &
-          params%nexp_decode,params%ndepth,logical(params%nagain),           &
-          logical(params%lft8apon),logical(params%lapcqonly),params%napwid,  &
-          mycall,mygrid,hiscall,hisgrid,logical(params%syncStats))
-
-     write(*,*) '<DecodeDebug> mode E decode finished'
-     
-     call timer('decjs8e ',1)
-  endif
+  ! figure out which submodes are to be decoded this cycle
+  nslot=0
+  do islot=1,NSLOTS
+     enabled(islot)=params%nmode.eq.8 .and.                                  &
+          (params%nsubmode.eq.slot_submode(islot) .or.                       &
+           iand(params%nsubmodes, slot_bit(islot)).eq.slot_bit(islot))
+     if(enabled(islot)) nslot=nslot+1
+  enddo
+  do islot=1,NSLOTS
+     output(islot)%n=0
+  enddo
+  nclk=0
+
+  ! one worker per enabled submode, optionally capped by the -j option
+  nthreads=max(1,nslot)
+  if(ndecthreads.gt.0) nthreads=min(nthreads,ndecthreads)
+
+  call system_clock(count0,clkrate)
+  !$omp parallel do num_threads(nthreads) if(nthreads.gt.1) schedule(dynamic,1) &
+  !$omp    default(shared) private(islot) copyin(/timer_private/)
+  do islot=1,NSLOTS
+     if(enabled(islot)) call decode_slot(islot)
+  enddo
+  !$omp end parallel do
+  call system_clock(count1)
+
+  ! flush the buffered output of each submode in a deterministic order,
+  ! an in process host only gets the typed events
+  do islot=1,NSLOTS
+     do i=1,output(islot)%n
+        if(.not.sink_active()) then
+           write(*,'(a)') trim(output(islot)%lines(i))
+        else if(output(islot)%hasevent(i)) then
+           call sink_event(output(islot)%events(i))
+        endif
+     enddo
+  enddo
 
-  if(params%nmode.eq.8 .and. (params%nsubmode.eq.2 .or. iand(params%nsubmodes, 4).eq.4)) then
-! We're in JS8 mode C
-     call timer('decjs8c ',0)
-     newdat=params%newdat
-     write(*,*) '<DecodeDebug> mode C decode started'
-
-     ! copy the relevant frames for decoding
-     pos = max(0,params%kposC)
-     sz = max(0,params%kszC)
-     id0=0
-     imax=int(NTMAX*12000)
-
-     if(params%syncStats) then
-        write(*,*) '<DecodeSyncMeta> sync start', pos, sz
-     endif
-
-     if((imax-pos).lt.sz) then
-       ! this means that the first part of the id0 is at the end of the buffer
-       ! and the second half is at the beginning of the buffer
-       firstsize=int(imax-pos)-1
-       secondsize=int(sz-firstsize)+1
-       id0(1:firstsize+1)=id2(pos+1:pos+firstsize+1)
-       id0(firstsize+1:firstsize+secondsize+1)=id2(1:secondsize+1)
-     else
-       id0(1:sz+1)=id2(pos+1:pos+sz+1)
-     endif
-     
-     call my_js8c%decode(js8c_decoded,id0,params%nQSOProgress,params%nfqso,  &
-          params%nftx,newdat,params%nutc,params%nfa,params%nfb,              &
-          params%nexp_decode,params%ndepth,logical(params%nagain),           &
-          logical(params%lft8apon),logical(params%lapcqonly),params%napwid,  &
-          mycall,mygrid,hiscall,hisgrid,logical(params%syncStats))
-
-     write(*,*) '<DecodeDebug> mode C decode finished'
-     
-     call timer('decjs8c ',1)
-  endif
-
-  if(params%nmode.eq.8 .and. (params%nsubmode.eq.1 .or. iand(params%nsubmodes, 2).eq.2)) then
-! We're in JS8 mode B
-     call timer('decjs8b ',0)
-     newdat=params%newdat
-     write(*,*) '<DecodeDebug> mode B decode started'
-
-     ! copy the relevant frames for decoding
-     pos = max(0,params%kposB)
-     sz = max(0,params%kszB)
-     id0=0
-     imax=int(NTMAX*12000)
-
-     if(params%syncStats) then
-        write(*,*) '<DecodeSyncMeta> sync start', pos, sz
-     endif
-
-     if((imax-pos).lt.sz) then
-       ! this means that the first part of the id0 is at the end of the buffer
-       ! and the second half is at the beginning of the buffer
-       firstsize=int(imax-pos)-1
-       secondsize=int(sz-firstsize)+1
-       id0(1:firstsize+1)=id2(pos+1:pos+firstsize+1)
-       id0(firstsize+1:firstsize+secondsize+1)=id2(1:secondsize+1)
-     else
-       id0(1:sz+1)=id2(pos+1:pos+sz+1)
-     endif
-     
-     call my_js8b%decode(js8b_decoded,id0,params%nQSOProgress,params%nfqso,  &
-          params%nftx,newdat,params%nutc,params%nfa,params%nfb,              &
-          params%nexp_decode,params%ndepth,logical(params%nagain),           &
-          logical(params%lft8apon),logical(params%lapcqonly),params%napwid,  &
-          mycall,mygrid,hiscall,hisgrid,logical(params%syncStats))
-
-     write(*,*) '<DecodeDebug> mode B decode finished'
-     
-     call timer('decjs8b ',1)
-  endif
-
-  if(params%nmode.eq.8 .and. (params%nsubmode.eq.0 .or. iand(params%nsubmodes, 1).eq.1)) then
-! We're in JS8 mode A
-     call timer('decjs8a ',0)
-     newdat=params%newdat
-     write(*,*) '<DecodeDebug> mode A decode started'
-
-     ! copy the relevant frames for decoding
-     pos = int(max(0,params%kposA))
-     sz = int(max(0,params%kszA))
-     id0=0
-     imax=int(NTMAX*12000)
-
-     if(params%syncStats) then
-        write(*,*) '<DecodeSyncMeta> sync start', pos, sz
-     endif
-
-     if((imax-pos).lt.sz) then
-       ! this means that the first part of the id0 is at the end of the buffer
-       ! and the second half is at the beginning of the buffer
-       firstsize=int(imax-pos)-1
-       secondsize=int(sz-firstsize)+1
-       id0(1:firstsize+1)=id2(pos+1:pos+firstsize+1)
-       id0(firstsize+1:firstsize+secondsize+1)=id2(1:secondsize+1)
-     else
-       id0(1:sz+1)=id2(pos+1:pos+sz+1)
-     endif
-     
-     call my_js8a%decode(js8a_decoded,id0,params%nQSOProgress,params%nfqso,  &
-          params%nftx,newdat,params%nutc,params%nfa,params%nfb,              &
-          params%nexp_decode,params%ndepth,logical(params%nagain),           &
-          logical(params%lft8apon),logical(params%lapcqonly),params%napwid,  &
-          mycall,mygrid,hiscall,hisgrid,logical(params%syncStats))
-
-     write(*,*) '<DecodeDebug> mode A decode finished'
-
-     call timer('decjs8a ',1)
+  ndecoded = my_js8a%decoded + my_js8b%decoded + my_js8c%decoded + my_js8e%decoded + my_js8i%decoded
+  !call sleep_msec(3000)
+  if(sink_active()) then
+     event=new_event(DECODE_FINISHED,params%nsubmode)
+     event%count=ndecoded
+     call sink_event(event)
+     return
   endif
 
   write(*,*) '<DecodeDebug> finished'
   call flush(6)
 
-  ndecoded = my_js8a%decoded + my_js8b%decoded + my_js8c%decoded + my_js8e%decoded + my_js8i%decoded
-  !call sleep_msec(3000)
+  ! per cycle wall clock times, sum of slots vs. elapsed shows the speedup
+  write(timing,1020) nthreads,real(count1-count0)/clkrate,                   &
+       (slot_name(islot),real(nclk(islot))/clkrate,islot=1,NSLOTS)
+1020 format('decode threads',i2,' wall',f7.3,5(1x,a1,f7.3))
+  call timer_note(timing)
+
   write(*,1010) ndecoded
 1010 format('<DecodeFinished>',i4)
   call flush(6)
@@ -280,6 +171,180 @@ subroutine multimode_decoder(ss,id2,params,nfsample)
 
 contains
 
+  subroutine decode_slot (islot)
+    implicit none
+
+    integer, intent(in) :: islot
+    integer pos,sz
+    integer*8 c0,c1
+    real tsync,tdecode
+    integer nfft,nfftreused
+    logical newdat
+    character(len=80) :: line
+    type(window) :: win
+    type(decode_event) :: event
+
+    call system_clock(c0)
+    call timer(slot_timer(islot),0)
+    newdat=params%newdat
+    tsync=0.
+    tdecode=0.
+    nfft=0
+    nfftreused=0
+    write(line,*) '<DecodeDebug> mode ',slot_name(islot),' decode started'
+    call emit(islot,line)
+
+    ! the frames to decode, read in place from the ring buffer
+    select case (slot_submode(islot))
+    case (0)
+       pos=params%kposA
+       sz=params%kszA
+    case (1)
+       pos=params%kposB
+       sz=params%kszB
+    case (2)
+       pos=params%kposC
+       sz=params%kszC
+    case (4)
+       pos=params%kposE
+       sz=params%kszE
+    case default
+       pos=params%kposI
+       sz=params%kszI
+    end select
+    pos=max(0,pos)
+    sz=max(0,sz)
+    win=new_window(pos,sz,NTMAX*12000)
+
+    if(params%syncStats) then
+       write(line,*) '<DecodeSyncMeta> sync start', pos, sz
+       event=new_event(DECODE_SYNC_META,slot_submode(islot))
+       event%start=pos
+       event%size=sz
+       call emit(islot,line,event)
+    endif
+
+    select case (slot_submode(islot))
+    case (0)
+       call my_js8a%decode(js8a_decoded,id2,win,params%nQSOProgress,params%nfqso,  &
+            params%nftx,newdat,params%nutc,params%nfa,params%nfb,              &
+            params%nexp_decode,params%ndepth,logical(params%nagain),           &
+            logical(params%lft8apon),logical(params%lapcqonly),params%napwid,  &
+            mycall,mygrid,hiscall,hisgrid,logical(params%syncStats))
+       tsync=my_js8a%tsync
+       tdecode=my_js8a%tdecode
+       nfft=my_js8a%nfft
+       nfftreused=my_js8a%nfftreused
+    case (1)
+       call my_js8b%decode(js8b_decoded,id2,win,params%nQSOProgress,params%nfqso,  &
+            params%nftx,newdat,params%nutc,params%nfa,params%nfb,              &
+            params%nexp_decode,params%ndepth,logical(params%nagain),           &
+            logical(params%lft8apon),logical(params%lapcqonly),params%napwid,  &
+            mycall,mygrid,hiscall,hisgrid,logical(params%syncStats))
+       tsync=my_js8b%tsync
+       tdecode=my_js8b%tdecode
+       nfft=my_js8b%nfft
+       nfftreused=my_js8b%nfftreused
+    case (2)
+       call my_js8c%decode(js8c_decoded,id2,win,params%nQSOProgress,params%nfqso,  &
+            params%nftx,newdat,params%nutc,params%nfa,params%nfb,              &
+            params%nexp_decode,params%ndepth,logical(params%nagain),           &
+            logical(params%lft8apon),logical(params%lapcqonly),params%napwid,  &
+            mycall,mygrid,hiscall,hisgrid,logical(params%syncStats))
+       tsync=my_js8c%tsync
+       tdecode=my_js8c%tdecode
+       nfft=my_js8c%nfft
+       nfftreused=my_js8c%nfftreused
+    case (4)
+       call my_js8e%decode(js8e_decoded,id2,win,params%nQSOProgress,params%nfqso,  &
+            params%nftx,newdat,params%nutc,params%nfa,params%nfb,              &
+            params%nexp_decode,params%ndepth,logical(params%nagain),           &
+            logical(params%lft8apon),logical(params%lapcqonly),params%napwid,  &
+            mycall,mygrid,hiscall,hisgrid,logical(params%syncStats))
+       tsync=my_js8e%tsync
+       tdecode=my_js8e%tdecode
+       nfft=my_js8e%nfft
+       nfftreused=my_js8e%nfftreused
+    case (8)
+       call my_js8i%decode(js8i_decoded,id2,win,params%nQSOProgress,params%nfqso,  &
+            params%nftx,newdat,params%nutc,params%nfa,params%nfb,              &
+            params%nexp_decode,params%ndepth,logical(params%nagain),           &
+            logical(params%lft8apon),logical(params%lapcqonly),params%napwid,  &
+            mycall,mygrid,hiscall,hisgrid,logical(params%syncStats))
+       tsync=my_js8i%tsync
+       tdecode=my_js8i%tdecode
+       nfft=my_js8i%nfft
+       nfftreused=my_js8i%nfftreused
+    end select
+
+    write(line,*) '<DecodeDebug> mode ',slot_name(islot),' decode finished'
+    call emit(islot,line)
+
+    call timer(slot_timer(islot),1)
+    call system_clock(c1)
+    nclk(islot)=c1-c0
+
+    ! where the time went, for the GUI's decode pipeline trace
+    write(line,1030) slot_submode(islot),real(nclk(islot))/clkrate,tsync,tdecode,  &
+         nfft,nfftreused
+1030 format('<DecodeTiming>',i3,3f9.4,2i6)
+    event=new_event(DECODE_TIMING,slot_submode(islot))
+    event%tslot=real(nclk(islot))/clkrate
+    event%tsync=tsync
+    event%tdecode=tdecode
+    event%nfft=nfft
+    event%nfftreused=nfftreused
+    call emit(islot,line,event)
+    return
+  end subroutine decode_slot
+
+  subroutine emit (islot, line, event)
+    ! buffer a line of output, and the typed event an in process host
+    ! receives instead, for the given slot. Each slot is only ever
+    ! written by the one thread decoding it
+    implicit none
+    integer, intent(in) :: islot
+    character(len=*), intent(in) :: line
+    type(decode_event), intent(in), optional :: event
+
+    integer n
+
+    if(.not.allocated(output(islot)%lines)) then
+       call grow(output(islot),MAXLINES)
+    else if(output(islot)%n.ge.size(output(islot)%lines)) then
+       call grow(output(islot),2*size(output(islot)%lines))
+    endif
+
+    n=output(islot)%n+1
+    output(islot)%n=n
+    output(islot)%lines(n)=line
+    output(islot)%hasevent(n)=present(event)
+    if(present(event)) output(islot)%events(n)=event
+    return
+  end subroutine emit
+
+  subroutine grow (out, n)
+    ! make room for n lines in the output of a slot, keeping those it has
+    implicit none
+    type(slot_output), intent(inout) :: out
+    integer, intent(in) :: n
+    character(len=80), allocatable :: lines(:)
+    type(decode_event), allocatable :: events(:)
+    logical, allocatable :: hasevent(:)
+
+    allocate(lines(n),events(n),hasevent(n))
+    if(out%n.gt.0) then
+       lines(1:out%n)=out%lines(1:out%n)
+       events(1:out%n)=out%events(1:out%n)
+       hasevent(1:out%n)=out%hasevent(1:out%n)
+    endif
+    call move_alloc(lines,out%lines)
+    call move_alloc(events,out%events)
+    call move_alloc(hasevent,out%hasevent)
+    return
+  end subroutine grow
+
+
   subroutine js8_decoded (sync,snr,dt,freq,decoded,nap,qual,submode)
     implicit none
 
@@ -296,6 +361,8 @@ contains
     character*3 m
     character*2 annot
     character*37 decoded0
+    character*80 line
+    type(decode_event) :: event
     logical isgrid4,first,b0,b1,b2
     data first/.true./
     save
@@ -306,6 +373,9 @@ contains
          ichar(w(3:3)).ge.ichar('0') .and. ichar(w(3:3)).le.ichar('9') .and.  &
          ichar(w(4:4)).ge.ichar('0') .and. ichar(w(4:4)).le.ichar('9'))
 
+    ! submodes report decodes concurrently, so serialize the shared
+    ! (saved) state in here
+    !$omp critical(js8_decoded)
     if(first) then
        n30z=0
        nwrap=0
@@ -331,10 +401,23 @@ contains
 
 
     i0=index(decoded0,';')
-    if(i0.le.0) write(*,1000) params%nutc,snr,dt,nint(freq),m,decoded0(1:22),annot
+    if(i0.le.0) write(line,1000) params%nutc,snr,dt,nint(freq),m,decoded0(1:22),annot
 1000 format(i6.6,i4,f5.1,i5,a3,1x,a22,1x,a2)
-    if(i0.gt.0) write(*,1001) params%nutc,snr,dt,nint(freq),m,decoded0
+    if(i0.gt.0) write(line,1001) params%nutc,snr,dt,nint(freq),m,decoded0
 1001 format(i6.6,i4,f5.1,i5,a3,1x,a37)
+    event=new_event(DECODE_DECODED,submode)
+    event%utc=params%nutc
+    event%snr=snr
+    event%dt=dt
+    event%freq=freq
+    event%sync=sync
+    event%qual=qual
+    event%nap=nap
+    if(i0.le.0) call set_event_text(event,decoded0(1:22))
+    if(i0.gt.0) call set_event_text(event,decoded0)
+    do n=1,NSLOTS
+       if(slot_submode(n).eq.submode) call emit(n,line,event)
+    enddo
 
     i1=index(decoded0,' ')
     i2=i1 + index(decoded0(i1+1:),' ')
@@ -361,8 +444,7 @@ contains
           nfox=nfox+1
        endif
     endif
-    
-    call flush(6)
+    !$omp end critical(js8_decoded)
 
     return
   end subroutine js8_decoded
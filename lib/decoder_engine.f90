@@ -0,0 +1,218 @@
+module decoder_engine
+  !
+  ! In process decoder interface
+  !
+  ! A C/C++ host can run decode cycles directly against its own dec_data
+  ! structure with C_decode_cycle and have the results delivered as typed
+  ! records through a callback registered with C_init_decoder, instead of
+  ! running the js8 subprocess and parsing what it writes to stdout.
+  !
+  ! While no callback is registered the decoder writes its usual text
+  ! protocol to stdout. The js8 subprocess can instead register a callback
+  ! that writes the records to stdout as binary frames (see ../commons.h).
+  !
+  use, intrinsic :: iso_c_binding, only: c_int, c_short, c_float, c_char, c_ptr, &
+       c_funptr, c_null_ptr, c_null_char, c_associated, c_f_procpointer
+  implicit none
+
+  public :: decode_event, new_event, set_event_text, set_event_sink, sink_active, sink_event, sink_sync_stat
+  public :: C_init_decoder, C_plan_decoder, C_decode_cycle
+
+  !
+  ! event kinds, these must be kept in sync with ../commons.h
+  !
+  integer, parameter, public :: DECODE_STARTED=0
+  integer, parameter, public :: DECODE_SYNC_META=1
+  integer, parameter, public :: DECODE_SYNC_CANDIDATE=2
+  integer, parameter, public :: DECODE_SYNC_DECODE=3
+  integer, parameter, public :: DECODE_DECODED=4
+  integer, parameter, public :: DECODE_FINISHED=5
+  integer, parameter, public :: DECODE_TIMING=6
+  integer, parameter, public :: DECODE_PLANNED=7
+
+  !
+  ! this structure must be kept in sync with ../commons.h
+  !
+  type, bind(C) :: decode_event
+     integer(c_int) :: kind
+     integer(c_int) :: submode        ! JS8 submode, -1 if not applicable
+     integer(c_int) :: utc            ! hhmmss
+     integer(c_int) :: snr
+     real(c_float) :: dt
+     real(c_float) :: freq
+     real(c_float) :: sync
+     real(c_float) :: qual            ! [0.0,1.0]
+     integer(c_int) :: nap            ! a priori type, 0 if none
+     integer(c_int) :: start          ! sync meta: first frame of the window
+     integer(c_int) :: size           ! sync meta: number of frames
+     integer(c_int) :: count          ! started: nsubmodes, finished: decodes
+     real(c_float) :: tslot           ! timing: seconds in the submode's decode
+     real(c_float) :: tsync           ! timing: of which in syncjs8
+     real(c_float) :: tdecode         ! timing: of which in js8dec
+     integer(c_int) :: nfft           ! timing: long downsample FFTs computed
+     integer(c_int) :: nfftreused     ! timing: and reused
+     character(kind=c_char) :: text(40) ! decoded message, NUL terminated
+  end type decode_event
+
+  private
+
+  abstract interface
+     subroutine C_decode_callback (context, event) bind(C)
+       use, intrinsic :: iso_c_binding, only: c_ptr
+       import decode_event
+       implicit none
+       type(c_ptr), value :: context
+       type(decode_event), intent(in) :: event
+     end subroutine C_decode_callback
+  end interface
+
+  type(c_ptr) :: the_context = c_null_ptr
+  procedure(C_decode_callback), pointer :: the_C_callback => null()
+
+contains
+
+  subroutine C_init_decoder (context, callback, patience) bind(C)
+    ! register (or with a null callback, unregister) the event sink and
+    ! set the FFTW planning patience that js8 takes from its -w option
+    implicit none
+    type(c_ptr), value :: context
+    type(c_funptr), value :: callback
+    integer(c_int), value :: patience
+    integer npatience,nthreads
+    common/patience/npatience,nthreads
+
+    call set_event_sink(context,callback)
+    npatience=patience
+    nthreads=1
+  end subroutine C_init_decoder
+
+  subroutine C_plan_decoder (wisfile) bind(C)
+    ! plan every FFT the decoder uses ahead of the first decode cycle and
+    ! save the FFTW wisdom to wisfile (NUL terminated, empty to not save
+    ! it), the time taken is reported as a DECODE_PLANNED event
+    implicit none
+    character(kind=c_char), intent(in) :: wisfile(*)
+    character(len=512) :: fname
+    type(decode_event) :: event
+    real tplan
+    integer i
+
+    fname=''
+    do i=1,len(fname)-1
+       if(wisfile(i).eq.c_null_char) exit
+       fname(i:i)=wisfile(i)
+    enddo
+    if(len_trim(fname).gt.0) fname=trim(fname)//c_null_char
+
+    call decoder_plans(fname,tplan)
+
+    if(sink_active()) then
+       event=new_event(DECODE_PLANNED,-1)
+       event%tslot=tplan
+       call sink_event(event)
+    endif
+  end subroutine C_plan_decoder
+
+  subroutine C_decode_cycle (ss, id2, params, ndecoders) bind(C)
+    ! run one decode cycle, the equivalent of a single pass through the
+    ! jt9a loop. Only the windows described by params are read from id2.
+    use prog_args, only: ndecthreads
+    use timer_module, only: timer
+    include 'jt9com.f90'
+    real(c_float), intent(in) :: ss(184,NSMAX)
+    integer(c_short), intent(in) :: id2(NTMAX*12000)
+    type(params_block), intent(in) :: params
+    integer(c_int), value :: ndecoders
+    type(params_block) :: local_params
+
+    ndecthreads=ndecoders
+    local_params=params
+    call timer('decoder ',0)
+    call multimode_decoder(ss,id2,local_params,12000)
+    call timer('decoder ',1)
+  end subroutine C_decode_cycle
+
+  subroutine set_event_sink (context, callback)
+    ! register (or with a null callback, unregister) the event sink
+    implicit none
+    type(c_ptr), value :: context
+    type(c_funptr), value :: callback
+
+    the_context=context
+    if(c_associated(callback)) then
+       call c_f_procpointer (callback, the_C_callback)
+    else
+       nullify (the_C_callback)
+    endif
+  end subroutine set_event_sink
+
+  logical function sink_active ()
+    implicit none
+    sink_active=associated(the_C_callback)
+  end function sink_active
+
+  function new_event (kind, submode) result(event)
+    implicit none
+    integer, intent(in) :: kind, submode
+    type(decode_event) :: event
+
+    event%kind=kind
+    event%submode=submode
+    event%utc=0
+    event%snr=0
+    event%dt=0.
+    event%freq=0.
+    event%sync=0.
+    event%qual=0.
+    event%nap=0
+    event%start=0
+    event%size=0
+    event%count=0
+    event%tslot=0.
+    event%tsync=0.
+    event%tdecode=0.
+    event%nfft=0
+    event%nfftreused=0
+    event%text=c_null_char
+  end function new_event
+
+  subroutine set_event_text (event, text)
+    implicit none
+    type(decode_event), intent(inout) :: event
+    character(len=*), intent(in) :: text
+    integer i,n
+
+    event%text=c_null_char
+    n=min(len_trim(text),size(event%text)-1)
+    do i=1,n
+       event%text(i)=text(i:i)
+    enddo
+  end subroutine set_event_text
+
+  subroutine sink_event (event, text)
+    ! deliver an event, the callback is never entered concurrently
+    implicit none
+    type(decode_event), intent(inout) :: event
+    character(len=*), intent(in), optional :: text
+
+    if(.not.associated(the_C_callback)) return
+    if(present(text)) call set_event_text(event,text)
+    !$omp critical(decode_sink)
+    call the_C_callback(the_context,event)
+    !$omp end critical(decode_sink)
+  end subroutine sink_event
+
+  subroutine sink_sync_stat (kind, submode, freq, sync, dt)
+    implicit none
+    integer, intent(in) :: kind, submode
+    real, intent(in) :: freq, sync, dt
+    type(decode_event) :: event
+
+    event=new_event(kind,submode)
+    event%freq=freq
+    event%sync=sync
+    event%dt=dt
+    call sink_event(event)
+  end subroutine sink_sync_stat
+
+end module decoder_engine
@@ -0,0 +1,40 @@
+subroutine decoder_plans(wisfile,tplan)
+
+! Plan the FFTs of every JS8 submode decoder ahead of the first decode,
+! then save the FFTW wisdom so that the next start has less to plan.
+
+! Input:
+!  wisfile   NUL terminated wisdom file name, blank to not save wisdom
+! Output:
+!  tplan     seconds spent planning
+
+  use, intrinsic :: iso_c_binding, only: c_int
+  use FFTW3
+  use js8a_module, only: js8a_plans => js8_plans
+  use js8b_module, only: js8b_plans => js8_plans
+  use js8c_module, only: js8c_plans => js8_plans
+  use js8e_module, only: js8e_plans => js8_plans
+  use js8i_module, only: js8i_plans => js8_plans
+
+  character(len=*), intent(in) :: wisfile
+  real, intent(out) :: tplan
+  integer(c_int) iret
+  integer*8 count0,count1,clkrate
+
+  call system_clock(count0,clkrate)
+  call js8a_plans()
+  call js8b_plans()
+  call js8c_plans()
+  call js8e_plans()
+  call js8i_plans()
+  call system_clock(count1)
+  tplan=float(count1-count0)/float(clkrate)
+
+  if(len_trim(wisfile).gt.0) then
+     !$omp critical(fftw) ! serialize non thread-safe FFTW3 calls
+     iret=fftwf_export_wisdom_to_filename(wisfile)
+     !$omp end critical(fftw)
+  endif
+
+  return
+end subroutine decoder_plans
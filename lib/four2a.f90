@@ -19,12 +19,18 @@ subroutine four2a(a,nfft,ndim,isign,iform)
 ! This version of four2a makes calls to the FFTW library to do the 
 ! actual computations.
 
+! Plans are kept by size, direction, form and the SIMD alignment of a(),
+! and are executed on whatever array is passed in, so a plan made once
+! (e.g. by four2a_plan at decoder startup) serves every later caller of
+! that size rather than each new array address planning again. With
+! NDIM < 0 the plan is made but the transform is not computed.
+
   parameter (NPMAX=2100)                 !Max numberf of stored plans
   parameter (NSMALL=16384)               !Max size of "small" FFTs
   complex a(nfft)                        !Array to be transformed
   complex aa(NSMALL)                     !Local copy of "small" a()
   integer nn(NPMAX),ns(NPMAX),nf(NPMAX)  !Params of stored plans 
-  integer*8 nl(NPMAX),nloc               !More params of plans
+  integer*8 nl(NPMAX),nloc               !Alignment of a() when planned
   integer*8 plan(NPMAX)                  !Pointers to stored plans
   logical found_plan
   data nplan/0/                          !Number of stored plans
@@ -35,6 +41,8 @@ subroutine four2a(a,nfft,ndim,isign,iform)
   if(nfft.lt.0) go to 999
 
   nloc=loc(a)
+  nloc=mod(nloc,64_8)                    !Plans may only run on arrays
+                                         !aligned the way they were made
 
   found_plan = .false.
   !$omp critical(four2a_setup)
@@ -93,7 +101,15 @@ subroutine four2a(a,nfft,ndim,isign,iform)
   end if
   !$omp end critical(four2a_setup)
 
-  call sfftw_execute(plan(i))
+  if(ndim.lt.0) return                   !Plan only
+
+  if(iform.eq.1) then
+     call sfftw_execute_dft(plan(i),a,a)
+  else if(iform.eq.0) then
+     call sfftw_execute_dft_r2c(plan(i),a,a)
+  else
+     call sfftw_execute_dft_c2r(plan(i),a,a)
+  endif
   return
 
 999 continue
@@ -113,3 +129,21 @@ subroutine four2a(a,nfft,ndim,isign,iform)
 
   return
 end subroutine four2a
+
+subroutine four2a_plan(nfft,isign,iform)
+
+! Make the four2a plans for one transform ahead of its first use, at each
+! SIMD alignment an array may have, so that no decode has to wait on the
+! FFTW planner.
+
+  complex, allocatable :: a(:)
+
+  allocate(a(nfft+8))
+  a=0.
+  do k=1,8,2                             !Offsets of 0, 16, 32 and 48 bytes
+     call four2a(a(k),nfft,-1,isign,iform)
+  enddo
+  deallocate(a)
+
+  return
+end subroutine four2a_plan
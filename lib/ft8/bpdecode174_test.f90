@@ -0,0 +1,88 @@
+program bpdecode174_test
+! Checks bpdecode174_batch against bpdecode174 on the same llrs: noisy
+! BPSK codewords of random messages, from well above the decoding
+! threshold to below it. The batched decoder's vectorized tanh is a few
+! ulp off libm's, so a codeword right at the edge of convergence may
+! come out differently. A word counts as a disagreement if one decoder
+! decodes it and the other does not, or if they decode different words,
+! and no more than TOLFRAC of them may disagree.
+
+! Usage: bpdecode174_test [#trials per Es/N0]
+
+include 'ldpc_174_87_params.f90'
+
+parameter (TOLFRAC=1.e-3)             !Measured: 8 in 160000 words, 5e-5
+parameter (NB=4)                      !Words per batched call, as js8dec
+
+integer*1 message(K),codeword(N),decoded(K),cw(N)
+integer*1 decodedb(K,NB),cwb(N,NB)
+integer nhb(NB),niterb(NB)
+integer nseed(64)
+real rxdata(N)
+real, allocatable :: llrs(:,:)
+character*8 arg
+
+ntrials=2000
+if(iargc().ge.1) then
+   call getarg(1,arg)
+   read(arg,*) ntrials
+endif
+allocate(llrs(N,ntrials))
+
+call random_seed(size=nsize)
+nseed=2463
+call random_seed(put=nseed(1:nsize))
+
+max_iterations=30
+nwords=0
+ndiffer=0
+write(*,*) "Es/N0   scalar  batched  disagree"
+do idb=8,-6,-2
+   db=idb/2.0
+   sigma=1/sqrt(2*(10**(db/10.0)))
+   nsgood=0
+   nbgood=0
+   nd=0
+   do itrial=1,ntrials
+      do i=1,K
+         call random_number(r)
+         message(i)=0
+         if(r.ge.0.5) message(i)=1
+      enddo
+      call encode174(message,codeword)
+      do i=1,N
+         rxdata(i)=2.0*codeword(i)-1.0 + sigma*gran()
+      enddo
+      ! normalized as ldpcsim174js8 does
+      rxav=sum(rxdata)/N
+      rx2av=sum(rxdata*rxdata)/N
+      rxdata=rxdata/sqrt(rx2av-rxav*rxav)
+      llrs(:,itrial)=2.0*rxdata/(sigma*sigma)
+   enddo
+
+   do i=1,ntrials,NB
+      nbatch=min(NB,ntrials-i+1)
+      call bpdecode174_batch(llrs(:,i),nbatch,max_iterations,decodedb,cwb,  &
+           nhb,niterb)
+      do j=1,nbatch
+         call bpdecode174(llrs(:,i+j-1),max_iterations,decoded,cw,       &
+              nharderrors,niterations)
+         if(nharderrors.ge.0) nsgood=nsgood+1
+         if(nhb(j).ge.0) nbgood=nbgood+1
+         if((nharderrors.ge.0) .neqv. (nhb(j).ge.0)) then
+            nd=nd+1
+         else if(nharderrors.ge.0 .and. any(cw.ne.cwb(:,j))) then
+            nd=nd+1
+         endif
+      enddo
+   enddo
+   write(*,"(f5.1,3i9)") db,nsgood,nbgood,nd
+   nwords=nwords+ntrials
+   ndiffer=ndiffer+nd
+enddo
+
+write(*,1000) ndiffer,nwords
+1000 format('bpdecode174_test: ',i6,' of',i8,' words decoded differently')
+if(ndiffer.gt.TOLFRAC*nwords) stop 1
+
+end program bpdecode174_test
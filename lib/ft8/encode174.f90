@@ -19,6 +19,7 @@ data first/.true./
 
 save first,gen
 
+!$omp critical(encode174_init)
 if( first ) then ! fill the generator matrix
   gen=0
   do i=1,M
@@ -34,6 +35,7 @@ if( first ) then ! fill the generator matrix
   enddo
 first=.false.
 endif
+!$omp end critical(encode174_init)
 
 do i=1,M
   nsum=0
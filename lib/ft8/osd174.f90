@@ -17,6 +17,7 @@ logical first,reset
 data first/.true./
 save first,gen
 
+!$omp critical(osd174_init)
 if( first ) then ! fill the generator matrix
   gen=0
   do i=1,M
@@ -33,6 +34,7 @@ if( first ) then ! fill the generator matrix
   enddo
 first=.false.
 endif
+!$omp end critical(osd174_init)
 
 ! Re-order received vector to place systematic msg bits at the end.
 rx=llr(colorder+1) 
@@ -290,6 +292,7 @@ subroutine boxit(reset,e2,ntau,npindex,i1,i2)
   integer   indexes(4000,2),fp(0:525000),np(4000)
   logical reset
   common/boxes/indexes,fp,np
+  !$omp threadprivate(/boxes/)
 
   if(reset) then
     patterns=-1
@@ -328,6 +331,7 @@ subroutine fetchit(reset,e2,ntau,i1,i2)
   logical reset
   common/boxes/indexes,fp,np
   save lastpat,inext
+  !$omp threadprivate(/boxes/,lastpat,inext)
 
   if(reset) then
     lastpat=-1
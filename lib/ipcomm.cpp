@@ -1,8 +1,17 @@
+#include <cstdio>
+
 #include <QDebug>
 #include <QString>
 #include <QSharedMemory>
 #include <QSystemSemaphore>
 
+#ifdef Q_OS_WIN
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
 #include "../commons.h"
 
 // Multiple instances: KK1D, 17 Jul 2013
@@ -25,6 +34,8 @@ extern "C" {
 
   bool acquire_jt9_();
   bool release_jt9_();
+
+  void decode_event_pipe(void *context, decode_event const *event);
 }
 
 bool attach_jt9_() {return mem_jt9.attach();}
@@ -46,3 +57,38 @@ bool setkey_jt9_(char* mykey, int mykey_len) {
 
 bool acquire_jt9_() {return sem_jt9.acquire();}
 bool release_jt9_() {return sem_jt9.release();}
+
+// Event sink for lib/decoder_engine.f90 when js8 runs with --binary-events,
+// each event goes to js8call as a frame on stdout (see commons.h)
+void decode_event_pipe(void *, decode_event const *event) {
+   static FILE *frames = nullptr;
+   if(!frames){
+      // the frames get the stdout pipe to themselves, anything else written
+      // to stdout from here on (Fortran unit 6 included) goes to stderr, so
+      // text can never land in the middle of a frame
+      fflush(stdout);
+      int fd = dup(fileno(stdout));
+      dup2(fileno(stderr), fileno(stdout));
+#ifdef Q_OS_WIN
+      _setmode(fd, _O_BINARY);
+#endif
+      frames = fdopen(fd, "wb");
+   }
+
+   int size = sizeof(*event);
+   fwrite(DECODE_FRAME_MAGIC, 1, DECODE_FRAME_MAGIC_SIZE, frames);
+   fwrite(&size, sizeof(size), 1, frames);
+   fwrite(event, sizeof(*event), 1, frames);
+
+   // a cycle's events all come between its started and finished events,
+   // so js8call gets them in a few large writes
+   switch(event->kind){
+   case DECODE_STARTED:
+   case DECODE_FINISHED:
+   case DECODE_PLANNED:
+      fflush(frames);
+      break;
+   default:
+      break;
+   }
+}
@@ -0,0 +1,14 @@
+subroutine js8_plans()
+
+  ! Plan every FFT this submode's decoder makes, so the first decode
+  ! after startup runs as fast as any other.
+
+  !include 'js8_params.f90'
+
+  call four2a_plan(NFFT1,-1,0)                !syncjs8 symbol spectra, r2c
+  call four2a_plan(NSPS*NDD,-1,0)             !js8_downsample long FFT, r2c
+  call four2a_plan(NSPS*NDD/NDOWN,1,1)        !js8_downsample back to time
+  call four2a_plan(NDOWNSPS,-1,1)             !js8dec symbol spectra
+
+  return
+end subroutine js8_plans
@@ -1,9 +1,13 @@
 subroutine js8dec(dd0,icos,newdat,syncStats,nQSOProgress,nfqso,nftx,ndepth,lapon,lapcqonly,   &
-     napwid,lsubtract,nagain,iaptype,mycall12,mygrid6,hiscall12,bcontest,    &
-     sync0,f1,xdt,xbase,apsym,nharderrors,dmin,nbadcrc,ipass,iera,msg37,xsnr)  
+     napwid,nagain,iaptype,mycall12,mygrid6,hiscall12,bcontest,    &
+     sync0,f1,xdt,xbase,apsym,nharderrors,dmin,nbadcrc,ipass,iera,msg37,xsnr,itone)
+
+! Demodulate and decode one sync candidate. dd0 is only read here, the
+! caller subtracts a decoded signal at f1,xdt using the returned itone().
 
   use crc
   use timer_module, only: timer
+  use decoder_engine, only: sink_active, sink_sync_stat, DECODE_SYNC_CANDIDATE, DECODE_SYNC_DECODE
 
   !include 'js8_params.f90'
   
@@ -20,9 +24,12 @@ subroutine js8dec(dd0,icos,newdat,syncStats,nQSOProgress,nfqso,nftx,ndepth,lapon
   real ps(0:7),psl(0:7)
   real bmeta(3*ND),bmetb(3*ND),bmetap(3*ND)
   real llr(3*ND),llra(3*ND),llr0(3*ND),llr1(3*ND),llrap(3*ND)           !Soft symbols
+  real llrb(3*ND,2:4)                                                   !Per pass llrap
   real dd0(NMAX)
   integer icos
   integer*1 decoded(KK),decoded0(KK),cw(3*ND)
+  integer*1 decodedb(KK,2:4),cwb(3*ND,2:4)
+  integer nharderrorsb(2:4),niterationsb(2:4)
   integer*1 msgbits(KK)
   integer apsym(KK)
   integer mcq(28),mde(28),mrrr(16),m73(16),mrr73(16)
@@ -35,7 +42,8 @@ subroutine js8dec(dd0,icos,newdat,syncStats,nQSOProgress,nfqso,nftx,ndepth,lapon
   complex cd0(0:NP-1)
   complex csymb(NDOWNSPS)
   complex cs(0:7, NN)
-  logical first,newdat,lsubtract,lapon,lapcqonly,nagain
+  logical first,newdat,lapon,lapcqonly,nagain
+  logical lbatched                      !Passes 2-4 have been decoded
   equivalence (s1,s1sort)
   data mcq/1,1,1,1,1,0,1,0,0,0,0,0,1,0,0,0,0,0,1,1,0,0,0,1,1,0,0,1/
   data mrrr/0,1,1,1,1,1,1,0,1,1,0,0,1,1,1,1/
@@ -61,6 +69,7 @@ subroutine js8dec(dd0,icos,newdat,syncStats,nQSOProgress,nfqso,nftx,ndepth,lapon
     flush(6)
   endif
 
+  !$omp critical(js8dec_init)
   if(first) then
      mcq=2*mcq-1
      mde=2*mde-1
@@ -92,6 +101,7 @@ subroutine js8dec(dd0,icos,newdat,syncStats,nQSOProgress,nfqso,nftx,ndepth,lapon
      naptypes(5,1:4)=(/3,1,2,0/)  
      first=.false.
   endif
+  !$omp end critical(js8dec_init)
 
   max_iterations=30
   nharderrors=-1
@@ -225,8 +235,12 @@ subroutine js8dec(dd0,icos,newdat,syncStats,nQSOProgress,nfqso,nftx,ndepth,lapon
   endif
 
   if(syncStats) then
-    write(*,*) '<DecodeSyncStat> candidate ', NSUBMODE, 'f1', f1, 'sync', nsync, 'xdt', xdt
-    flush(6)
+    if(sink_active()) then
+      call sink_sync_stat(DECODE_SYNC_CANDIDATE, NSUBMODE, f1, float(nsync), xdt)
+    else
+      write(*,*) '<DecodeSyncStat> candidate ', NSUBMODE, 'f1', f1, 'sync', nsync, 'xdt', xdt
+      flush(6)
+    endif
   endif
 
   j=0
@@ -357,6 +371,14 @@ subroutine js8dec(dd0,icos,newdat,syncStats,nQSOProgress,nfqso,nftx,ndepth,lapon
     npasses=4 
   endif
 
+  ! A candidate that decodes at all mostly decodes on the 1st pass, so
+  ! that pass runs on its own through the scalar decoder. The belief
+  ! propagation of a pass only depends on that pass's llrs (passes after
+  ! the 4th reuse the 4th's) so once the 1st pass has failed, passes 2
+  ! to 4 are decoded together in one batch and taken in order below.
+  nbp=min(npasses,4)
+  lbatched=.false.
+
   do ipass=1,npasses 
                
      llr=llr0
@@ -368,11 +390,31 @@ subroutine js8dec(dd0,icos,newdat,syncStats,nQSOProgress,nfqso,nftx,ndepth,lapon
         iaptype=0
      endif
         
-     cw=0
-     call timer('bpd174  ',0)
-     call bpdecode174(llrap,max_iterations,decoded,cw,nharderrors,  &
-          niterations)
-     call timer('bpd174  ',1)
+     if(ipass.eq.1) then
+        cw=0
+        call timer('bpd174  ',0)
+        call bpdecode174(llrap,max_iterations,decoded,cw,nharderrors,  &
+             niterations)
+        call timer('bpd174  ',1)
+     else
+        if(.not.lbatched) then
+           do ib=2,nbp
+              llrb(:,ib)=llr0
+              if(ib.eq.2) llrb(:,ib)=llr1
+              if(ib.eq.3) llrb(1:24,ib)=0.
+              if(ib.eq.4) llrb(1:48,ib)=0.
+           enddo
+           call timer('bpd174  ',0)
+           call bpdecode174_batch(llrb,nbp-1,max_iterations,decodedb,cwb,  &
+                nharderrorsb,niterationsb)
+           call timer('bpd174  ',1)
+           lbatched=.true.
+        endif
+        ib=min(ipass,4)
+        decoded=decodedb(:,ib)
+        cw=cwb(:,ib)
+        nharderrors=nharderrorsb(ib)
+     endif
 
      if(NWRITELOG.eq.1) then
        write(*,*) '<DecodeDebug> bpd174', ipass, nharderrors, dmin
@@ -423,8 +465,12 @@ subroutine js8dec(dd0,icos,newdat,syncStats,nQSOProgress,nfqso,nftx,ndepth,lapon
 
      if(nbadcrc.eq.0) then
         if(syncStats) then
-            write(*,*) '<DecodeSyncStat> decode ', NSUBMODE, 'f1', f1, 'sync', (sync*10), 'xdt', xdt2
-            flush(6)
+            if(sink_active()) then
+                call sink_sync_stat(DECODE_SYNC_DECODE, NSUBMODE, f1, sync*10, xdt2)
+            else
+                write(*,*) '<DecodeSyncStat> decode ', NSUBMODE, 'f1', f1, 'sync', (sync*10), 'xdt', xdt2
+                flush(6)
+            endif
         endif
 
         decoded0=decoded
@@ -433,13 +479,6 @@ subroutine js8dec(dd0,icos,newdat,syncStats,nQSOProgress,nfqso,nftx,ndepth,lapon
 
         message(1:12)=origmsg(1:12)
         call genjs8(message,icos,mygrid6,bcontest,i3bit,msgsent,msgbits,itone)
-        if(lsubtract) then
-            if(NWRITELOG.eq.1) then
-                write(*,*) '<DecodeDebug> subtract', f1, xdt2, itone
-                flush(6)
-            endif
-            call subtractjs8(dd0,itone,f1,xdt2)
-        endif
         xsig=0.0
         xnoi=0.0
         do i=1,NN
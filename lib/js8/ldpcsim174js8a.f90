@@ -10,6 +10,9 @@ character*22 msg,msgsent,msgreceived
 character*8 arg
 character*6 grid
 integer*1, allocatable ::  codeword(:), decoded(:), message(:)
+integer*1, allocatable ::  decodedb(:,:), cwb(:,:)
+integer, allocatable :: nhb(:), niterb(:)
+integer*8 c0,c1,c2,crate
 integer*1, target:: i1Msg8BitBytes(11)
 integer*1 msgbits(87)
 integer*1 apmask(174), cw(174)
@@ -19,7 +22,7 @@ integer colorder(174)
 integer nerrtot(174),nerrdec(174),nmpcbad(87)
 logical checksumok,fsk,bpsk
 real*8, allocatable ::  rxdata(:)
-real, allocatable :: llr(:)
+real, allocatable :: llr(:), llrs(:,:)
 
 data colorder/            &
    0,  1,  2,  3, 30,  4,  5,  6,  7,  8,  9, 10, 11, 32, 12, 40, 13, 14, 15, 16,&
@@ -37,11 +40,13 @@ nerrdec=0
 nmpcbad=0  ! Used to collect the number of errors in the message+crc part of the codeword
 
 nargs=iargc()
-if(nargs.ne.4) then
-   print*,'Usage: ldpcsim  niter  ndepth  #trials   s '
+if(nargs.lt.4 .or. nargs.gt.5) then
+   print*,'Usage: ldpcsim  niter  ndepth  #trials   s  [nbatch]'
    print*,'eg:    ldpcsim    10     2      1000    0.84'
    print*,'belief propagation iterations: niter, ordered-statistics depth: ndepth'
    print*,'If s is negative, then value is ignored and sigma is calculated from SNR.'
+   print*,'If nbatch is given, benchmark scalar vs. batched belief propagation'
+   print*,'throughput, decoding nbatch words per batched call.'
    return
 endif
 call getarg(1,arg)
@@ -52,6 +57,11 @@ call getarg(3,arg)
 read(arg,*) ntrials 
 call getarg(4,arg)
 read(arg,*) s
+nbatch=0
+if(nargs.eq.5) then
+   call getarg(5,arg)
+   read(arg,*) nbatch
+endif
 
 fsk=.false.
 bpsk=.true.
@@ -67,6 +77,9 @@ write(*,*) "niter= ",max_iterations," s= ",s
 
 allocate ( codeword(N), decoded(K), message(K) )
 allocate ( rxdata(N), llr(N) )
+if(nbatch.gt.0) then
+  allocate ( llrs(N,ntrials), decodedb(K,nbatch), cwb(N,nbatch), nhb(nbatch), niterb(nbatch) )
+endif
 
   msg="0123456789012"
 !  msg="G4WJS K9AN EN50"
@@ -133,7 +146,11 @@ allocate ( rxdata(N), llr(N) )
   write(*,*) 'codeword' 
   write(*,'(22(8i1,1x))') codeword
 
-write(*,*) "Es/N0   SNR2500   ngood  nundetected nbadcrc   sigma"
+if(nbatch.gt.0) then
+  write(*,*) "Es/N0    ngood   nbgood   scalar cw/s  batched cw/s"
+else
+  write(*,*) "Es/N0   SNR2500   ngood  nundetected nbadcrc   sigma"
+endif
 do idb = 20,-10,-1 
 !do idb = -3,-3,-1 
   db=idb/2.0-1.0
@@ -188,9 +205,14 @@ do idb = 20,-10,-1
     apmask=0
     apmask(colorder(174-87+1:174-87+nap)+1)=1
 
+    if(nbatch.gt.0) then
+      llrs(:,itrial)=llr
+      cycle
+    endif
+
 ! max_iterations is max number of belief propagation iterations
-    call bpdecode174(llr, apmask, max_iterations, decoded, cw, nharderrors,niterations)
-    if( ndepth .ge. 0 .and. nharderrors .lt. 0 ) call osd174(llr, apmask, ndepth, decoded, cw,  nharderrors, dmin)
+    call bpdecode174(llr, max_iterations, decoded, cw, nharderrors, niterations)
+    if( ndepth .ge. 0 .and. nharderrors .lt. 0 ) call osd174(llr, ndepth, decoded, cw, nharderrors, dmin)
 ! If the decoder finds a valid codeword, nharderrors will be .ge. 0.
     if( nharderrors .ge. 0 ) then
       call extractmessage174(decoded,msgreceived,ncrcflag)
@@ -217,6 +239,31 @@ do idb = 20,-10,-1
       endif
     endif
   enddo
+
+  if(nbatch.gt.0) then
+! Benchmark mode: belief propagation only, the same words through the
+! scalar decoder one at a time and the batched decoder nbatch at a time.
+    call system_clock(c0,crate)
+    ngood=0
+    do itrial=1,ntrials
+      call bpdecode174(llrs(:,itrial), max_iterations, decoded, cw, nharderrors, niterations)
+      if( nharderrors .ge. 0 .and. all(decoded .eq. msgbits) ) ngood=ngood+1
+    enddo
+    call system_clock(c1)
+    nbgood=0
+    do i=1,ntrials,nbatch
+      nb=min(nbatch,ntrials-i+1)
+      call bpdecode174_batch(llrs(:,i), nb, max_iterations, decodedb, cwb, nhb, niterb)
+      do j=1,nb
+        if( nhb(j) .ge. 0 .and. all(decodedb(:,j) .eq. msgbits) ) nbgood=nbgood+1
+      enddo
+    enddo
+    call system_clock(c2)
+    write(*,"(f4.1,1x,i8,1x,i8,2x,f12.1,2x,f12.1)") db,ngood,nbgood,             &
+         ntrials*real(crate)/max(1_8,c1-c0),ntrials*real(crate)/max(1_8,c2-c1)
+    cycle
+  endif
+
   baud=12000.0/NSPS
   snr2500=db+10.0*log10((baud/2500.0))
   pberr=real(nberr)/(real(ntrials*N))
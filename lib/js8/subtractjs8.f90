@@ -5,18 +5,27 @@ subroutine subtractjs8(dd,itone,f0,dt)
 ! Reference signal : cref(t)  = exp( j*(2*pi*f0*t+phi(t)) )
 ! Complex amp      : cfilt(t) = LPF[ dd(t)*CONJG(cref(t)) ]
 ! Subtract         : dd(t)    = dd(t) - 2*REAL{cref*cfilt}
+!
+! The LPF is a cos**2 window NFILT samples wide, applied directly over
+! the NFRAME samples the signal spans rather than by FFTs over all of
+! dd. Since cos**2(x) = (1+cos(2x))/2 the windowed sum at each sample
+! is a moving sum of camp plus two moving sums of camp turned by
+! exp(-+j*2*pi*m/NFILT), and each of those is updated by adding the
+! sample entering the window and dropping the one leaving it.
 
-  parameter (NSHIFT=0)
   parameter (NFRAME=NSPS*NN)
-  parameter (NFFT=NMAX, NFILT=1400)
+  parameter (NFILT=1400, NH=NFILT/2)
 
-  real*4 dd(NMAX), window(-NFILT/2:NFILT/2)
-  complex cref,camp,cfilt,cw
+  real*4 dd(NMAX)
+  complex cref(NFRAME),camp(NFRAME),cfilt
+  complex*16 phasor(0:NFILT-1),s0,sp,sm,z
+  real*8 pi,wsum
   integer itone(NN)
   logical first
   data first/.true./
-  common/heap8/cref(NFRAME),camp(NMAX),cfilt(NMAX),cw(NMAX)
-  save first
+  ! private to each submode module (not a shared common block) so that
+  ! submodes decoded concurrently never share scratch space
+  save first,cref,camp,phasor,wsum
 
   nstart=dt*12000+1
 
@@ -33,87 +42,58 @@ subroutine subtractjs8(dd,itone,f0,dt)
     if(id.ge.1.and.id.le.NMAX) camp(i)=dd(id)*conjg(cref(i))
   enddo
 
-  if(NWRITELOG.eq.1) then
-      write(*,*) '<DecodeDebug> filtering', NFFT
-      flush(6)
-  endif
-
   if(first) then
-      ! Create and normalize the filter
-      if(NWRITELOG.eq.1) then
-          write(*,*) '<DecodeDebug> creating and normalizing filter'
-          flush(6)
-      endif
-
-      if(NSHIFT.eq.0) then
-        pi=4.0*atan(1.0)
-        fac=1.0/float(NFFT)
-        sum=0.0
-        do j=-NFILT/2,NFILT/2
-            window(j)=cos(pi*j/NFILT)**2
-            sum=sum+window(j)
-        enddo
-        cw=0.
-        window=window/sum
-
-        ! windows struggles with this cshift...i'm not sure why!?
-        !cw(1:NFILT+1)=window
-        !cw=cshift(cw,NFILT/2+1)
-        ! so, this should be the same computation result
-        cw(1:NFILT/2)=window(1:NFILT/2)
-        cw(NFILT/2:NFILT+1)=0
-        cw(NMAX-NFILT/2:NMAX)=window(-NFILT/2:0)
-
-        call four2a(cw,NFFT,1,-1,1)
-        cw=cw*fac
-        first=.false.
-      else
-        pi=4.0*atan(1.0)
-        fac=1.0/float(NFFT)
-        sum=0.0
-        do j=-NFILT/2,NFILT/2
-           window(j)=cos(pi*j/NFILT)**2
-           sum=sum+window(j)
-        enddo
-        cw=0.
-        ! this ultimately shifts 1/2 of the window out of computation
-        ! since it's multiplied against cfilt whiich will only have amp
-        ! values for NFRAME length, which will always be > 20000 samples
-        ! longer than the NFRAME.
-        ! cw(1:NFILT+1)=window/sum
-        ! cw=cshift(cw,NFILT/2+1)
-        cw(1:NFILT/2)=window(1:NFILT/2)
-        ! we really don't even need the second half of the window.
-        ! start=NMAX-NFILT/2
-        ! end=NMAX-NFILT+1
-        ! cw(start:end)=window(-NFILT/2:1)
-        cw=cw/sum
-        call four2a(cw,NFFT,1,-1,1)
-        cw=cw*fac
-        first=.false.
-      endif
+      ! The window's normalization and one period of its cosine
+      pi=4.d0*atan(1.d0)
+      wsum=0.d0
+      do j=-NH,NH
+          wsum=wsum+cos(pi*j/NFILT)**2
+      enddo
+      do j=0,NFILT-1
+          phasor(j)=cmplx(cos(2*pi*j/NFILT),sin(2*pi*j/NFILT),kind=8)
+      enddo
+      first=.false.
   endif
 
   if(NWRITELOG.eq.1) then
-      write(*,*) '<DecodeDebug> generating complex amplitude'
+      write(*,*) '<DecodeDebug> filtering and subtracting', NFRAME
       flush(6)
   endif
 
-  cfilt=0.0
-  cfilt(1:NFRAME)=camp(1:NFRAME)
-  call four2a(cfilt,NFFT,1,-1,1)
-  cfilt(1:NFFT)=cfilt(1:NFFT)*cw(1:NFFT)
-  call four2a(cfilt,NFFT,1,1,1)
-
-  if(NWRITELOG.eq.1) then
-      write(*,*) '<DecodeDebug> subtracting filtered reference', NFFT
-      flush(6)
-  endif
+! The window for sample i is centered on camp(i+1), as it was when the
+! filter was applied with FFTs
+  s0=0.
+  sp=0.
+  sm=0.
+  do m=1,min(1+NH,NFRAME)
+     z=camp(m)
+     s0=s0+z
+     sp=sp+phasor(mod(m,NFILT))*z
+     sm=sm+conjg(phasor(mod(m,NFILT)))*z
+  enddo
 
 ! Subtract the reconstructed signal
   do i=1,NFRAME
+     m=i+1+NH
+     if(m.le.NFRAME) then
+        z=camp(m)
+        s0=s0+z
+        sp=sp+phasor(mod(m,NFILT))*z
+        sm=sm+conjg(phasor(mod(m,NFILT)))*z
+     endif
+     m=i-NH
+     if(m.ge.1) then
+        z=camp(m)
+        s0=s0-z
+        sp=sp-phasor(mod(m,NFILT))*z
+        sm=sm-conjg(phasor(mod(m,NFILT)))*z
+     endif
+
+     z=phasor(mod(i+1,NFILT))
+     cfilt=(s0 + 0.5d0*(z*sm + conjg(z)*sp))/(2*wsum)
+
      j=nstart+i-1
-     if(j.ge.1 .and. j.le.NMAX) dd(j)=dd(j)-2*REAL(cfilt(i)*cref(i))
+     if(j.ge.1 .and. j.le.NMAX) dd(j)=dd(j)-2*REAL(cfilt*cref(i))
   enddo
 
   return
@@ -0,0 +1,157 @@
+program subtractjs8_test
+! Checks the windowed sum subtraction of subtractjs8 against the FFT low
+! pass filter it replaced. JS8A signals from genjs8 are added to a
+! recorded period, one whole, one starting before dd and one running off
+! its end, and each is subtracted by both. The two filters use the same
+! window, but the old one works in single precision FFTs over all of dd
+! and the new one in double precision moving sums, so the residuals may
+! differ by rounding: no sample may differ by more than TOL, and each
+! has to take out most of the signal.
+
+! Usage: subtractjs8_test file.wav     (12000 Hz, 16 bit mono, 15 s)
+
+use wavhdr
+use js8a_module
+
+parameter (NSIG=3)
+! A hundredth of the 16 bit step the samples come in. The rounding of a
+! real sample near full scale alone is 2e-3.
+parameter (TOL=1.e-2)
+parameter (AMP=300.0)                 !Of each added signal
+
+type(hdr) h
+real dd(NMAX),dd0(NMAX),dd1(NMAX)
+real*8 twopi,phi,dphi
+real f0s(NSIG),dts(NSIG)
+integer*2 id2(NMAX)
+integer itone(NN)
+integer*1 msgbits(KK)
+logical bcontest
+character*22 msg,msgsent
+character*6 grid
+character*256 infile
+data f0s/1000.0,1500.0,2000.0/
+data dts/0.5,-1.0,3.0/
+
+if(iargc().ne.1) then
+   print*,'Usage: subtractjs8_test file.wav'
+   stop 2
+endif
+call getarg(1,infile)
+open(10,file=infile,status='old',access='stream',iostat=ios)
+if(ios.ne.0) then
+   print*,'subtractjs8_test: cannot open ',trim(infile)
+   stop 2
+endif
+read(10) h
+npts=min(h%ndata/2,NMAX)
+id2=0
+read(10) id2(1:npts)
+close(10)
+dd=id2
+
+twopi=8.d0*atan(1.d0)
+grid='      '
+bcontest=.false.
+i3bit=0
+errmax=0.
+nbad=0
+do isig=1,NSIG
+   ! 12 characters of genjs8's alphabet, which has no space
+   write(msg,'(a,i2.2)') 'KN4CRDtest',isig
+   call genjs8(msg,NCOSTAS,grid,bcontest,i3bit,msgsent,msgbits,itone)
+
+   ! continuous phase FSK, as Modulator sends it
+   dd0=dd
+   phi=0.d0
+   k=nint(dts(isig)*12000)
+   do j=1,NN
+      dphi=twopi*(f0s(isig)+itone(j)*12000.0/NSPS)/12000.d0
+      do i=1,NSPS
+         k=k+1
+         if(k.ge.1 .and. k.le.NMAX) dd0(k)=dd0(k) + AMP*sin(phi)
+         phi=mod(phi+dphi,twopi)
+      enddo
+   enddo
+
+   dd1=dd0
+   call subtractjs8(dd0,itone,f0s(isig),dts(isig))
+   call subtract_fft(dd1,itone,f0s(isig),dts(isig))
+
+   err=maxval(abs(dd0-dd1))
+   errmax=max(errmax,err)
+   if(err.gt.TOL) nbad=nbad+1
+
+   ! a signal left in place would leave ~190 here
+   rms0=sqrt(sum((dd0-dd)**2)/NMAX)
+   rms1=sqrt(sum((dd1-dd)**2)/NMAX)
+   if(max(rms0,rms1).gt.0.25*AMP) nbad=nbad+1
+   write(*,1000) f0s(isig),dts(isig),rms0,rms1,err
+1000 format('subtractjs8_test: f0',f7.1,'  dt',f5.1,'  residual rms',  &
+        2f8.3,'  max diff',es10.2)
+enddo
+
+if(nbad.ne.0) then
+   write(*,1010) nbad,errmax,TOL
+1010 format('subtractjs8_test: ',i2,' failures, max diff',es10.2,      &
+        '  tolerance',es10.2)
+   stop 1
+endif
+
+contains
+
+subroutine subtract_fft(dd,itone,f0,dt)
+! The subtraction as subtractjs8 did it before, filtering the complex
+! amplitude with FFTs of all NMAX points.
+
+  parameter (NFRAME=NSPS*NN)
+  parameter (NFFT=NMAX, NFILT=1400)
+
+  real*4 dd(NMAX), window(-NFILT/2:NFILT/2)
+  complex cref(NFRAME),camp(NMAX),cfilt(NMAX),cw(NMAX)
+  integer itone(NN)
+  logical first
+  data first/.true./
+  save first,cref,camp,cfilt,cw
+
+  nstart=dt*12000+1
+
+  call genjs8refsig(itone,cref,f0)
+
+  camp=0.
+  do i=1,NFRAME
+    id=nstart-1+i
+    if(id.ge.1.and.id.le.NMAX) camp(i)=dd(id)*conjg(cref(i))
+  enddo
+
+  if(first) then
+      pi=4.0*atan(1.0)
+      fac=1.0/float(NFFT)
+      wsum=0.0
+      do j=-NFILT/2,NFILT/2
+          window(j)=cos(pi*j/NFILT)**2
+          wsum=wsum+window(j)
+      enddo
+      cw=0.
+      window=window/wsum
+      cw(1:NFILT/2)=window(1:NFILT/2)
+      cw(NFILT/2:NFILT+1)=0
+      cw(NMAX-NFILT/2:NMAX)=window(-NFILT/2:0)
+      call four2a(cw,NFFT,1,-1,1)
+      cw=cw*fac
+      first=.false.
+  endif
+
+  cfilt=0.0
+  cfilt(1:NFRAME)=camp(1:NFRAME)
+  call four2a(cfilt,NFFT,1,-1,1)
+  cfilt(1:NFFT)=cfilt(1:NFFT)*cw(1:NFFT)
+  call four2a(cfilt,NFFT,1,1,1)
+
+  do i=1,NFRAME
+     j=nstart+i-1
+     if(j.ge.1 .and. j.le.NMAX) dd(j)=dd(j)-2*REAL(cfilt(i)*cref(i))
+  enddo
+end subroutine subtract_fft
+
+end program subtractjs8_test
@@ -0,0 +1,86 @@
+subroutine sync2djs8(s,ia,ib,jstrt,nssy,nfos,icos7a,icos7b,icos7c,sync2d)
+
+  ! Costas sync of every frequency ia..ib at every time step -JZ..JZ.
+  ! Computed a whole frequency row at a time, s is frequency major so
+  ! every tone lookup of the row is unit stride. The 7 tone sum at each
+  ! frequency and step is shared by every (j,n) that lands on that step,
+  ! so it is computed once up front. See sync2djs8_test.f90 for the
+  ! scalar loop this has to match.
+
+  real s(NH1,NHSYM)
+  real sync2d(NH1,-JZ:JZ)
+  real ta(NH1),tb(NH1),tc(NH1)
+  real t0a(NH1),t0b(NH1),t0c(NH1)
+  real, allocatable :: s7(:,:)
+  integer icos7a(0:6), icos7b(0:6), icos7c(0:6)
+  integer syoff !symbol offset
+
+  allocate(s7(ia:ib,NHSYM))
+  do k=1,NHSYM
+     s7(ia:ib,k)=s(ia:ib,k)
+     do m=1,6
+        s7(ia:ib,k)=s7(ia:ib,k) + s(ia+nfos*m:ib+nfos*m,k)
+     enddo
+  enddo
+
+  do j=-JZ,+JZ
+     ta(ia:ib)=0.
+     tb(ia:ib)=0.
+     tc(ia:ib)=0.
+     t0a(ia:ib)=0.
+     t0b(ia:ib)=0.
+     t0c(ia:ib)=0.
+     do n=0,6
+        k=j+jstrt+nssy*n
+
+        syoff=k
+        if(syoff.ge.1.and.syoff.le.NHSYM) then
+           m=nfos*icos7a(n)
+           ta(ia:ib)=ta(ia:ib) + s(ia+m:ib+m,syoff)
+           t0a(ia:ib)=t0a(ia:ib) + s7(ia:ib,syoff)
+        endif
+
+        syoff=k+nssy*36
+        if(syoff.ge.1.and.syoff.le.NHSYM) then
+           m=nfos*icos7b(n)
+           tb(ia:ib)=tb(ia:ib) + s(ia+m:ib+m,syoff)
+           t0b(ia:ib)=t0b(ia:ib) + s7(ia:ib,syoff)
+        endif
+
+        syoff=k+nssy*72
+        if(syoff.ge.1.and.syoff.le.NHSYM) then
+           m=nfos*icos7c(n)
+           tc(ia:ib)=tc(ia:ib) + s(ia+m:ib+m,syoff)
+           t0c(ia:ib)=t0c(ia:ib) + s7(ia:ib,syoff)
+        endif
+     enddo
+
+     do i=ia,ib
+        t=ta(i)+tb(i)+tc(i)
+        t0=t0a(i)+t0b(i)+t0c(i)
+        t0=(t0-t)/6.0
+        sync_abc=t/t0
+
+        t=ta(i)+tb(i)
+        t0=t0a(i)+t0b(i)
+        t0=(t0-t)/6.0
+        sync_ab=t/t0
+
+        t=ta(i)+tc(i)
+        t0=t0a(i)+t0c(i)
+        t0=(t0-t)/6.0
+        sync_ac=t/t0
+
+        t=tb(i)+tc(i)
+        t0=t0b(i)+t0c(i)
+        t0=(t0-t)/6.0
+        sync_bc=t/t0
+
+        !sync2d(i,j)=max(max(max(sync_abc, sync_ab), sync_ac), sync_bc)
+        sync2d(i,j)=max(sync_abc, sync_ab, sync_bc)
+     enddo
+  enddo
+  deallocate(s7)
+
+  return
+end subroutine sync2djs8
@@ -0,0 +1,146 @@
+program sync2djs8_test
+! Checks the row at a time Costas sync of sync2djs8 against the scalar
+! loop it replaced, on the symbol spectra of a recorded Normal mode
+! period, for both Costas arrays. The two add the same terms in the same
+! order, so every point of sync2d has to be identical, not just close.
+
+! Usage: sync2djs8_test file.wav     (12000 Hz, 16 bit mono, 15 s)
+
+use wavhdr
+use js8a_module
+
+type(hdr) h
+complex cx(0:NH1)
+real x(NFFT1)
+real dd(NMAX)
+real s(NH1,NHSYM)
+real sync2d(NH1,-JZ:JZ)
+real sync2d0(NH1,-JZ:JZ)
+integer*2 id2(NMAX)
+integer icos7a(0:6), icos7b(0:6), icos7c(0:6)
+character*256 infile
+equivalence (x,cx)
+
+if(iargc().ne.1) then
+   print*,'Usage: sync2djs8_test file.wav'
+   stop 2
+endif
+call getarg(1,infile)
+open(10,file=infile,status='old',access='stream',iostat=ios)
+if(ios.ne.0) then
+   print*,'sync2djs8_test: cannot open ',trim(infile)
+   stop 2
+endif
+read(10) h
+npts=min(h%ndata/2,NMAX)
+id2=0
+read(10) id2(1:npts)
+close(10)
+dd=id2
+
+! symbol spectra as syncjs8 computes them
+nssy=NSPS/NSTEP
+nfos=NFFT1/NSPS
+tstep=NSTEP/12000.0
+df=12000.0/NFFT1
+jstrt=ASTART/tstep
+fac=1.0/300.0
+do j=1,NHSYM
+   ia=(j-1)*NSTEP + 1
+   ib=ia+NSPS-1
+   x(1:NSPS)=fac*dd(ia:ib)
+   x(NSPS+1:)=0.
+   call four2a(cx,NFFT1,1,-1,0)
+   do i=1,NH1
+      s(i,j)=real(cx(i))**2 + aimag(cx(i))**2
+   enddo
+enddo
+ia=max(1,nint(200.0/df))
+ib=nint(3000.0/df)
+
+nbad=0
+do icos=1,2
+   if(icos.eq.1) then
+      icos7a = (/4,2,5,6,1,3,0/)
+      icos7b = (/4,2,5,6,1,3,0/)
+      icos7c = (/4,2,5,6,1,3,0/)
+   else
+      icos7a = (/0,6,2,3,5,4,1/)
+      icos7b = (/1,5,0,2,3,6,4/)
+      icos7c = (/2,5,0,6,4,1,3/)
+   endif
+   sync2d=0.
+   sync2d0=0.
+   call sync2djs8(s,ia,ib,jstrt,nssy,nfos,icos7a,icos7b,icos7c,sync2d)
+   call scalar_sync2d(s,ia,ib,jstrt,nssy,nfos,icos7a,icos7b,icos7c,sync2d0)
+   nbad=nbad + count(sync2d(ia:ib,:).ne.sync2d0(ia:ib,:))
+enddo
+
+write(*,1000) 2*(ib-ia+1)*(2*JZ+1),nbad
+1000 format('sync2djs8_test: ',i8,' points',i8,' differ')
+if(nbad.ne.0) stop 1
+
+contains
+
+subroutine scalar_sync2d(s,ia,ib,jstrt,nssy,nfos,icos7a,icos7b,icos7c,sync2d)
+! The per (i,j) loop syncjs8 used before sync2djs8.
+  real s(NH1,NHSYM)
+  real sync2d(NH1,-JZ:JZ)
+  integer icos7a(0:6), icos7b(0:6), icos7c(0:6)
+  integer syoff
+
+  do i=ia,ib
+     do j=-JZ,+JZ
+        ta=0.
+        tb=0.
+        tc=0.
+        t0a=0.
+        t0b=0.
+        t0c=0.
+        do n=0,6
+           k=j+jstrt+nssy*n
+
+           syoff=k
+           if(syoff.ge.1.and.syoff.le.NHSYM) then
+              ta=ta + s(i+nfos*icos7a(n),syoff)
+              t0a=t0a + sum(s(i:i+nfos*6:nfos,syoff))
+           endif
+
+           syoff=k+nssy*36
+           if(syoff.ge.1.and.syoff.le.NHSYM) then
+              tb=tb + s(i+nfos*icos7b(n),syoff)
+              t0b=t0b + sum(s(i:i+nfos*6:nfos,syoff))
+           endif
+
+           syoff=k+nssy*72
+           if(syoff.ge.1.and.syoff.le.NHSYM) then
+              tc=tc + s(i+nfos*icos7c(n),syoff)
+              t0c=t0c + sum(s(i:i+nfos*6:nfos,syoff))
+           endif
+        enddo
+        t=ta+tb+tc
+        t0=t0a+t0b+t0c
+        t0=(t0-t)/6.0
+        sync_abc=t/t0
+
+        t=ta+tb
+        t0=t0a+t0b
+        t0=(t0-t)/6.0
+        sync_ab=t/t0
+
+        t=ta+tc
+        t0=t0a+t0c
+        t0=(t0-t)/6.0
+        sync_ac=t/t0
+
+        t=tb+tc
+        t0=t0b+t0c
+        t0=(t0-t)/6.0
+        sync_bc=t/t0
+
+        sync2d(i,j)=max(sync_abc, sync_ab, sync_bc)
+     enddo
+  enddo
+end subroutine scalar_sync2d
+
+end program sync2djs8_test
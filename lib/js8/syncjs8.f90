@@ -1,4 +1,8 @@
-subroutine syncjs8(dd,icos,nfa,nfb,syncmin,nfqso,s,candidate,ncand,sbase)
+subroutine syncjs8(dd,npos,nvalid,icos,nfa,nfb,syncmin,nfqso,s,candidate,ncand,sbase)
+
+  ! npos:   first frame of dd in the ring buffer, -1 if dd no longer
+  !         holds the audio as read (i.e. after subtraction)
+  ! nvalid: number of frames of dd that are audio, the rest is zero fill
 
   !include 'js8_params.f90'
   
@@ -7,18 +11,29 @@ subroutine syncjs8(dd,icos,nfa,nfb,syncmin,nfqso,s,candidate,ncand,sbase)
   real savg(NH1)
   real sbase(NH1)
   real x(NFFT1)
-  real sync2d(NH1,-JZ:JZ)
+  real, allocatable :: sync2d(:,:)      !~1 MB, kept off OpenMP worker stacks
   real red(NH1)
   real candidate0(3,NMAXCAND)
   real candidate(3,NMAXCAND)
   real dd(NMAX)
+  integer npos,nvalid
   integer icos
   integer jpeak(NH1)
   integer indx(NH1)
   integer ii(1)
-  integer syoff !symbol offset
   equivalence (x,cx)
 
+  ! The symbol spectra of the last window searched. Successive windows of
+  ! a submode overlap (the same cycle decoded again as more of it arrives,
+  ! or the window sliding by a second in auto-sync mode) so any complete
+  ! column on the same NSTEP grid is reused rather than transformed again.
+  ! Each submode has its own copy of this routine, and it is only called
+  ! by the thread decoding that submode.
+  real, save :: scache(NH1,NHSYM)       !Unscaled symbol spectra
+  real, save :: ddcache(NMAX)           !The audio they were computed from
+  integer, save :: kcache=-1            !First frame of ddcache, -1 if none
+  integer, save :: ncache=0             !Number of complete columns
+
   integer icos7a(0:6), icos7b(0:6), icos7c(0:6)
 
   if(icos.eq.1) then
@@ -37,12 +52,34 @@ subroutine syncjs8(dd,icos,nfa,nfb,syncmin,nfqso,s,candidate,ncand,sbase)
     flush(6)
   endif
 
+! Reuse the columns of the last window that this one overlaps.
+  nv=max(0,min(nvalid,NMAX))
+  nfull=max(0,min(NHSYM,(nv-NSPS)/NSTEP+1))       !Columns with no zero fill
+  nreuse=0
+  if(npos.ge.0 .and. kcache.ge.0) then
+     ishift=npos-kcache
+     if(ishift.ge.0 .and. mod(ishift,NSTEP).eq.0) then
+        jshift=ishift/NSTEP
+        n=min(ncache-jshift,nfull)
+        if(n.gt.0) then
+           ! the ring buffer may have wrapped since, so compare the audio
+           nsamp=(n-1)*NSTEP+NSPS
+           if(all(dd(1:nsamp).eq.ddcache(ishift+1:ishift+nsamp))) nreuse=n
+        endif
+     endif
+  endif
+  if(nreuse.gt.0) s(:,1:nreuse)=scache(:,jshift+1:jshift+nreuse)
+
+  if(NWRITELOG.eq.1) then
+    write(*,*) '<DecodeDebug> syncjs8 reused', nreuse, 'of', NHSYM, 'spectra'
+    flush(6)
+  endif
+
 ! Compute symbol spectra, stepping by NSTEP steps.  
-  savg=0.
   tstep=NSTEP/12000.0                         
   df=12000.0/NFFT1                  
   fac=1.0/300.0
-  do j=1,NHSYM
+  do j=nreuse+1,NHSYM
      ia=(j-1)*NSTEP + 1
      ib=ia+NSPS-1
      x(1:NSPS)=fac*dd(ia:ib)
@@ -51,9 +88,20 @@ subroutine syncjs8(dd,icos,nfa,nfb,syncmin,nfqso,s,candidate,ncand,sbase)
      do i=1,NH1
         s(i,j)=real(cx(i))**2 + aimag(cx(i))**2
      enddo
+  enddo
+
+  savg=0.
+  do j=1,NHSYM
      savg=savg + s(1:NH1,j)                   !Average spectrum
   enddo
 
+  if(npos.ge.0) then
+     scache=s
+     ddcache(1:nv)=dd(1:nv)
+     kcache=npos
+     ncache=nfull
+  endif
+
   call baselinejs8(savg,nfa,nfb,sbase)
 
   ia=max(1,nint(nfa/df)) ! min freq
@@ -65,60 +113,8 @@ subroutine syncjs8(dd,icos,nfa,nfb,syncmin,nfqso,s,candidate,ncand,sbase)
   candidate0=0.
   k=0
 
-  do i=ia,ib
-     do j=-JZ,+JZ
-        ta=0.
-        tb=0.
-        tc=0.
-        t0a=0.
-        t0b=0.
-        t0c=0.
-        do n=0,6
-           k=j+jstrt+nssy*n
-           
-           syoff=k
-           if(syoff.ge.1.and.syoff.le.NHSYM) then
-              ta=ta + s(i+nfos*icos7a(n),syoff)
-              t0a=t0a + sum(s(i:i+nfos*6:nfos,syoff))
-           endif
-
-           syoff=k+nssy*36
-           if(syoff.ge.1.and.syoff.le.NHSYM) then
-              tb=tb + s(i+nfos*icos7b(n),syoff)
-              t0b=t0b + sum(s(i:i+nfos*6:nfos,syoff))
-           endif
-           
-           syoff=k+nssy*72
-           if(syoff.ge.1.and.syoff.le.NHSYM) then
-              tc=tc + s(i+nfos*icos7c(n),syoff)
-              t0c=t0c + sum(s(i:i+nfos*6:nfos,syoff))
-           endif
-        enddo
-
-        t=ta+tb+tc
-        t0=t0a+t0b+t0c
-        t0=(t0-t)/6.0
-        sync_abc=t/t0
-
-        t=ta+tb
-        t0=t0a+t0b
-        t0=(t0-t)/6.0
-        sync_ab=t/t0
-
-        t=ta+tc
-        t0=t0a+t0c
-        t0=(t0-t)/6.0
-        sync_ac=t/t0
-
-        t=tb+tc
-        t0=t0b+t0c
-        t0=(t0-t)/6.0
-        sync_bc=t/t0
-
-        !sync2d(i,j)=max(max(max(sync_abc, sync_ab), sync_ac), sync_bc)
-        sync2d(i,j)=max(sync_abc, sync_ab, sync_bc)
-     enddo
-  enddo
+  allocate(sync2d(NH1,-JZ:JZ))
+  call sync2djs8(s,ia,ib,jstrt,nssy,nfos,icos7a,icos7b,icos7c,sync2d)
 
   red=0.
   do i=ia,ib
@@ -34,6 +34,7 @@ subroutine syncjs8d(cd0,icos,i0,delf,sync)
   endif
 
   ! Set some constants and compute the csync array.  
+  !$omp critical(syncjs8d_init)
   if( first ) then
     twopi=8.0*atan(1.0)
 
@@ -67,6 +68,7 @@ subroutine syncjs8d(cd0,icos,i0,delf,sync)
     enddo
     first=.false.
   endif
+  !$omp end critical(syncjs8d_init)
 
   ! compute the ctwk samples at the delta frequency to by used to detect peaks
   ! at frequencies +/- delf so we can align the decoder for the best possible
@@ -2,12 +2,18 @@ module js8e_module
     include 'js8/js8_params.f90'
     include 'js8/js8e_params.f90'
 
+    ! long downsample FFTs computed, and skipped because the audio had
+    ! not changed, since the decoder last cleared them
+    integer :: nlongfft=0, nlongreused=0
+
 contains
     include 'js8/baselinejs8.f90'
     include 'js8/syncjs8.f90'
+    include 'js8/sync2djs8.f90'
     include 'js8/js8_downsample.f90'
     include 'js8/syncjs8d.f90'
     include 'js8/genjs8refsig.f90'
     include 'js8/subtractjs8.f90'
     include 'js8/js8dec.f90'
+    include 'js8/js8_plans.f90'
 end module js8e_module
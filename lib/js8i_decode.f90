@@ -2,6 +2,8 @@ module js8i_decode
 
   type :: js8i_decoder
      procedure(js8i_decode_callback), pointer :: callback
+     real :: tsync=0., tdecode=0.  !Seconds in syncjs8 and js8dec, last decode
+     integer :: nfft=0, nfftreused=0 !Long FFTs computed and reused, last decode
    contains
      procedure :: decode
   end type js8i_decoder
@@ -23,13 +25,14 @@ module js8i_decode
 
 contains
 
-  subroutine decode(this,callback,iwave,nQSOProgress,nfqso,nftx,newdat,  &
+  subroutine decode(this,callback,id2,win,nQSOProgress,nfqso,nftx,newdat,  &
        nutc,nfa,nfb,nexp_decode,ndepth,nagain,lft8apon,lapcqonly,napwid, &
        mycall12,mygrid6,hiscall12,hisgrid6,syncStats)
 !    use wavhdr
     use timer_module, only: timer
 !    type(hdr) h
     use js8i_module
+    use ring_window, only: window, read_window
 
     class(js8i_decoder), intent(inout) :: this
     procedure(js8i_decode_callback) :: callback
@@ -41,20 +44,34 @@ contains
     logical newdat,lsubtract,ldupe,bcontest,syncStats
     character*12 mycall12, hiscall12
     character*6 mygrid6,hisgrid6
-    integer*2 iwave(NMAX)
+    integer*2 id2(*)
+    type(window), intent(in) :: win
     integer apsym(KK)
+    ! per candidate results of a pass, merged in candidate order
+    real csync(NMAXCAND),cf1(NMAXCAND),cxdt(NMAXCAND),cxsnr(NMAXCAND),cdmin(NMAXCAND)
+    integer nharderrors(NMAXCAND),nbadcrc(NMAXCAND),ciaptype(NMAXCAND)
+    integer citone(NN,NMAXCAND)
+    character*37 cmsg37(NMAXCAND)
     character datetime*13,message*22,msg37*37
     character*22 allmessages(100)
     integer allsnrs(100)
+    integer*8 c0,c1,clkrate
+    integer npos
     save s,dd
+    include 'timer_common.inc'
 
     icos=int(NCOSTAS)
     bcontest=iand(nexp_decode,128).ne.0
     this%callback => callback
+    this%tsync=0.
+    this%tdecode=0.
+    nlongfft=0
+    nlongreused=0
     write(datetime,1001) nutc        !### TEMPORARY ###
 1001 format("000000_",i6.6)
 
-    dd=iwave
+    call read_window(win,id2,dd,NMAX)
+    newdat=.true.           !js8_downsample checks whether dd really changed
     ndecodes=0
     allmessages='                      '
     allsnrs=0
@@ -75,7 +92,6 @@ contains
     if(ndepth.ge.3) npass=4
 
     do ipass=1,npass
-      newdat=.true.  ! Is this a problem? I hijacked newdat.
       syncmin=ASYNCMIN
       if(ipass.eq.1) then
         lsubtract=.true.
@@ -98,56 +114,89 @@ contains
         flush(6)
       endif
 
+      call system_clock(c0,clkrate)
       call timer('syncjs8 ',0)
-      call syncjs8(dd,icos,ifa,ifb,syncmin,nfqso,s,candidate,ncand,sbase)
+      ! only the first pass searches the window as read, later passes
+      ! search what is left of it after subtraction
+      npos=-1
+      if(ipass.eq.1) npos=win%pos
+      call syncjs8(dd,npos,win%sz,icos,ifa,ifb,syncmin,nfqso,s,candidate,ncand,sbase)
       call timer('syncjs8 ',1)
+      call system_clock(c1)
+      this%tsync=this%tsync+real(c1-c0)/clkrate
+      c0=c1
 
       if(NWRITELOG.eq.1) then
         write(*,*) '<DecodeDebug>', ncand, "candidates"
         flush(6)
       endif
 
+      ! Demodulate every candidate of this pass against the same dd. The
+      ! long FFT they are downsampled from is taken here, once, so the
+      ! candidates only read dd and that FFT, and are farmed out across threads.
+      ! Dedupe, callbacks and subtraction happen in the merge below, in
+      ! candidate order, which keeps the results identical to a serial run.
+      call js8_downsample(dd,newdat)
+      !$omp parallel do if(ncand.gt.1) schedule(dynamic,1) default(shared) &
+      !$omp    private(icand,xbase,iappass,iera) copyin(/timer_private/)
       do icand=1,ncand
-        sync=candidate(3,icand)
-        f1=candidate(1,icand)
-        xdt=candidate(2,icand)
-        xbase=10.0**(0.1*(sbase(nint(f1/(12000.0/NFFT1)))-36.0)) ! 3.125Hz
+        csync(icand)=candidate(3,icand)
+        cf1(icand)=candidate(1,icand)
+        cxdt(icand)=candidate(2,icand)
+        xbase=10.0**(0.1*(sbase(nint(cf1(icand)/(12000.0/NFFT1)))-36.0)) ! 3.125Hz
 
         if(NWRITELOG.eq.1) then
-          write(*,*) '<DecodeDebug> candidate', icand, 'f1', f1, 'sync', sync, 'xdt', xdt, 'xbase', xbase
+          write(*,*) '<DecodeDebug> candidate', icand, 'f1', cf1(icand), 'sync', csync(icand), 'xdt', cxdt(icand), 'xbase', xbase
           flush(6)
         endif
 
         call timer('js8dec  ',0)
-        call js8dec(dd,icos,newdat,syncStats,nQSOProgress,nfqso,nftx,ndepth,lft8apon,       &
-             lapcqonly,napwid,lsubtract,nagain,iaptype,mycall12,mygrid6,   &
-             hiscall12,bcontest,sync,f1,xdt,xbase,apsym,nharderrors,dmin,  &
-             nbadcrc,iappass,iera,msg37,xsnr)
-        message=msg37(1:22)   !###
-        nsnr=nint(xsnr) 
-        xdt=xdt-ASTART
-        hd=nharderrors+dmin
+        call js8dec(dd,icos,newdat,syncStats,nQSOProgress,nfqso,nftx,ndepth,lft8apon,   &
+             lapcqonly,napwid,nagain,ciaptype(icand),mycall12,mygrid6,hiscall12,      &
+             bcontest,csync(icand),cf1(icand),cxdt(icand),xbase,apsym,                &
+             nharderrors(icand),cdmin(icand),nbadcrc(icand),iappass,iera,             &
+             cmsg37(icand),cxsnr(icand),citone(1,icand))
+        call timer('js8dec  ',1)
 
         if(NWRITELOG.eq.1) then
-          write(*,*) '<DecodeDebug> candidate', icand, 'hard', hd, 'nbadcrc', nbadcrc
+          write(*,*) '<DecodeDebug> candidate', icand, 'hard', nharderrors(icand)+cdmin(icand), 'nbadcrc', nbadcrc(icand)
           flush(6)
         endif
-        
-        call timer('js8dec  ',1)
-        if(nbadcrc.eq.0) then
-           ldupe=.false.
-           do id=1,ndecodes
-              if(message.eq.allmessages(id).and.nsnr.le.allsnrs(id)) ldupe=.true.
-           enddo
-           if(.not.ldupe) then
-              ndecodes=ndecodes+1
-              allmessages(ndecodes)=message
-              allsnrs(ndecodes)=nsnr
-           endif
-           if(.not.ldupe .and. associated(this%callback)) then
-              qual=1.0-(nharderrors+dmin)/60.0 ! scale qual to [0.0,1.0]
-              call this%callback(sync,nsnr,xdt,f1,msg37,iaptype,qual)
+      enddo
+      !$omp end parallel do
+      call system_clock(c1)
+      this%tdecode=this%tdecode+real(c1-c0)/clkrate
+
+      do icand=1,ncand
+        if(nbadcrc(icand).ne.0) cycle
+
+        if(lsubtract) then
+           if(NWRITELOG.eq.1) then
+              write(*,*) '<DecodeDebug> subtract', cf1(icand), cxdt(icand), citone(:,icand)
+              flush(6)
            endif
+           call timer('sub_js8 ',0)
+           call subtractjs8(dd,citone(1,icand),cf1(icand),cxdt(icand))
+           call timer('sub_js8 ',1)
+           newdat=.true.
+        endif
+
+        msg37=cmsg37(icand)
+        message=msg37(1:22)   !###
+        nsnr=nint(cxsnr(icand))
+        xdt=cxdt(icand)-ASTART
+        ldupe=.false.
+        do id=1,ndecodes
+           if(message.eq.allmessages(id).and.nsnr.le.allsnrs(id)) ldupe=.true.
+        enddo
+        if(.not.ldupe) then
+           ndecodes=ndecodes+1
+           allmessages(ndecodes)=message
+           allsnrs(ndecodes)=nsnr
+        endif
+        if(.not.ldupe .and. associated(this%callback)) then
+           qual=1.0-(nharderrors(icand)+cdmin(icand))/60.0 ! scale qual to [0.0,1.0]
+           call this%callback(csync(icand),nsnr,xdt,cf1(icand),msg37,ciaptype(icand),qual)
         endif
 
         if(NWRITELOG.eq.1) then
@@ -156,6 +205,8 @@ contains
         endif
       enddo
   enddo
+  this%nfft=nlongfft
+  this%nfftreused=nlongreused
   return
   end subroutine decode
 
@@ -10,9 +10,20 @@ program jt9
   use timer_module, only: timer
   use timer_impl, only: init_timer, fini_timer
   use readwav
+  use decoder_engine, only: decode_event, new_event, set_event_sink, sink_active, &
+       sink_event, DECODE_PLANNED
 
   include 'jt9com.f90'
 
+  interface
+     subroutine decode_event_pipe (context, event) bind(C, name='decode_event_pipe')
+       use, intrinsic :: iso_c_binding, only: c_ptr
+       import decode_event
+       type(c_ptr), value :: context
+       type(decode_event), intent(in) :: event
+     end subroutine decode_event_pipe
+  end interface
+
   integer(C_INT) iret
   type(wav_header) wav
   character c
@@ -22,7 +33,9 @@ program jt9
   integer :: arglen,stat,offset,remain,mode=0,flow=200,          &
        fhigh=4000,nrxfreq=1500,ntrperiod=1,ndepth=1,nexp_decode=0
   logical :: read_files = .true., tx9 = .false., display_help = .false., syncStats = .false.
-  type (option) :: long_options(22) = [ &
+  logical :: binary_events = .false.
+  type(decode_event) :: event
+  type (option) :: long_options(24) = [ &
     option ('help', .false., 'h', 'Display this help message', ''),          &
     option ('shmem',.true.,'s','Use shared memory for sample data','KEY'),   &
     option ('tr-period', .true., 'p', 'Tx/Rx period, default MINUTES=1',     &
@@ -47,10 +60,15 @@ program jt9
     option ('fft-threads', .true., 'm',                                      &
         'Number of threads to process large FFTs, default THREADS=1',        &
         'THREADS'),                                                          &
+    option ('decoder-threads', .true., 'j',                                  &
+        'Number of submodes decoded in parallel, default THREADS=0 (all)',   &
+        'THREADS'),                                                          &
     !option ('jt65', .false., '6', 'JT65 mode', ''),                          &
     !option ('jt9', .false., '9', 'JT9 mode', ''),                            &
     option ('js8', .false., '8', 'JS8 mode', ''),                            &
     option ('syncStats', .false., 'y', 'Sync only', ''),                            &
+    option ('binary-events', .false., 'B',                                   &
+        'Write decoder output as binary event records', ''),                 &
     !option ('jt4', .false., '4', 'JT4 mode', ''),                            &
     !option ('qra64', .false., 'q', 'QRA64 mode', ''),                        &
     option ('sub-mode', .true., 'b', 'Sub mode, default SUBMODE=A', 'A'),    &
@@ -76,7 +94,7 @@ program jt9
   nsubmode = 0
 
   do
-     call getopt('hs:e:a:b:r:m:p:d:f:w:t:9864qTL:S:H:c:G:x:g:X:',      &
+     call getopt('hs:e:a:b:r:m:j:p:d:f:w:t:9864qBTL:S:H:c:G:x:g:X:',     &
           long_options,c,optarg,arglen,stat,offset,remain,.true.)
      if (stat .ne. 0) then
         exit
@@ -97,6 +115,8 @@ program jt9
            temp_dir = optarg(:arglen)
         case ('m')
            read (optarg(:arglen), *) nthreads
+        case ('j')
+           read (optarg(:arglen), *) ndecthreads
         case ('p')
            read (optarg(:arglen), *) ntrperiod
         case ('d')
@@ -119,6 +139,8 @@ program jt9
            mode = 8
         case ('y')
            syncStats = .true.
+        case ('B')
+           binary_events = .true.
         case ('T')
            tx9 = .true.
         case ('w')
@@ -143,7 +165,7 @@ program jt9
      print *, 'Usage: js8 [OPTIONS] file1 [file2 ...]'
      print *, '       Reads data from *.wav files.'
      print *, ''
-     print *, '       js8 -s <key> [-w patience] [-m threads] [-e path] [-a path] [-t path]'
+     print *, '       js8 -s <key> [-w patience] [-m threads] [-j threads] [-e path] [-a path] [-t path]'
      print *, '       Gets data from shared memory region with key==<key>'
      print *, ''
      print *, 'OPTIONS:'
@@ -171,6 +193,21 @@ program jt9
   numfano=0
 
   if (.not. read_files) then
+! Decoder output as framed binary records instead of lines of text
+     if(binary_events) call set_event_sink(c_null_ptr,c_funloc(decode_event_pipe))
+
+! Plan the decoder's FFTs while js8call readies the first decode cycle,
+! a decoder restarted mid session is otherwise slow on its first decodes
+     call decoder_plans(wisfile,tplan)
+     if(sink_active()) then
+        event=new_event(DECODE_PLANNED,-1)
+        event%tslot=tplan
+        call sink_event(event)
+     else
+        write(*,1010) tplan
+1010    format('<DecodePlans>',f9.4)
+        call flush(6)
+     endif
      call jt9a()          !We're running under control of WSJT-X
      go to 999
   endif
@@ -1,4 +1,5 @@
 MODULE prog_args
   CHARACTER(len=80) :: shm_key
   CHARACTER(len=500) :: exe_dir = '.', data_dir = '.', temp_dir = '.'
+  INTEGER :: ndecthreads = 0    ! submode decoder threads, 0 ==> one per submode
 END MODULE prog_args
@@ -0,0 +1,54 @@
+module ring_window
+  !
+  ! A window of (pos, sz) frames over the circular sample buffer the
+  ! Detector writes (dec_data%id2). A window that runs off the end of
+  ! the buffer wraps to its start, so it is made up of at most two
+  ! contiguous spans:
+  !
+  !   id2(i1+1:i1+n1) followed by id2(1:n2)
+  !
+  ! Decoders read their window straight out of the ring buffer with
+  ! read_window, which does the int16 to float conversion in the same
+  ! pass, rather than each working from a full size copy.
+  !
+  implicit none
+
+  type :: window
+     integer :: pos=0            ! first frame, 0 based
+     integer :: sz=0             ! number of frames
+     integer :: i1=0, n1=0       ! first span
+     integer :: n2=0             ! second span, from the start of the buffer
+  end type window
+
+  public :: window, new_window, read_window
+
+contains
+
+  function new_window (pos, sz, nring) result(w)
+    integer, intent(in) :: pos, sz, nring
+    type(window) :: w
+
+    w%pos=modulo(max(0,pos),nring)
+    w%sz=min(max(0,sz),nring)
+    w%i1=w%pos
+    w%n1=min(w%sz,nring-w%pos)
+    w%n2=w%sz-w%n1
+  end function new_window
+
+  subroutine read_window (w, id2, dd, n)
+    ! copy the first n frames of the window into dd as float, anything
+    ! past the end of the window is zero filled
+    type(window), intent(in) :: w
+    integer*2, intent(in) :: id2(*)
+    integer, intent(in) :: n
+    real, intent(out) :: dd(n)
+    integer m1,m2
+
+    m1=min(w%n1,n)
+    m2=min(w%n2,n-m1)
+    dd(1:m1)=id2(w%i1+1:w%i1+m1)
+    if(m2.gt.0) dd(m1+1:m1+m2)=id2(1:m2)
+    if(m1+m2.lt.n) dd(m1+m2+1:n)=0.
+  end subroutine read_window
+
+end module ring_window
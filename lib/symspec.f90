@@ -1,9 +1,10 @@
-subroutine symspec(shared_data,k,k0,ja,ssum,ntrperiod,nsps,ingain,nminw,pxdb,s,   &
+subroutine symspec(shared_data,k,korigin,k0,ja,ssum,ntrperiod,nsps,ingain,nminw,pxdb,s,   &
      df3,ihsym,npts8,pxdbmax)
 
 ! Input:
 !  shared_data  pointer to the most recent new data
 !  k            frames in that data
+!  korigin      index in the id2 ring of the first of them, 0 based
 !  k0           the last k observed
 !  ntrperiod    T/R sequence length, minutes
 !  nsps         samples per symbol, at 12000 Hz
@@ -62,13 +63,13 @@ subroutine symspec(shared_data,k,k0,ja,ssum,ntrperiod,nsps,ingain,nminw,pxdb,s,
      ja=0
      ssum=0.
      ihsym=0
-     if(.not. shared_data%params%ndiskdat) shared_data%id2(k+1:)=0   !Needed to prevent "ghosts". Not sure why.
+! id2 is a ring, the samples after k are older audio still being decoded
   endif
   gain=10.0**(0.1*ingain)
   sq=0.
   pxmax=0.;
   do i=k0+1,k
-     x1=shared_data%id2(i)
+     x1=shared_data%id2(1+modulo(korigin+i-1,NMAX))
      if (abs(x1).gt.pxmax) pxmax = abs(x1);
      sq=sq + x1*x1
   enddo
@@ -85,7 +86,7 @@ subroutine symspec(shared_data,k,k0,ja,ssum,ntrperiod,nsps,ingain,nminw,pxdb,s,
      j=ja+i-(nfft3-1)
      xc(i)=0.
      if(j.ge.1 .and. j.le.NMAX) then
-         xc(i)=fac0*shared_data%id2(j)
+         xc(i)=fac0*shared_data%id2(1+modulo(korigin+j-1,NMAX))
      endif
   enddo
   ihsym=ihsym+1
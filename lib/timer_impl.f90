@@ -4,7 +4,7 @@ module timer_impl
   use timer_module, only: timer_callback
   implicit none
 
-  public :: init_timer, fini_timer
+  public :: init_timer, fini_timer, timer_note
   integer, public :: limtrace=0
 
   private
@@ -237,6 +237,23 @@ contains
     return
   end subroutine print_root
 
+  subroutine timer_note (line)
+
+    ! Append a free form line (e.g. per cycle wall clock times) to the
+    ! timer output between the call statistics dumps.
+
+    implicit none
+    character(len=*), intent(in) :: line
+
+    !$omp critical(timer)
+    if(limtrace.ge.0) then
+       write(lu,'(a)') trim(line)
+       flush(lu)
+    endif
+    !$omp end critical(timer)
+    return
+  end subroutine timer_note
+
   subroutine init_timer (filename)
     use, intrinsic :: iso_c_binding, only: c_char
     use timer_module, only: timer
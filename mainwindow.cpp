@@ -1,5 +1,6 @@
 //---------------------------------------------------------- MainWindow
 #include "mainwindow.h"
+#include <algorithm>
 #include <cmath>
 #include <cinttypes>
 #include <limits>
@@ -63,9 +64,11 @@
 #include "SelfDestructMessageBox.h"
 #include "messagereplydialog.h"
 #include "DriftingDateTime.h"
+#include "DecodeTrace.h"
 #include "jsc.h"
 #include "jsc_checker.h"
 #include "Inbox.h"
+#include "HeardStore.h"
 #include "messagewindow.h"
 #include "NotificationAudio.h"
 
@@ -78,7 +81,7 @@
 
 extern "C" {
   //----------------------------------------------------- C and Fortran routines
-  void symspec_(struct dec_data *, int* k, int* k0, int *ja, float ssum[], int* ntrperiod, int* nsps, int* ingain,
+  void symspec_(struct dec_data *, int* k, int* korigin, int* k0, int *ja, float ssum[], int* ntrperiod, int* nsps, int* ingain,
                 int* minw, float* px, float s[], float* df3, int* nhsym, int* npts8,
                 float *m_pxmax);
 
@@ -102,6 +105,8 @@ extern "C" {
 
   void wav12_(short d2[], short d1[], int* nbytes, short* nbitsam2);
 
+  void four2a_plan_(int *nfft, int *isign, int *iform);
+
   void refspectrum_(short int d2[], bool* bclearrefspec,
                     bool* brefspec, bool* buseref, const char* c_fname, fortran_charlen_t);
 
@@ -207,6 +212,111 @@ namespace
       }
   }
 
+  // set a cell, reusing the item already there so that only the cells
+  // whose text, tooltip etc. actually changed are repainted
+  QTableWidgetItem *setTableItem(QTableWidget *widget, int row, int col, QString const &text,
+                                 QVariant const &data=QVariant(), QString const &toolTip=QString(),
+                                 Qt::Alignment alignment=Qt::AlignLeft | Qt::AlignVCenter){
+      auto item = widget->item(row, col);
+      if(!item){
+          item = new QTableWidgetItem();
+          widget->setItem(row, col, item);
+      }
+      if(item->text() != text){
+          item->setText(text);
+      }
+      if(item->data(Qt::UserRole) != data){
+          item->setData(Qt::UserRole, data);
+      }
+      if(item->toolTip() != toolTip){
+          item->setToolTip(toolTip);
+      }
+      if(item->textAlignment() != int(alignment)){
+          item->setTextAlignment(alignment);
+      }
+      return item;
+  }
+
+  void setTableRowBackground(QTableWidget *widget, int row, QBrush const &brush){
+      for(int i = 0; i < widget->columnCount(); i++){
+          auto item = widget->item(row, i);
+          if(item && item->background() != brush){
+              item->setBackground(brush);
+          }
+      }
+  }
+
+  // the contents a row was last written from are kept on its first item,
+  // so a row whose contents haven't changed is not written again
+  int const TableRowSignatureRole = Qt::UserRole + 1;
+
+  bool isTableRowCurrent(QTableWidget *widget, int row, QString const &signature){
+      auto item = widget->item(row, 0);
+      return item && item->data(TableRowSignatureRole).toString() == signature;
+  }
+
+  void setTableRowSignature(QTableWidget *widget, int row, QString const &signature){
+      auto item = widget->item(row, 0);
+      if(item){
+          item->setData(TableRowSignatureRole, signature);
+      }
+  }
+
+  // set the font of every item, skipping the ones that already have it
+  void setTableFonts(QTableWidget *widget, QFont const &font, QFont const &boldFont, int boldColumn=-1, QString const &boldText=QString()){
+      for(int row = 0; row < widget->rowCount(); row++){
+          auto boldItem = boldColumn < 0 ? nullptr : widget->item(row, boldColumn);
+          bool bold = boldItem && boldItem->text() == boldText;
+          for(int col = 0; col < widget->columnCount(); col++){
+              auto item = widget->item(row, col);
+              if(item && item->font() != (bold ? boldFont : font)){
+                  item->setFont(bold ? boldFont : font);
+              }
+          }
+      }
+  }
+
+  void setTableStyle(QTableWidget *widget, QColor const &background, QColor const &highlight, QColor const &foreground){
+      auto style = QString("QTableWidget { background:%1; selection-background-color:%2; alternate-background-color:%1; color:%3; } "
+                           "QTableWidget::item:selected { background-color: %2; color: %3; }");
+      style = style.arg(background.name());
+      style = style.arg(highlight.name());
+      style = style.arg(foreground.name());
+      if(widget->styleSheet() != style){
+          widget->setStyleSheet(style);
+      }
+
+      // the palette for an inactive selected row
+      auto p = widget->palette();
+      p.setColor(QPalette::Highlight, highlight);
+      p.setColor(QPalette::HighlightedText, foreground);
+      p.setColor(QPalette::Inactive, QPalette::Highlight, p.color(QPalette::Active, QPalette::Highlight));
+      if(p != widget->palette()){
+          widget->setPalette(p);
+      }
+  }
+
+  // select a row (-1 for none) before the others are deselected, so the
+  // selection is never empty in between while the row stays selected,
+  // then drop the rows past rowCount
+  void setTableRows(QTableWidget *widget, int rowCount, int selectedRow){
+      for(int pass = 0; pass < 2; pass++){
+          for(int row = 0; row < widget->rowCount(); row++){
+              bool selected = (row == selectedRow);
+              if(selected != (pass == 0)){
+                  continue;
+              }
+              for(int col = 0; col < widget->columnCount(); col++){
+                  auto item = widget->item(row, col);
+                  if(item && item->isSelected() != selected){
+                      item->setSelected(selected);
+                  }
+              }
+          }
+      }
+      widget->setRowCount(rowCount);
+  }
+
 #if 0
   int round(int numToRound, int multiple)
   {
@@ -235,16 +345,6 @@ namespace
    int roundDown = ( (int) (numToRound) / multiple) * multiple;
    return roundDown + multiple;
   }
-
-  template<typename T>
-  QList<T> listCopyReverse(QList<T> const &list){
-      QList<T> newList = QList<T>();
-      auto iter = list.end();
-      while(iter != list.begin()){
-          newList.append(*(--iter));
-      }
-      return newList;
-  }
 }
 
 //--------------------------------------------------- MainWindow constructor
@@ -402,6 +502,7 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
       },
   m_sfx {"P",  "0",  "1",  "2",  "3",  "4",  "5",  "6",  "7",  "8",  "9",  "A"},
   mem_js8 {shdmem},
+  m_logBookGeneration {0},
   m_msAudioOutputBuffered (0u),
   m_framesAudioInputBuffered (RX_SAMPLE_RATE / 10),
   m_downSampleFactor (downSampleFactor),
@@ -442,7 +543,8 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
   m_cqInterval {0},
   m_cqPaused { false },
   m_driftMsMMA { 0 },
-  m_driftMsMMA_N { 0 }
+  m_driftMsMMA_N { 0 },
+  m_decodeSyncStart { -1 }
 {
   ui->setupUi(this);
 
@@ -473,6 +575,10 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
   // notification audio operates in its own thread at a lower priority
   m_notification->moveToThread(&m_notificationAudioThread);
 
+  // frames of the text being typed are counted in their own thread at a lower priority
+  m_buildFramesWorker = new BuildMessageFramesWorker;
+  m_buildFramesWorker->moveToThread(&m_buildFramesThread);
+
   // move the aprs client and the message server to its own network thread at a lower priority
   m_aprsClient->moveToThread(&m_networkThread);
   m_messageServer->moveToThread(&m_networkThread);
@@ -510,6 +616,10 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
   connect (this, &MainWindow::playNotification, m_notification, &NotificationAudio::play);
   connect (&m_notificationAudioThread, &QThread::finished, m_notification, &QObject::deleteLater);
 
+  // hook up the frame count of the text being typed and disposal
+  connect (m_buildFramesWorker, &BuildMessageFramesWorker::resultReady, this, &MainWindow::textFramesBuilt);
+  connect (&m_buildFramesThread, &QThread::finished, m_buildFramesWorker, &QObject::deleteLater);
+
   // hook up Modulator slots and disposal
   connect (this, &MainWindow::transmitFrequency, m_modulator, &Modulator::setFrequency);
   connect (this, &MainWindow::endTransmitMessage, m_modulator, &Modulator::stop);
@@ -531,6 +641,11 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
   // hook up the detector signals, slots and disposal
   connect (this, &MainWindow::FFTSize, m_detector, &Detector::setBlockSize);
   connect(m_detector, &Detector::framesWritten, this, &MainWindow::dataSink);
+  connect(m_detector, &Detector::clearRequested, this, [this](qint64 sequence){
+      // off the audio thread, and serialized with the other users of dec_data
+      QMutexLocker mutex(m_detector->getMutex());
+      m_detector->clearContent(sequence);
+  });
   connect (&m_audioThread, &QThread::finished, m_detector, &QObject::deleteLater);
 
   // setup the waterfall
@@ -551,6 +666,8 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
   //connect (&m_decodeThread, &QThread::finished, m_notification, &QObject::deleteLater);
   //connect(this, &MainWindow::decodedLineReady, this, &MainWindow::processDecodedLine);
   connect(&m_decoder, &Decoder::ready, this, &MainWindow::processDecodedLine);
+  connect(&m_decoder, &Decoder::events, this, &MainWindow::processDecodeEvents);
+  connect(&m_decoderEngine, &DecoderEngine::decodeEvents, this, &MainWindow::processDecodeEvents);
   connect(&m_decoder, &Decoder::error, this, [this](int errorCode, QString errorString){
     subProcessError(m_decoder.program(), m_decoder.arguments(), errorCode, errorString);
   });
@@ -629,12 +746,10 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
      setTextEditStyle(ui->extFreeTextMsgEdit, m_config.color_compose_foreground(), m_config.color_compose_background(), m_config.compose_text_font());
      ui->extFreeTextMsgEdit->setFont(m_config.compose_text_font(), m_config.color_compose_foreground(), m_config.color_compose_background());
 
-     // rehighlight
+     // rehighlight, a block at a time (a block wraps over many lines)
      auto d = ui->textEditRX->document();
      if(d){
-         for(int i = 0; i < d->lineCount(); i++){
-             auto b = d->findBlockByLineNumber(i);
-
+         for(auto b = d->begin(); b != d->end(); b = b.next()){
              switch(b.userState()){
              case STATE_RX:
                  highlightBlock(b, m_config.rx_text_font(), m_config.color_rx_foreground(), QColor(Qt::transparent));
@@ -824,11 +939,22 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
   ui->decodedTextLabel2->setText(t);
 
   displayDialFrequency();
+
+  m_heardStore.reset(new HeardStore(heardPath()));
+  if(!m_heardStore->open()){
+      if(JS8_DEBUG_DECODE) qDebug() << "heard store could not be opened:" << m_heardStore->error();
+  }
+
+  // sightings are queued by the store and committed together every few seconds
+  connect(&m_heardStoreFlush, &QTimer::timeout, this, [this](){ m_heardStore->flush(); });
+  m_heardStoreFlush.start(5000);
+
   readSettings();            //Restore user's setup params
 
   m_networkThread.start(m_networkThreadPriority);
   m_audioThread.start (m_audioThreadPriority);
   m_notificationAudioThread.start(m_notificationAudioThreadPriority);
+  m_buildFramesThread.start(QThread::LowPriority);
   m_decoder.start(m_decoderThreadPriority);
 
 #ifdef WIN32
@@ -846,12 +972,21 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
     }
 #endif
 
-  initDecoderSubprocess();
-
+  // the wisdom must be in before the in process decoder starts planning
   QString fname {QDir::toNativeSeparators(m_config.writeable_data_dir ().absoluteFilePath ("wsjtx_wisdom.dat"))};
   QByteArray cfname=fname.toLocal8Bit();
   fftwf_import_wisdom_from_filename(cfname);
 
+  // symspec's FFT, the decoder plans its own as it starts
+  {
+    int nfft {16384};
+    int isign {-1};
+    int iform {0};
+    four2a_plan_(&nfft, &isign, &iform);
+  }
+
+  initDecoderSubprocess();
+
   m_ntx = 6;
   ui->txrb6->setChecked(true);
 
@@ -1617,6 +1752,8 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
   m_txTextDirtyDebounce.setSingleShot(true);
   connect(&m_txTextDirtyDebounce, &QTimer::timeout, this, &MainWindow::refreshTextDisplay);
 
+  m_checker = new JSCChecker(this);
+
   QTimer::singleShot(500, this, &MainWindow::initializeDummyData);
 
   // this must be the last statement of constructor
@@ -1624,6 +1761,26 @@ MainWindow::MainWindow(QDir const& temp_directory, bool multiple,
 }
 
 void MainWindow::initDecoderSubprocess(){
+    // the in process decoder runs on its own thread, there is no
+    // subprocess, shared memory or lock file handshake to set up
+    if(m_decoderInProcess){
+        m_decoderEngine.setThreads(m_decoderThreads);
+        m_decoderEngine.setPatience(1);
+        m_decoderEngine.setWisdomFile(QDir::toNativeSeparators(m_config.writeable_data_dir ().absoluteFilePath ("wsjtx_wisdom.dat")));
+        if(!m_decoderEngine.isRunning()){
+            m_decoderEngine.start(m_decoderThreadPriority);
+        }
+
+        if(m_decoderBusy){
+            decodeBusy(false);
+        }
+
+        if(!m_valid){
+            m_valid = true;
+        }
+        return;
+    }
+
     //delete any .quit file that might have been left lying around
     //since its presence will cause jt9 to exit a soon as we start it
     //and decodes will hang
@@ -1663,6 +1820,13 @@ void MainWindow::initDecoderSubprocess(){
         // mode decoder in parallel.
         , "-m", QString::number (qMin (qMax (QThread::idealThreadCount () - 1, 1), 3)) //FFTW threads
 
+        // The number of submodes the decoder works on in parallel,
+        // zero lets it use one thread for each submode being decoded.
+        , "-j", QString::number (qMax (m_decoderThreads, 0)) //decoder threads
+
+        // typed event records instead of text lines to parse
+        , "-B"
+
         , "-e", QDir::toNativeSeparators (m_appDir)
         , "-a", QDir::toNativeSeparators (m_config.writeable_data_dir ().absolutePath ())
         , "-t", QDir::toNativeSeparators (m_config.temp_dir ().absolutePath ())
@@ -1779,7 +1943,7 @@ void MainWindow::initializeDummyData(){
     foreach(CodewordPair p, JSC::compress("")){
         all.append(p.first);
     }
-    qDebug() << all;
+    qDebug() << Varicode::bitsToStr(all);
     qDebug() << JSC::decompress(all) << (JSC::decompress(all) == "HELLO WORLD ");
     exit(-1);
 #endif
@@ -2205,9 +2369,15 @@ MainWindow::~MainWindow()
   m_notificationAudioThread.quit();
   m_notificationAudioThread.wait();
 
+  m_buildFramesWorker->cancel();
+  m_buildFramesThread.quit();
+  m_buildFramesThread.wait();
+
   m_decoder.quit();
   m_decoder.wait();
 
+  m_decoderEngine.stop();
+
   remove_child_from_event_filter (this);
 }
 
@@ -2245,6 +2415,8 @@ void MainWindow::writeSettings()
   m_settings->setValue("SaveDecoded",ui->actionSave_decoded->isChecked());
   m_settings->setValue("SaveAll",ui->actionSave_all->isChecked());
   m_settings->setValue("NDepth",m_ndepth);
+  m_settings->setValue("DecoderThreads",m_decoderThreads);
+  m_settings->setValue("DecoderInProcess",m_decoderInProcess);
   m_settings->setValue("RxFreq",ui->RxFreqSpinBox->value());
   m_settings->setValue("TxFreq",ui->TxFreqSpinBox->value());
   m_settings->setValue("WSPRfreq",ui->WSPRfreqSpinBox->value());
@@ -2426,6 +2598,8 @@ void MainWindow::readSettings()
   ui->TxFreqSpinBox->setValue(0); // ensure a change is signaled
   ui->TxFreqSpinBox->setValue(m_settings->value("TxFreq",1500).toInt());
   m_ndepth=m_settings->value("NDepth",3).toInt();
+  m_decoderThreads=m_settings->value("DecoderThreads",0).toInt(); // 0 ==> one per submode
+  m_decoderInProcess=m_settings->value("DecoderInProcess",false).toBool();
   m_pctx=m_settings->value("PctTx",20).toInt();
   m_dBm=m_settings->value("dBm",37).toInt();
   ui->WSPR_prefer_type_1_check_box->setChecked (m_settings->value ("WSPRPreferType1", true).toBool ());
@@ -2701,9 +2875,27 @@ void MainWindow::dataSink(qint64 frames)
     static float s[NSMAX];
     char line[80];
 
+    // time the frames spent queued to the gui thread
+    auto framesWrittenAt = m_detector->framesWrittenAt();
+    if(framesWrittenAt >= 0){
+        DecodeTrace::record("audio", DecodeTrace::now() - framesWrittenAt);
+    }
+
+    // k counts the samples of the period, ka is where the last of them
+    // is in the ring and korigin where the first, live audio is taken
+    // from the detector's latest position rather than the one that was
+    // signalled
     int k (frames);
+    int ka (frames);
+    int korigin (0);
+    if(!m_diskData){
+        auto pos = m_detector->position();
+        k = pos.kin();
+        ka = pos.head();
+        korigin = pos.origin;
+    }
     if(k0 == 999999999){
-        m_ihsym = int((float)frames/(float)m_nsps)*2;
+        m_ihsym = int((float)k/(float)m_nsps)*2;
         ja = k;
         k0 = k;
     }
@@ -2717,7 +2909,7 @@ void MainWindow::dataSink(qint64 frames)
     int len=fname.length();
 
     m_bUseRef=m_wideGraph->useRef();
-    refspectrum_(&dec_data.d2[k-m_nsps/2],&m_bClearRefSpec,&m_bRefSpec,
+    refspectrum_(&dec_data.d2[(ka-m_nsps/2+Detector::ring_size)%Detector::ring_size],&m_bClearRefSpec,&m_bRefSpec,
         &m_bUseRef,c_fname,len);
     m_bClearRefSpec=false;
 #endif
@@ -2741,7 +2933,9 @@ void MainWindow::dataSink(qint64 frames)
     k0 = k;
     int ihs = m_ihsym;
     dec_data.params.kpos = computeCycleStartForDecode(computeCurrentCycle(m_TRperiod), m_TRperiod);
-    symspec_(&dec_data,&k,&k0,&trmin,&nsps,&m_inGain,&nsmo,&m_px,s,&m_df3,&ihs,&m_npts8,&m_pxmax);
+    qint64 spectrumStart = DecodeTrace::now();
+    symspec_(&dec_data,&k,&korigin,&k0,&trmin,&nsps,&m_inGain,&nsmo,&m_px,s,&m_df3,&ihs,&m_npts8,&m_pxmax);
+    DecodeTrace::record("spectrum", DecodeTrace::now() - spectrumStart);
     // 3) if symspec wants ihs to be 0, set it.
     if(ihs == 0){
         m_ihsym = ihs;
@@ -2774,7 +2968,9 @@ void MainWindow::dataSink(qint64 frames)
     m_ihsym = m_ihsym%(m_TRperiod*RX_SAMPLE_RATE/m_nsps*2);
 
     // compute the symbol spectra for the waterfall display
-    symspec_(&dec_data,&k,&k0,&ja,ssum,&trmin,&nsps,&m_inGain,&nsmo,&m_px,s,&m_df3,&m_ihsym,&m_npts8,&m_pxmax);
+    qint64 spectrumStart = DecodeTrace::now();
+    symspec_(&dec_data,&k,&korigin,&k0,&ja,ssum,&trmin,&nsps,&m_inGain,&nsmo,&m_px,s,&m_df3,&m_ihsym,&m_npts8,&m_pxmax);
+    DecodeTrace::record("spectrum", DecodeTrace::now() - spectrumStart);
 
     // make sure ja is equal to k so if we jump ahead in the buffer, everything resolves correctly
     ja = k;
@@ -3516,7 +3712,15 @@ void MainWindow::updateCurrentBand(){
 
     // clear activity on startup if asked or on when the previous band is not empty
     if(m_config.reset_activity() || !m_lastBand.isEmpty()){
+        // leaving a band does not count as clearing its call activity
+        auto clearedAt = m_callActivityClearedAt.value(m_lastBand);
         clearActivity();
+        m_callActivityClearedAt[m_lastBand] = clearedAt;
+
+        // and a reset at startup starts the band's history afresh
+        if(m_lastBand.isEmpty()){
+            m_callActivityClearedAt[band_name] = DriftingDateTime::currentDateTimeUtc();
+        }
     }
 
     // only change this when necessary as we get called a lot and it
@@ -4352,6 +4556,7 @@ bool MainWindow::decodeEnqueueReady(qint32 k, qint32 k0){
         d.submode = Varicode::JS8CallNormal;
         d.start = startA;
         d.sz = szA;
+        d.queued = DecodeTrace::now();
         m_decoderQueue.append(d);
         decodes++;
     }
@@ -4361,6 +4566,7 @@ bool MainWindow::decodeEnqueueReady(qint32 k, qint32 k0){
         d.submode = Varicode::JS8CallFast;
         d.start = startB;
         d.sz = szB;
+        d.queued = DecodeTrace::now();
         m_decoderQueue.append(d);
         decodes++;
     }
@@ -4370,6 +4576,7 @@ bool MainWindow::decodeEnqueueReady(qint32 k, qint32 k0){
         d.submode = Varicode::JS8CallTurbo;
         d.start = startC;
         d.sz = szC;
+        d.queued = DecodeTrace::now();
         m_decoderQueue.append(d);
         decodes++;
     }
@@ -4379,6 +4586,7 @@ bool MainWindow::decodeEnqueueReady(qint32 k, qint32 k0){
         d.submode = Varicode::JS8CallSlow;
         d.start = startE;
         d.sz = szE;
+        d.queued = DecodeTrace::now();
         m_decoderQueue.append(d);
         decodes++;
     }
@@ -4389,6 +4597,7 @@ bool MainWindow::decodeEnqueueReady(qint32 k, qint32 k0){
         d.submode = Varicode::JS8CallUltra;
         d.start = startI;
         d.sz = szI;
+        d.queued = DecodeTrace::now();
         m_decoderQueue.append(d);
         decodes++;
     }
@@ -4485,6 +4694,7 @@ bool MainWindow::decodeEnqueueReadyExperiment(qint32 k, qint32 /*k0*/){
                 if(d.start < 0){
                     d.start += maxSamples;
                 }
+                d.queued = DecodeTrace::now();
                 m_decoderQueue.append(d);
                 decodes++;
 
@@ -4500,6 +4710,7 @@ bool MainWindow::decodeEnqueueReadyExperiment(qint32 k, qint32 /*k0*/){
                 d.submode = submode;
                 d.start = cycle*cycleFrames;
                 d.sz = cycleFramesReady;
+                d.queued = DecodeTrace::now();
                 m_decoderQueue.append(d);
                 decodes++;
 
@@ -4557,6 +4768,13 @@ bool MainWindow::decodeProcessQueue(qint32 *pSubmode){
     // default to no submodes being decoded, then bitwise OR the modes together to decode them all at once
     dec_data.params.nsubmodes = 0;
 
+    // the queue holds positions in the period, the decoder reads the
+    // ring where they are now, data from disk starts at the beginning
+    auto pos = m_detector->position();
+    auto ringIndex = [this, pos](qint32 start){
+        return m_diskData ? start : pos.index(start);
+    };
+
     while(!m_decoderQueue.isEmpty()){
         auto params = m_decoderQueue.front();
         m_decoderQueue.removeFirst();
@@ -4566,34 +4784,37 @@ bool MainWindow::decodeProcessQueue(qint32 *pSubmode){
             continue;
         }
 
+        DecodeTrace::record(DecodeTrace::stage("queue", params.submode), DecodeTrace::now() - params.queued);
+        DecodeTrace::mark(DecodeTrace::stage("window", params.submode), params.queued);
+
         if(submode == -1 || params.submode < submode){
             submode = params.submode;
         }
 
         switch(params.submode){
         case Varicode::JS8CallNormal:
-            dec_data.params.kposA = params.start;
+            dec_data.params.kposA = ringIndex(params.start);
             dec_data.params.kszA = params.sz;
             dec_data.params.nsubmodes |= (params.submode + 1);
             break;
         case Varicode::JS8CallFast:
-            dec_data.params.kposB = params.start;
+            dec_data.params.kposB = ringIndex(params.start);
             dec_data.params.kszB = params.sz;
             dec_data.params.nsubmodes |= (params.submode << 1);
             break;
         case Varicode::JS8CallTurbo:
-            dec_data.params.kposC = params.start;
+            dec_data.params.kposC = ringIndex(params.start);
             dec_data.params.kszC = params.sz;
             dec_data.params.nsubmodes |= (params.submode << 1);
             break;
         case Varicode::JS8CallSlow:
-            dec_data.params.kposE = params.start;
+            dec_data.params.kposE = ringIndex(params.start);
             dec_data.params.kszE = params.sz;
             dec_data.params.nsubmodes |= (params.submode << 1);
             break;
 #if JS8_ENABLE_JS8I
         case Varicode::JS8CallUltra:
-            dec_data.params.kposI = params.start;
+            dec_data.params.kposI = ringIndex(params.start);
             dec_data.params.kszI = params.sz;
             dec_data.params.nsubmodes |= (params.submode << 1);
             break;
@@ -4740,14 +4961,20 @@ void MainWindow::decodeStart(){
     }
 
     QFile lock {m_config.temp_dir ().absoluteFilePath (".lock")};
-    if(!lock.exists()){
+    if(!m_decoderInProcess && !lock.exists()){
         if(JS8_DEBUG_DECODE) qDebug() << "--> decoder cannot start...busy (lock missing)";
         return;
     }
 
+    if(m_decoderInProcess && m_decoderEngine.isBusy()){
+        if(JS8_DEBUG_DECODE) qDebug() << "--> decoder cannot start...busy (engine)";
+        return;
+    }
+
     // mark the decoder busy early while we prep the memory copy
     // decodeDone is responsible for marking the decode _not_ busy
     decodeBusy(true);
+    DecodeTrace::mark("decode");
     {
         if(JS8_DEBUG_DECODE) qDebug() << "--> decoder starting";
         if(JS8_DEBUG_DECODE) qDebug() << " --> kin:" << dec_data.params.kin;
@@ -4762,6 +4989,13 @@ void MainWindow::decodeStart(){
         //newdat=1  ==> this is new data, must do the big FFT
         //nagain=1  ==> decode only at fQSO +/- Tol
 
+        // the in process decoder reads the audio where it is, only the
+        // params are copied, and is woken without a lock file
+        if(m_decoderInProcess){
+            m_decoderEngine.submit(&dec_data);
+            return;
+        }
+
         char *to = (char*)mem_js8->data();
         char *from = (char*) dec_data.ss;
         int size=sizeof(struct dec_data);
@@ -4808,8 +5042,10 @@ void MainWindow::decodeDone ()
   // critical section
   QMutexLocker mutex(m_detector->getMutex());
 
-  if(JS8_DEBUG_DECODE) qDebug() << "decoder lock create";
-  QFile {m_config.temp_dir ().absoluteFilePath (".lock")}.open(QIODevice::ReadWrite);
+  if(!m_decoderInProcess){
+    if(JS8_DEBUG_DECODE) qDebug() << "decoder lock create";
+    QFile {m_config.temp_dir ().absoluteFilePath (".lock")}.open(QIODevice::ReadWrite);
+  }
   dec_data.params.newdat=0;
   dec_data.params.nagain=0;
   dec_data.params.ndiskdat=0;
@@ -4850,9 +5086,6 @@ void MainWindow::decodePrepareSaveAudio(int submode){
 
     if(m_saveAll or m_bAltV or (m_bDecoded and m_saveDecoded)){
         m_bAltV=false;
-        // the following is potential a threading hazard - not a good
-        // idea to pass pointer to be processed in another thread
-        // TODO: use the detector mutex here to prevent threading issues
         int pos = 0;
         switch(submode){
           case Varicode::JS8CallNormal: pos = dec_data.params.kposA; break;
@@ -4861,9 +5094,26 @@ void MainWindow::decodePrepareSaveAudio(int submode){
           case Varicode::JS8CallSlow:   pos = dec_data.params.kposE; break;
           case Varicode::JS8CallUltra:  pos = dec_data.params.kposI; break;
         }
-        m_saveWAVWatcher.setFuture (QtConcurrent::run (std::bind (&MainWindow::save_wave_file,
-              this, m_fnameWE, &dec_data.d2[pos], period, m_config.my_callsign(),
-              m_config.my_grid(), m_mode, submode, m_freqNominal, m_hisCall, m_hisGrid)));
+
+        // the period may wrap around the end of the ring, so save a straight copy of it
+        int const ringSize = NTMAX*RX_SAMPLE_RATE;
+        int const frames = qMin(period*RX_SAMPLE_RATE, ringSize);
+        int const n1 = qMin(frames, ringSize - pos);
+        QVector<short> samples(frames);
+        std::copy(dec_data.d2 + pos, dec_data.d2 + pos + n1, samples.begin());
+        std::copy(dec_data.d2, dec_data.d2 + (frames - n1), samples.begin() + n1);
+
+        auto fname = m_fnameWE;
+        auto mycall = m_config.my_callsign();
+        auto mygrid = m_config.my_grid();
+        auto mode = m_mode;
+        auto freq = m_freqNominal;
+        auto hisCall = m_hisCall;
+        auto hisGrid = m_hisGrid;
+        m_saveWAVWatcher.setFuture (QtConcurrent::run ([=] {
+              return save_wave_file (fname, samples.constData (), frames / RX_SAMPLE_RATE, mycall,
+                  mygrid, mode, submode, freq, hisCall, hisGrid);
+            }));
     }
 }
 
@@ -4880,6 +5130,19 @@ void MainWindow::decodeCheckHangingDecoder(){
         return;
     }
 
+    // the in process decoder can't be killed and restarted like the
+    // subprocess, the engine finishes every cycle it runs, so if it is
+    // idle we only missed the end of one, otherwise it is still working
+    if(m_decoderInProcess){
+        if(m_decoderEngine.isBusy()){
+            if(JS8_DEBUG_DECODE) qDebug() << "--> decoder engine still busy after" << m_decoderBusyStartTime.secsTo(QDateTime::currentDateTimeUtc()) << "seconds";
+            return;
+        }
+
+        decodeBusy(false);
+        return;
+    }
+
     m_decoderBusyStartTime = QDateTime();
 
     SelfDestructMessageBox * m = new SelfDestructMessageBox(30,
@@ -4961,103 +5224,156 @@ void MainWindow::readFromStdout(QProcess * proc)                             //r
   // See MainWindow::postDecode for displaying the latest decodes
 }
 
-void MainWindow::processDecodedLine(QByteArray t){
-  if(JS8_DEBUG_DECODE) qDebug() << "JS8: " << QString(t);
-
-  bool bAvgMsg=false;
-  int navg=0;
-
-  static QList<qint32> driftQueue;
-
-  static qint32 syncStart = -1;
-  if(t.indexOf("<DecodeSyncMeta> sync start") >= 0){
-      auto segs =  QString(t.trimmed()).split(QRegExp("[\\s\\t]+"), QString::SkipEmptyParts);
-      if(segs.isEmpty()){
-          return;
-      }
+/**
+ * @brief MainWindow::processDecodeEvents
+ *        handle a batch of typed events from the decoder
+ * @param events
+ */
+void MainWindow::processDecodeEvents(QVector<decode_event> events){
+  foreach(auto const &event, events){
+    processDecodeEvent(event);
+  }
+}
 
-      auto spos = segs.at(3);
-      syncStart = spos.toInt();
-      return;
+/**
+ * @brief MainWindow::processDecodeEvent
+ *        handle a typed event from the decoder
+ * @param event
+ */
+void MainWindow::processDecodeEvent(decode_event event){
+  switch(event.kind){
+    case DECODE_STARTED:
+      decodeStarted();
+      break;
+    case DECODE_SYNC_META:
+      m_decodeSyncStart = event.start;
+      break;
+    case DECODE_SYNC_CANDIDATE:
+    case DECODE_SYNC_DECODE:
+      decodeSyncStat(event.submode, int(event.freq), int(event.sync), event.dt, event.kind == DECODE_SYNC_DECODE);
+      break;
+    case DECODE_DECODED:
+      // the line format is only used for ALL.txt
+      processDecodedText(DecodedText{event, "FT8" == m_mode && ui->cbVHFcontest->isChecked(), m_config.my_grid()},
+                         DecoderEngine::decodedLine(event));
+      break;
+    case DECODE_FINISHED:
+      decodeFinished(event.count);
+      break;
+    case DECODE_TIMING:
+      decodeTiming(event.submode, event.tslot, event.tsync, event.tdecode, event.nfft, event.nfftreused);
+      break;
+    case DECODE_PLANNED:
+      decodePlanned(event.tslot);
+      break;
   }
+}
 
-  if(t.indexOf("<DecodeSyncStat>") >= 0) {
-      auto segs =  QString(t.trimmed()).split(QRegExp("[\\s\\t]+"), QString::SkipEmptyParts);
-      if(segs.isEmpty()){
-          return;
-      }
+/**
+ * @brief MainWindow::decodeStarted
+ *        a decode cycle has started
+ */
+void MainWindow::decodeStarted(){
+  DecodeTrace::recordSince("handoff", "decode");
 
-      // only continue if we should either display decode attempts
-      if(!m_wideGraph->shouldDisplayDecodeAttempts()){
-          return;
-      }
+  if(m_wideGraph->shouldDisplayDecodeAttempts()){
+      m_wideGraph->drawHorizontalLine(QColor(Qt::yellow), 0, 5);
+  }
 
-      auto m1 = QString(segs.at(2));
-      auto m = int(m1.toInt());
+  if(JS8_DEBUG_DECODE) qDebug() << "--> busy?" << m_decoderBusy << "lock exists?" << ( QFile{m_config.temp_dir ().absoluteFilePath (".lock")}.exists());
+}
 
-      auto f1 = QString(segs.at(4));
-      auto f = int(f1.toFloat());
+/**
+ * @brief MainWindow::decodeTiming
+ *        record where the decoder spent its time on a submode
+ * @param m - submode
+ * @param tslot - seconds decoding the submode
+ * @param tsync - of which in sync detection
+ * @param tdecode - of which in demodulation and ldpc
+ * @param nfft - long downsample FFTs computed
+ * @param nfftreused - long downsample FFTs reused
+ */
+void MainWindow::decodeTiming(int m, float tslot, float tsync, float tdecode, int nfft, int nfftreused){
+  DecodeTrace::record(DecodeTrace::stage("slot", m), qint64(tslot*1e9));
+  DecodeTrace::record(DecodeTrace::stage("sync", m), qint64(tsync*1e9));
+  DecodeTrace::record(DecodeTrace::stage("decode", m), qint64(tdecode*1e9));
+  DecodeTrace::count(DecodeTrace::stage("fft", m), nfft);
+  DecodeTrace::count(DecodeTrace::stage("fftreused", m), nfftreused);
+  if(JS8_DEBUG_DECODE) qDebug() << "decoder long FFTs" << m << "computed" << nfft << "reused" << nfftreused;
+}
 
-      auto s1 = QString(segs.at(6));
-      auto s = int(s1.toFloat());
+/**
+ * @brief MainWindow::decodePlanned
+ *        the decoder has planned its FFTs and is ready for a first cycle
+ * @param tplan - seconds spent planning
+ */
+void MainWindow::decodePlanned(float tplan){
+  DecodeTrace::record("plan", qint64(tplan*1e9));
+  if(JS8_DEBUG_DECODE) qDebug() << "--> decoder FFT plans ready in" << tplan << "s";
+}
 
-      auto xdt1 = QString(segs.at(8));
-      auto xdt = xdt1.toFloat();
-      auto xdtMs = int(xdt*1000);
+/**
+ * @brief MainWindow::decodeSyncStat
+ *        draw a sync candidate (or a candidate that decoded) on the waterfall
+ * @param m - submode
+ * @param f - frequency offset
+ * @param s - sync quality
+ * @param xdt - time offset in seconds
+ * @param decoded - true if the candidate decoded
+ */
+void MainWindow::decodeSyncStat(int m, int f, int s, float xdt, bool decoded){
+  // only continue if we should either display decode attempts
+  if(!m_wideGraph->shouldDisplayDecodeAttempts()){
+      return;
+  }
 
-      // draw candidates
-      if(abs(xdtMs) <= 2000){
-          if(s < 10){
-            m_wideGraph->drawDecodeLine(QColor(Qt::darkCyan), f, f + computeBandwidthForSubmode(m));
-          } else if (s <= 15){
-            m_wideGraph->drawDecodeLine(QColor(Qt::cyan), f, f + computeBandwidthForSubmode(m));
-          } else if (s <= 21){
-            m_wideGraph->drawDecodeLine(QColor(Qt::white), f, f + computeBandwidthForSubmode(m));
-          }
-      }
+  auto xdtMs = int(xdt*1000);
 
-      if(!t.contains("decode")){
-          return;
+  // draw candidates
+  if(abs(xdtMs) <= 2000){
+      if(s < 10){
+        m_wideGraph->drawDecodeLine(QColor(Qt::darkCyan), f, f + computeBandwidthForSubmode(m));
+      } else if (s <= 15){
+        m_wideGraph->drawDecodeLine(QColor(Qt::cyan), f, f + computeBandwidthForSubmode(m));
+      } else if (s <= 21){
+        m_wideGraph->drawDecodeLine(QColor(Qt::white), f, f + computeBandwidthForSubmode(m));
       }
+  }
 
-      // draw decodes
-      m_wideGraph->drawDecodeLine(QColor(Qt::red), f, f + computeBandwidthForSubmode(m));
-
-      if(JS8_DEBUG_DECODE) qDebug() << "--> busy?" << m_decoderBusy << "lock exists?" << ( QFile{m_config.temp_dir ().absoluteFilePath (".lock")}.exists());
-
+  if(!decoded){
       return;
   }
 
-  if(t.indexOf("<DecodeStarted>") >= 0) {
-      if(m_wideGraph->shouldDisplayDecodeAttempts()){
-          m_wideGraph->drawHorizontalLine(QColor(Qt::yellow), 0, 5);
-      }
+  // draw decodes
+  m_wideGraph->drawDecodeLine(QColor(Qt::red), f, f + computeBandwidthForSubmode(m));
 
-      if(JS8_DEBUG_DECODE) qDebug() << "--> busy?" << m_decoderBusy << "lock exists?" << ( QFile{m_config.temp_dir ().absoluteFilePath (".lock")}.exists());
-      return;
-  }
+  if(JS8_DEBUG_DECODE) qDebug() << "--> busy?" << m_decoderBusy << "lock exists?" << ( QFile{m_config.temp_dir ().absoluteFilePath (".lock")}.exists());
+}
 
-  if(t.indexOf("<DecodeDebug>") >= 0) {
-      return;
-  }
+/**
+ * @brief MainWindow::decodeFinished
+ *        a decode cycle has finished, apply the drift and clean up
+ * @param ndecoded - number of decodes in the cycle
+ */
+void MainWindow::decodeFinished(int ndecoded){
+    DecodeTrace::recordSince("cycle", "decode");
 
-  if(t.indexOf("<DecodeFinished>") >= 0) {
     int msec = m_decoderBusyStartTime.msecsTo(QDateTime::currentDateTimeUtc());
     if(JS8_DEBUG_DECODE) qDebug() << "decode duration" << msec << "ms";
 
     // TODO: move this into a function
-    if(!driftQueue.isEmpty()){
+    if(!m_driftQueue.isEmpty()){
         if(m_driftMsMMA_N == 0){
             m_driftMsMMA_N = 1;
             m_driftMsMMA = DriftingDateTime::drift();
         }
 
         // let the widegraph know for timing control
-        m_wideGraph->notifyDriftedSignalsDecoded(driftQueue.count());
+        m_wideGraph->notifyDriftedSignalsDecoded(m_driftQueue.count());
 
-        while(!driftQueue.isEmpty()){
-            qint32 newDrift = driftQueue.first();
-            driftQueue.removeFirst();
+        while(!m_driftQueue.isEmpty()){
+            qint32 newDrift = m_driftQueue.first();
+            m_driftQueue.removeFirst();
 
             m_driftMsMMA = (((m_driftMsMMA_N-1) * m_driftMsMMA) + newDrift) / m_driftMsMMA_N;
             if(m_driftMsMMA_N < 60) m_driftMsMMA_N++; // cap it to 60 observations
@@ -5075,7 +5391,7 @@ void MainWindow::processDecodedLine(QByteArray t){
         //writeNoticeTextToUI(QDateTime::currentDateTimeUtc(), QString("Automatic Drift: %1").arg(driftAvg));
     }
 
-    m_bDecoded = t.mid(16).trimmed().toInt() > 0;
+    m_bDecoded = ndecoded > 0;
     int mswait=3*1000*m_TRperiod/4;
     if(!m_diskData) killFileTimer.start(mswait); //Kill in 3/4 period
     decodeDone();
@@ -5084,6 +5400,77 @@ void MainWindow::processDecodedLine(QByteArray t){
       MessageBox::information_message(this, tr("No more files to open."));
       m_bNoMoreFiles=false;
     }
+}
+
+void MainWindow::processDecodedLine(QByteArray t){
+  if(JS8_DEBUG_DECODE) qDebug() << "JS8: " << QString(t);
+
+  bool bAvgMsg=false;
+  int navg=0;
+
+  if(t.indexOf("<DecodeSyncMeta> sync start") >= 0){
+      auto segs =  QString(t.trimmed()).split(QRegExp("[\\s\\t]+"), QString::SkipEmptyParts);
+      if(segs.isEmpty()){
+          return;
+      }
+
+      auto spos = segs.at(3);
+      m_decodeSyncStart = spos.toInt();
+      return;
+  }
+
+  if(t.indexOf("<DecodeSyncStat>") >= 0) {
+      auto segs =  QString(t.trimmed()).split(QRegExp("[\\s\\t]+"), QString::SkipEmptyParts);
+      if(segs.isEmpty()){
+          return;
+      }
+
+      // only continue if we should either display decode attempts
+      if(!m_wideGraph->shouldDisplayDecodeAttempts()){
+          return;
+      }
+
+      auto m = QString(segs.at(2)).toInt();
+      auto f = int(QString(segs.at(4)).toFloat());
+      auto s = int(QString(segs.at(6)).toFloat());
+      auto xdt = QString(segs.at(8)).toFloat();
+
+      decodeSyncStat(m, f, s, xdt, t.contains("decode"));
+      return;
+  }
+
+  if(t.indexOf("<DecodeStarted>") >= 0) {
+      decodeStarted();
+      return;
+  }
+
+  if(t.indexOf("<DecodeTiming>") >= 0) {
+      auto segs =  QString(t.trimmed()).split(QRegExp("[\\s\\t]+"), QString::SkipEmptyParts);
+      if(segs.length() < 7){
+          return;
+      }
+
+      decodeTiming(segs.at(1).toInt(), segs.at(2).toFloat(), segs.at(3).toFloat(), segs.at(4).toFloat(),
+                   segs.at(5).toInt(), segs.at(6).toInt());
+      return;
+  }
+
+  if(t.indexOf("<DecodePlans>") >= 0) {
+      auto segs =  QString(t.trimmed()).split(QRegExp("[\\s\\t]+"), QString::SkipEmptyParts);
+      if(segs.length() < 2){
+          return;
+      }
+
+      decodePlanned(segs.at(1).toFloat());
+      return;
+  }
+
+  if(t.indexOf("<DecodeDebug>") >= 0) {
+      return;
+  }
+
+  if(t.indexOf("<DecodeFinished>") >= 0) {
+    decodeFinished(t.mid(16).trimmed().toInt());
     return;
   }
 
@@ -5106,6 +5493,18 @@ void MainWindow::processDecodedLine(QByteArray t){
   DecodedText decodedtext {rawText, "FT8" == m_mode &&
         ui->cbVHFcontest->isChecked(), m_config.my_grid ()};
 
+  processDecodedText(decodedtext, rawText);
+}
+
+/**
+ * @brief MainWindow::processDecodedText
+ *        handle a decode, from a typed event or a line of decoder text
+ * @param decodedtext
+ * @param rawText - the decode in the decoder's line format, for ALL.txt
+ */
+void MainWindow::processDecodedText(DecodedText const &decodedtext, QString const &rawText){
+  qint64 parseStart = DecodeTrace::now();
+
   // TODO: move this into a function
   // frames are valid if they pass our dupe check (haven't seen the same frame in the past 1/2 decode period)
   auto frameOffset = decodedtext.frequencyOffset();
@@ -5162,7 +5561,7 @@ void MainWindow::processDecodedLine(QByteArray t){
 
       float expectedStartDelay = computePeriodStartDelayForDecode(m)/1000.0;
 
-      float decodedSignalTime = (float)syncStart/(float)RX_SAMPLE_RATE;
+      float decodedSignalTime = (float)m_decodeSyncStart/(float)RX_SAMPLE_RATE;
 
       //writeNoticeTextToUI(now, QString("--> started at %1 seconds into the start of my drifted minute").arg(decodedSignalTime));
 
@@ -5209,7 +5608,7 @@ void MainWindow::processDecodedLine(QByteArray t){
 
       //writeNoticeTextToUI(now, QString("--> which is rounded to a total drift of %1 milliseconds for this period").arg(newDrift));
 
-      driftQueue.append(newDrift);
+      m_driftQueue.append(newDrift);
   }
 
   // if the frame is valid, cache it!
@@ -5507,6 +5906,10 @@ void MainWindow::processDecodedLine(QByteArray t){
       }
   }
 #endif
+
+  // from the window being queued for decode to the decode being processed
+  DecodeTrace::record("parse", DecodeTrace::now() - parseStart);
+  DecodeTrace::recordSince(DecodeTrace::stage("latency", decodedtext.submode()), DecodeTrace::stage("window", decodedtext.submode()));
 }
 
 bool MainWindow::hasExistingMessageBufferToMe(int *pOffset){
@@ -5603,6 +6006,12 @@ void MainWindow::logCallActivity(CallDetail d, bool spot){
         }
     }
 
+    // keep the band's history, the call activity read from the settings
+    // was stored in the session it was heard in
+    if(m_settings_read && !m_lastBand.isEmpty()){
+        m_heardStore->appendCall({d.call, m_lastBand, d.grid, d.dial, d.offset, d.snr, d.submode, d.tdrift, d.utcTimestamp});
+    }
+
     // enqueue for spotting to psk reporter
     if(spot){
         m_rxCallQueue.append(d);
@@ -5610,6 +6019,14 @@ void MainWindow::logCallActivity(CallDetail d, bool spot){
 }
 
 void MainWindow::logHeardGraph(QString from, QString to){
+    if(!m_lastBand.isEmpty()){
+        m_heardStore->appendHeard(m_lastBand, from, to, DriftingDateTime::currentDateTimeUtc());
+    }
+
+    addHeardGraph(from, to);
+}
+
+void MainWindow::addHeardGraph(QString from, QString to){
     auto my_callsign = m_config.my_callsign();
 
     // hearing
@@ -6787,18 +7204,12 @@ void MainWindow::on_tx6_editingFinished()                       //tx6 edited
 }
 
 void MainWindow::cacheActivity(QString key){
-    m_callActivityBandCache[key] = m_callActivity;
+    // the call activity and heard graph are kept in the heard store
     m_bandActivityBandCache[key] = m_bandActivity;
     m_rxTextBandCache[key] = ui->textEditRX->toHtml();
-    m_heardGraphIncomingBandCache[key] = m_heardGraphIncoming;
-    m_heardGraphOutgoingBandCache[key] = m_heardGraphOutgoing;
 }
 
 void MainWindow::restoreActivity(QString key){
-    if(m_callActivityBandCache.contains(key)){
-        m_callActivity = m_callActivityBandCache[key];
-    }
-
     if(m_bandActivityBandCache.contains(key)){
         m_bandActivity = m_bandActivityBandCache[key];
     }
@@ -6807,17 +7218,56 @@ void MainWindow::restoreActivity(QString key){
         ui->textEditRX->setHtml(m_rxTextBandCache[key]);
     }
 
-    if(m_heardGraphIncomingBandCache.contains(key)){
-        m_heardGraphIncoming = m_heardGraphIncomingBandCache[key];
+    // the calls heard on the band, from this session or an earlier one
+    auto since = heardSince(key);
+    foreach(auto c, m_heardStore->calls(key, since)){
+        if(m_callActivity.contains(c.call) && m_callActivity[c.call].utcTimestamp >= c.utcTimestamp){
+            continue;
+        }
+
+        // keep the ack and cq timestamps (and the grid) we may already have
+        CallDetail cd = m_callActivity.value(c.call);
+        cd.call = c.call;
+        if(!c.grid.isEmpty()){
+            cd.grid = c.grid;
+        }
+        cd.dial = c.dial;
+        cd.offset = c.offset;
+        cd.snr = c.snr;
+        cd.submode = c.submode;
+        cd.tdrift = c.tdrift;
+        cd.utcTimestamp = c.utcTimestamp;
+        m_callActivity[c.call] = cd;
     }
 
-    if(m_heardGraphOutgoingBandCache.contains(key)){
-        m_heardGraphOutgoing = m_heardGraphOutgoingBandCache[key];
+    foreach(auto edge, m_heardStore->heardGraph(key, since)){
+        addHeardGraph(edge.first, edge.second);
     }
 
     displayActivity(true);
 }
 
+/**
+ * @brief MainWindow::heardSince
+ * @param band
+ * @return how far back the band's call activity is restored from the
+ *         heard store: the callsign aging (or a day if callsigns do not
+ *         age), but not before the band's call activity was cleared
+ */
+QDateTime MainWindow::heardSince(QString band){
+    auto now = DriftingDateTime::currentDateTimeUtc();
+
+    int callsignAging = m_config.callsign_aging();
+    auto since = callsignAging ? now.addSecs(-60 * callsignAging) : now.addDays(-1);
+
+    auto clearedAt = m_callActivityClearedAt.value(band);
+    if(clearedAt.isValid() && since < clearedAt){
+        since = clearedAt;
+    }
+
+    return since;
+}
+
 void MainWindow::clearActivity(){
     qDebug() << "clear activity";
 
@@ -6873,14 +7323,24 @@ void MainWindow::clearCallActivity(){
     m_heardGraphIncoming.clear();
     m_heardGraphOutgoing.clear();
 
+    // the cleared calls stay in the heard store, but are not restored
+    m_callActivityClearedAt[m_lastBand] = DriftingDateTime::currentDateTimeUtc();
+
     clearTableWidget(ui->tableWidgetCalls);
-    createGroupCallsignTableRows(ui->tableWidgetCalls, "");
+    createGroupCallsignTableRows(ui->tableWidgetCalls);
 
     resetTimeDeltaAverage();
     displayCallActivity();
 }
 
-void MainWindow::createGroupCallsignTableRows(QTableWidget *table, QString const &selectedCall){
+/**
+ * @brief MainWindow::createGroupCallsignTableRows
+ *        fill the first rows of the table with @ALLCALL and our groups,
+ *        reusing the rows already there
+ * @param table
+ * @return the number of rows filled
+ */
+int MainWindow::createGroupCallsignTableRows(QTableWidget *table){
     int count = 0;
     auto now = DriftingDateTime::currentDateTimeUtc();
     int callsignAging = m_config.callsign_aging();
@@ -6899,45 +7359,39 @@ void MainWindow::createGroupCallsignTableRows(QTableWidget *table, QString const
 
     table->horizontalHeaderItem(startCol)->setText(count == 0 ? "Callsigns" : QString("Callsigns (%1)").arg(count));
 
+    QStringList calls;
     if(!m_config.avoid_allcall()){
-        table->insertRow(table->rowCount());
-
-        auto emptyItem = new QTableWidgetItem("");
-        emptyItem->setData(Qt::UserRole, QVariant("@ALLCALL"));
-        table->setItem(table->rowCount() - 1, 0, emptyItem);
-
-        auto item = new QTableWidgetItem(QString("@ALLCALL"));
-        item->setData(Qt::UserRole, QVariant("@ALLCALL"));
-
-        table->setItem(table->rowCount() - 1, startCol, item);
-        table->setSpan(table->rowCount() - 1, startCol, 1, table->columnCount());
-        if(selectedCall == "@ALLCALL"){
-            table->item(table->rowCount()-1, 0)->setSelected(true);
-            table->item(table->rowCount()-1, startCol)->setSelected(true);
-        }
+        calls.append("@ALLCALL");
     }
 
     auto groups = m_config.my_groups().toList();
     qSort(groups);
-    foreach(auto group, groups){
-        table->insertRow(table->rowCount());
+    calls.append(groups);
 
-        auto emptyItem = new QTableWidgetItem("");
-        emptyItem->setData(Qt::UserRole, QVariant(group));
-        emptyItem->setToolTip(generateCallDetail(group));
-        table->setItem(table->rowCount() - 1, 0, emptyItem);
+    int row = 0;
+    foreach(auto call, calls){
+        if(row == table->rowCount()){
+            table->insertRow(row);
+        }
 
-        auto item = new QTableWidgetItem(group);
-        item->setData(Qt::UserRole, QVariant(group));
-        item->setToolTip(generateCallDetail(group));
-        table->setItem(table->rowCount() - 1, startCol, item);
-        table->setSpan(table->rowCount() - 1, startCol, 1, table->columnCount());
+        auto toolTip = call == "@ALLCALL" ? QString() : generateCallDetail(call);
+        setTableItem(table, row, 0, "", call, toolTip);
+        setTableItem(table, row, startCol, call, call, toolTip);
+        setTableRowBackground(table, row, QBrush());
+        setTableRowSignature(table, row, QString());
 
-        if(selectedCall == group){
-            table->item(table->rowCount()-1, 0)->setSelected(true);
-            table->item(table->rowCount()-1, startCol)->setSelected(true);
+        // the cells under the span, left over from a callsign row
+        for(int col = startCol + 1; col < table->columnCount(); col++){
+            delete table->takeItem(row, col);
         }
+
+        if(table->columnSpan(row, startCol) != table->columnCount()){
+            table->setSpan(row, startCol, 1, table->columnCount());
+        }
+        row++;
     }
+
+    return row;
 }
 
 void MainWindow::displayTextForFreq(QString text, int freq, QDateTime date, bool isTx, bool isNewLine, bool isLast){
@@ -7021,14 +7475,17 @@ int MainWindow::writeMessageTextToUI(QDateTime date, QString text, int freq, boo
         }
     }
 
-    // fixup duplicate acks
-    auto tc = c.document()->find(text);
-    if(!tc.isNull() && tc.selectedText() == text && (text.contains(" ACK ") || text.contains(" HEARTBEAT SNR "))){
-        tc.select(QTextCursor::BlockUnderCursor);
-
-        if(tc.selectedText().trimmed().startsWith(date.time().toString())){
-            qDebug() << "found" << tc.selectedText() << "so not displaying...";
-            return tc.blockNumber();
+    // fixup duplicate acks, a duplicate was written at the same time so
+    // only the most recent blocks are looked at rather than the whole pane
+    if(text.contains(" ACK ") || text.contains(" HEARTBEAT SNR ")){
+        auto time = date.time().toString();
+        auto b = c.document()->lastBlock();
+        for(int i = 0; i < 50 && b.isValid(); i++, b = b.previous()){
+            auto blockText = b.text();
+            if(blockText.trimmed().startsWith(time) && blockText.contains(text)){
+                qDebug() << "found" << blockText << "so not displaying...";
+                return b.blockNumber();
+            }
         }
     }
 
@@ -7785,6 +8242,7 @@ void MainWindow::acceptQSO (QDateTime const& QSO_date_off, QString const& call,
 {
   QString date = QSO_date_on.toString("yyyyMMdd");
   m_logBook.addAsWorked (m_hisCall, m_config.bands ()->find (m_freqNominal), mode, submode, grid, date, name, comments);
+  m_logBookGeneration++;
 
   // Log to JS8Call API
   if(canSendNetworkMessage()){
@@ -7896,6 +8354,7 @@ void MainWindow::acceptQSO (QDateTime const& QSO_date_off, QString const& call,
 
   // reload the logbook data
   m_logBook.init();
+  m_logBookGeneration++;
 
   if (m_config.clear_callsign ()){
       clearCallsignSelected();
@@ -8292,6 +8751,7 @@ void MainWindow::on_actionErase_js8call_log_adi_triggered()
     f.remove();
 
     m_logBook.init();
+    m_logBookGeneration++;
   }
 }
 
@@ -8400,6 +8860,7 @@ void MainWindow::vhfWarning()
 void MainWindow::enable_DXCC_entity (bool /*on*/)
 {
   m_logBook.init();                        // re-read the log and cty.dat files
+  m_logBookGeneration++;
   updateGeometry ();
 }
 
@@ -10571,7 +11032,8 @@ void MainWindow::refreshTextDisplay(){
     bool forceIdentify = !m_config.avoid_forced_identify();
     bool forceData = false;
 
-    BuildMessageFramesThread *t = new BuildMessageFramesThread(
+    // the worker only builds the latest text, and only from where it was edited
+    m_buildFramesWorker->request(
         mycall,
         mygrid,
         selectedCall,
@@ -10580,26 +11042,23 @@ void MainWindow::refreshTextDisplay(){
         forceData,
         m_nSubMode
     );
+#endif
+}
 
-    connect(t, &BuildMessageFramesThread::finished, t, &QObject::deleteLater);
-    connect(t, &BuildMessageFramesThread::resultReady, this, [this, text](QString transmitText, int frames){
-        // ugh...i hate these globals
-        m_txTextDirtyLastSelectedCall = callsignSelected(true);
-        m_txTextDirtyLastText = text;
+void MainWindow::textFramesBuilt(QString text, QString transmitText, int frames){
+    // ugh...i hate these globals
+    m_txTextDirtyLastSelectedCall = callsignSelected(true);
+    m_txTextDirtyLastText = text;
 #if TEST_FOX_WAVE_GEN
-        m_txFrameCountEstimate = ui->turboButton->isChecked() ? (int)ceil(float(frames)/TEST_FOX_WAVE_GEN_SLOTS) : frames;
+    m_txFrameCountEstimate = ui->turboButton->isChecked() ? (int)ceil(float(frames)/TEST_FOX_WAVE_GEN_SLOTS) : frames;
 #else
-        m_txFrameCountEstimate = frames;
+    m_txFrameCountEstimate = frames;
 #endif
-        m_txTextDirty = false;
-
-        updateTextWordCheckerDisplay();
-        updateTextStatsDisplay(transmitText, m_txFrameCountEstimate);
-        updateTxButtonDisplay();
+    m_txTextDirty = false;
 
-    });
-    t->start();
-#endif
+    updateTextWordCheckerDisplay();
+    updateTextStatsDisplay(transmitText, m_txFrameCountEstimate);
+    updateTxButtonDisplay();
 }
 
 void MainWindow::updateTextWordCheckerDisplay(){
@@ -10607,7 +11066,7 @@ void MainWindow::updateTextWordCheckerDisplay(){
         return;
     }
 
-    JSCChecker::checkRange(ui->extFreeTextMsgEdit, 0, -1);
+    m_checker->checkLater(ui->extFreeTextMsgEdit);
 }
 
 void MainWindow::updateTextStatsDisplay(QString text, int count){
@@ -11444,10 +11903,24 @@ void MainWindow::processCommandActivity() {
             // so don't overwrite those (i.e., print each on a new line)
             bool shouldOverwrite = (!d.cmd.contains(" ACK") && !d.cmd.contains(" SNR")); /* && isRecentOffset(d.freq);*/
 
-            if(shouldOverwrite && ui->textEditRX->find(d.utcTimestamp.time().toString(), QTextDocument::FindBackward)){
+            // the line to overwrite was written this period, so like the duplicate
+            // acks only the most recent blocks are looked at rather than the whole pane
+            QTextBlock overwrite;
+            if(shouldOverwrite){
+                auto time = d.utcTimestamp.time().toString();
+                auto b = ui->textEditRX->document()->lastBlock();
+                for(int i = 0; i < 50 && b.isValid(); i++, b = b.previous()){
+                    if(b.text().contains(time)){
+                        overwrite = b;
+                        break;
+                    }
+                }
+            }
+
+            if(overwrite.isValid()){
                 // ... maybe we could delete the last line that had this message on this frequency...
-                c = ui->textEditRX->textCursor();
-                c.movePosition(QTextCursor::StartOfBlock);
+                c = QTextCursor(overwrite);
+                ui->textEditRX->setTextCursor(c);
                 c.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
                 qDebug() << "should display directed message, erasing last rx activity line..." << c.selectedText().toUpper();
                 c.removeSelectedText();
@@ -12055,6 +12528,10 @@ QString MainWindow::inboxPath(){
     return QDir::toNativeSeparators(m_config.writeable_data_dir().absoluteFilePath("inbox.db3"));
 }
 
+QString MainWindow::heardPath(){
+    return QDir::toNativeSeparators(m_config.writeable_data_dir().absoluteFilePath("heard.db3"));
+}
+
 void MainWindow::refreshInboxCounts(){
     auto inbox = Inbox(inboxPath());
     if(inbox.open()){
@@ -12315,6 +12792,8 @@ void MainWindow::displayActivity(bool force) {
         return;
     }
 
+    qint64 displayStart = DecodeTrace::now();
+
     // Band Activity
     displayBandActivity();
 
@@ -12322,13 +12801,17 @@ void MainWindow::displayActivity(bool force) {
     displayCallActivity();
 
     m_rxDisplayDirty = false;
+
+    DecodeTrace::record("display", DecodeTrace::now() - displayStart);
 }
 
 // updateBandActivity
 void MainWindow::displayBandActivity() {
     auto now = DriftingDateTime::currentDateTimeUtc();
 
-    ui->tableWidgetRXAll->setFont(m_config.table_font());
+    if(ui->tableWidgetRXAll->font() != m_config.table_font()){
+        ui->tableWidgetRXAll->setFont(m_config.table_font());
+    }
 
     // Selected Offset
     int selectedOffset = -1;
@@ -12342,12 +12825,7 @@ void MainWindow::displayBandActivity() {
         // Scroll Position
         auto currentScrollPos = ui->tableWidgetRXAll->verticalScrollBar()->value();
 
-        // Clear the table
-        clearTableWidget(ui->tableWidgetRXAll);
-
         // Sort!
-        QList < int > keys = m_bandActivity.keys();
-
         auto sortBy = getSortBy("bandActivity", "offset");
         bool reverse = false;
         if(sortBy.startsWith("-")){
@@ -12355,90 +12833,69 @@ void MainWindow::displayBandActivity() {
             reverse = true;
         }
 
-        auto compareTimestamp = [this](const int left, int right) {
-            auto leftItems = m_bandActivity[left];
-            auto rightItems = m_bandActivity[right];
-
-            if(leftItems.isEmpty()){
-                return false;
-            }
-
-            if(rightItems.isEmpty()){
-                return true;
-            }
-
-            auto leftLast = leftItems.last();
-            auto rightLast = rightItems.last();
-
-            return leftLast.utcTimestamp < rightLast.utcTimestamp;
+        // the sort key of each offset is taken once, from its last item,
+        // instead of in every comparison
+        struct SortKey {
+            int offset;
+            qint64 key;
         };
 
-        auto compareSNR = [this, reverse](const int left, int right) {
-            auto leftItems = m_bandActivity[left];
-            auto rightItems = m_bandActivity[right];
-
-            if(leftItems.isEmpty()){
-                return false;
-            }
-
-            if(rightItems.isEmpty()){
-                return true;
-            }
-
-            auto leftActivity = leftItems.last();
-            auto rightActivity = rightItems.last();
-
-            if(leftActivity.snr < -60 || leftActivity.snr > 60) {
-                leftActivity.snr *= reverse ? 1 : -1;
-            }
-            if(rightActivity.snr < -60 || rightActivity.snr > 60) {
-                rightActivity.snr *= reverse ? 1 : -1;
-            }
-
-            return leftActivity.snr < rightActivity.snr;
-        };
-
-        auto compareSubmode = [this](const int left, int right) {
-            auto leftItems = m_bandActivity[left];
-            auto rightItems = m_bandActivity[right];
-
-            if(leftItems.isEmpty()){
-                return false;
+        QVector<SortKey> keys;
+        keys.reserve(m_bandActivity.size());
+        for(auto it = m_bandActivity.constBegin(); it != m_bandActivity.constEnd(); ++it){
+            if(it.value().isEmpty()){
+                continue;
             }
 
-            if(rightItems.isEmpty()){
-                return true;
+            auto const &last = it.value().last();
+            qint64 key = 0;
+            if(sortBy == "timestamp"){
+                key = last.utcTimestamp.isValid() ? last.utcTimestamp.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+            } else if(sortBy == "snr"){
+                key = last.snr;
+                if(key < -60 || key > 60) {
+                    key *= reverse ? 1 : -1;
+                }
+            } else if(sortBy == "submode"){
+                key = last.submode == Varicode::JS8CallSlow ? -last.submode : last.submode;
             }
-
-            auto leftLast = leftItems.last();
-            auto rightLast = rightItems.last();
-
-            int leftSubmode = leftLast.submode;
-            int rightSubmode = rightLast.submode;
-
-            if(leftSubmode == Varicode::JS8CallSlow){ leftSubmode = -leftSubmode; }
-            if(rightSubmode == Varicode::JS8CallSlow){ rightSubmode = -rightSubmode; }
-
-            return leftSubmode < rightSubmode;
-        };
-
-        // compare offset
-        qStableSort(keys.begin(), keys.end());
-
-        if(sortBy == "timestamp"){
-            qStableSort(keys.begin(), keys.end(), compareTimestamp);
-        } else if(sortBy == "snr"){
-            qStableSort(keys.begin(), keys.end(), compareSNR);
-        } else if(sortBy == "submode"){
-            qStableSort(keys.begin(), keys.end(), compareSubmode);
+            keys.append({it.key(), key});
         }
 
-        if(reverse){
-            keys = listCopyReverse(keys);
+        // compare offset (the map keeps them in order)
+        if(sortBy == "timestamp" || sortBy == "snr" || sortBy == "submode"){
+            qStableSort(keys.begin(), keys.end(), [](SortKey const &left, SortKey const &right){
+                return left.key < right.key;
+            });
         }
 
-        // Build the table
-        foreach(int offset, keys) {
+        if(reverse){
+            std::reverse(keys.begin(), keys.end());
+        }
+
+        int activityAging = m_config.activity_aging();
+        int selectedRow = -1;
+        int row = 0;
+        bool rowsChanged = false;
+
+        // what a row looks like besides its own contents
+        int colWidth = ui->tableWidgetRXAll->columnWidth(3);
+        auto settings = QStringList{
+            QString::number(colWidth),
+            m_config.table_font().toString(),
+            m_config.eot(),
+            m_config.my_callsign(),
+            m_config.color_MyCall().name(),
+            m_config.color_CQ().name(),
+            m_config.color_primary_highlight().name(),
+            m_config.color_secondary_highlight().name(),
+            QStringList(m_config.primary_highlight_words().toList()).join(" "),
+            QStringList(m_config.secondary_highlight_words().toList()).join(" "),
+        }.join("\t");
+
+        // Build the table, updating the rows already there in place
+        foreach(SortKey const &sortKey, keys) {
+            int offset = sortKey.offset;
             bool isOffsetSelected = (offset == selectedOffset);
 
             QList < ActivityDetail > items = m_bandActivity[offset];
@@ -12450,8 +12907,6 @@ void MainWindow::displayBandActivity() {
                 float tdrift = 0;
                 int submode = -1;
 
-                int activityAging = m_config.activity_aging();
-
                 // hide items that shouldn't appear
 
                 for(int i = 0; i < items.length(); i++){
@@ -12521,120 +12976,95 @@ void MainWindow::displayBandActivity() {
                     continue;
                 }
 
-                ui->tableWidgetRXAll->insertRow(ui->tableWidgetRXAll->rowCount());
-                int row = ui->tableWidgetRXAll->rowCount() - 1;
+                if (isOffsetSelected) {
+                    selectedRow = row;
+                }
+
+                bool isDirectedAllCall = false;
+                bool isDirected = isDirectedOffset(offset, &isDirectedAllCall) && !isDirectedAllCall;
+
+                // skip the row if it shows this already
+                auto signature = QStringList{
+                    QString::number(offset), age, timestamp.toString(), QString::number(snr),
+                    QString::number(tdrift), QString::number(submode), joined, QString::number(isDirected), settings
+                }.join("\t");
+                if(isTableRowCurrent(ui->tableWidgetRXAll, row, signature)){
+                    row++;
+                    continue;
+                }
+                rowsChanged = true;
+
+                if(row == ui->tableWidgetRXAll->rowCount()){
+                    ui->tableWidgetRXAll->insertRow(row);
+                }
                 int col = 0;
 
-                auto offsetItem = new QTableWidgetItem(QString("%1 Hz").arg(offset));
-                offsetItem->setData(Qt::UserRole, QVariant(offset));
-                ui->tableWidgetRXAll->setItem(row, col++, offsetItem);
+                setTableItem(ui->tableWidgetRXAll, row, col++, QString("%1 Hz").arg(offset), offset);
 
-                auto ageItem = new QTableWidgetItem(age);
-                ageItem->setTextAlignment(Qt::AlignCenter | Qt::AlignVCenter);
-                ageItem->setToolTip(timestamp.toString());
-                ui->tableWidgetRXAll->setItem(row, col++, ageItem);
+                setTableItem(ui->tableWidgetRXAll, row, col++, age, QVariant(), timestamp.toString(), Qt::AlignCenter | Qt::AlignVCenter);
 
                 auto snrText = Varicode::formatSNR(snr);
-                auto snrItem = new QTableWidgetItem(snrText.isEmpty() ? "" : QString("%1 dB").arg(snrText));
-                snrItem->setTextAlignment(Qt::AlignCenter | Qt::AlignVCenter);
-                ui->tableWidgetRXAll->setItem(row, col++, snrItem);
+                setTableItem(ui->tableWidgetRXAll, row, col++, snrText.isEmpty() ? "" : QString("%1 dB").arg(snrText), QVariant(), QString(), Qt::AlignCenter | Qt::AlignVCenter);
 
-                auto tdriftItem = new QTableWidgetItem(QString("%1 ms").arg((int)(1000*tdrift)));
-                tdriftItem->setData(Qt::UserRole, QVariant(tdrift));
-                ui->tableWidgetRXAll->setItem(row, col++, tdriftItem);
+                setTableItem(ui->tableWidgetRXAll, row, col++, QString("%1 ms").arg((int)(1000*tdrift)), tdrift);
 
                 auto name = submodeName(submode);
-                auto submodeItem = new QTableWidgetItem(name.left(1).replace("H", "N"));
-                submodeItem->setToolTip(name);
-                submodeItem->setData(Qt::UserRole, QVariant(name));
-                submodeItem->setTextAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
-                ui->tableWidgetRXAll->setItem(row, col++, submodeItem);
+                setTableItem(ui->tableWidgetRXAll, row, col++, name.left(1).replace("H", "N"), name, name, Qt::AlignHCenter | Qt::AlignVCenter);
 
                 // align right if eliding...
-                int colWidth = ui->tableWidgetRXAll->columnWidth(3);
-                auto textItem = new QTableWidgetItem(joined);
                 auto html = QString("<qt/>%1").arg(joined.toHtmlEscaped());
                 html = html.replace(m_config.eot(), m_config.eot() + "<br/><br/>");
                 html = html.replace(QRegularExpression("([<]br[/][>])+$"), "");
-                textItem->setToolTip(html);
 
-                QFontMetrics fm(textItem->font());
+                QFontMetrics fm(m_config.table_font());
                 auto elidedText = fm.elidedText(joined, Qt::ElideLeft, colWidth);
                 auto flag = Qt::AlignLeft | Qt::AlignVCenter;
                 if (elidedText != joined) {
                     flag = Qt::AlignRight | Qt::AlignVCenter;
-                    textItem->setText(joined);
                 }
-                textItem->setTextAlignment(flag);
-
-                ui->tableWidgetRXAll->setItem(row, col++, textItem);
+                setTableItem(ui->tableWidgetRXAll, row, col++, joined, QVariant(), html, flag);
 
-                if (isOffsetSelected) {
-                    for(int i = 0; i < ui->tableWidgetRXAll->columnCount(); i++){
-                        ui->tableWidgetRXAll->item(row, i)->setSelected(true);
-                    }
-                }
+                QBrush background;
 
-                bool isDirectedAllCall = false;
-                if(
-                    (isDirectedOffset(offset, &isDirectedAllCall) && !isDirectedAllCall) || isMyCallIncluded(text.last())
-                ){
-                    for(int i = 0; i < ui->tableWidgetRXAll->columnCount(); i++){
-                        ui->tableWidgetRXAll->item(row, i)->setBackground(QBrush(m_config.color_MyCall()));
-                    }
+                if(isDirected || isMyCallIncluded(text.last())){
+                    background = QBrush(m_config.color_MyCall());
                 }
 
                 if(!text.isEmpty()){
                     auto words = QSet<QString>::fromList(joined.replace(":", " ").replace(">"," ").split(" "));
 
                     if(words.contains("CQ")){
-                        for(int i = 0; i < ui->tableWidgetRXAll->columnCount(); i++){
-                            ui->tableWidgetRXAll->item(row, i)->setBackground(QBrush(m_config.color_CQ()));
-                        }
+                        background = QBrush(m_config.color_CQ());
                     }
 
                     auto matchingSecondaryWords = m_config.secondary_highlight_words() & words;
                     if (!matchingSecondaryWords.isEmpty()){
-                        for(int i = 0; i < ui->tableWidgetRXAll->columnCount(); i++){
-                            ui->tableWidgetRXAll->item(row, i)->setBackground(QBrush(m_config.color_secondary_highlight()));
-                        }
+                        background = QBrush(m_config.color_secondary_highlight());
                     }
 
                     auto matchingPrimaryWords = m_config.primary_highlight_words() & words;
                     if (!matchingPrimaryWords.isEmpty()){
-                        for(int i = 0; i < ui->tableWidgetRXAll->columnCount(); i++){
-                            ui->tableWidgetRXAll->item(row, i)->setBackground(QBrush(m_config.color_primary_highlight()));
-                        }
+                        background = QBrush(m_config.color_primary_highlight());
                     }
                 }
+
+                setTableRowBackground(ui->tableWidgetRXAll, row, background);
+                setTableRowSignature(ui->tableWidgetRXAll, row, signature);
+
+                row++;
             }
         }
 
-        // Set table color
-        auto style = QString("QTableWidget { background:%1; selection-background-color:%2; alternate-background-color:%1; color:%3; } "
-                             "QTableWidget::item:selected { background-color: %2; color: %3; }");
-        style = style.arg(m_config.color_table_background().name());
-        style = style.arg(m_config.color_table_highlight().name());
-        style = style.arg(m_config.color_table_foreground().name());
-        ui->tableWidgetRXAll->setStyleSheet(style);
-
-        // Set the table palette for inactive selected row
-        auto p = ui->tableWidgetRXAll->palette();
+        if(row != ui->tableWidgetRXAll->rowCount()){
+            rowsChanged = true;
+        }
+        setTableRows(ui->tableWidgetRXAll, row, selectedRow);
 
-        p.setColor(QPalette::Highlight, m_config.color_table_highlight());
-        p.setColor(QPalette::HighlightedText, m_config.color_table_foreground());
-        p.setColor(QPalette::Inactive, QPalette::Highlight, p.color(QPalette::Active, QPalette::Highlight));
-        ui->tableWidgetRXAll->setPalette(p);
+        // Set table color
+        setTableStyle(ui->tableWidgetRXAll, m_config.color_table_background(), m_config.color_table_highlight(), m_config.color_table_foreground());
 
         // Set item fonts
-        for(int row = 0; row < ui->tableWidgetRXAll->rowCount(); row++){
-            for(int col = 0; col < ui->tableWidgetRXAll->columnCount(); col++){
-                auto item = ui->tableWidgetRXAll->item(row, col);
-                if(item){
-                    item->setFont(m_config.table_font());
-                }
-            }
-        }
+        setTableFonts(ui->tableWidgetRXAll, m_config.table_font(), m_config.table_font());
 
         // Column labels
         ui->tableWidgetRXAll->horizontalHeader()->setVisible(showColumn("band", "labels"));
@@ -12646,12 +13076,14 @@ void MainWindow::displayBandActivity() {
         ui->tableWidgetRXAll->setColumnHidden(3, !showColumn("band", "tdrift", false));
         ui->tableWidgetRXAll->setColumnHidden(4, !showColumn("band", "submode", false));
 
-        // Resize the table columns
-        ui->tableWidgetRXAll->resizeColumnToContents(0);
-        ui->tableWidgetRXAll->resizeColumnToContents(1);
-        ui->tableWidgetRXAll->resizeColumnToContents(2);
-        ui->tableWidgetRXAll->resizeColumnToContents(3);
-        ui->tableWidgetRXAll->resizeColumnToContents(4);
+        // Resize the table columns, only when what's in them changed
+        if(rowsChanged){
+            ui->tableWidgetRXAll->resizeColumnToContents(0);
+            ui->tableWidgetRXAll->resizeColumnToContents(1);
+            ui->tableWidgetRXAll->resizeColumnToContents(2);
+            ui->tableWidgetRXAll->resizeColumnToContents(3);
+            ui->tableWidgetRXAll->resizeColumnToContents(4);
+        }
 
         // Reset the scroll position
         ui->tableWidgetRXAll->verticalScrollBar()->setValue(currentScrollPos);
@@ -12663,7 +13095,9 @@ void MainWindow::displayBandActivity() {
 void MainWindow::displayCallActivity() {
     auto now = DriftingDateTime::currentDateTimeUtc();
 
-    ui->tableWidgetCalls->setFont(m_config.table_font());
+    if(ui->tableWidgetCalls->font() != m_config.table_font()){
+        ui->tableWidgetCalls->setFont(m_config.table_font());
+    }
 
     // Selected callsign
     QString selectedCall = callsignSelected();
@@ -12672,12 +13106,14 @@ void MainWindow::displayCallActivity() {
 
     ui->tableWidgetCalls->setUpdatesEnabled(false);
     {
-        // Clear the table
-        clearTableWidget(ui->tableWidgetCalls);
-        createGroupCallsignTableRows(ui->tableWidgetCalls, selectedCall); // isAllCallIncluded(selectedCall)); // || isGroupCallIncluded(selectedCall));
-
-        // Build the table
-        QList < QString > keys = m_callActivity.keys();
+        // Update the group rows in place, the callsigns follow them
+        int row = createGroupCallsignTableRows(ui->tableWidgetCalls);
+        int selectedRow = -1;
+        for(int i = 0; i < row; i++){
+            if(ui->tableWidgetCalls->item(i, 1)->data(Qt::UserRole).toString() == selectedCall){
+                selectedRow = i;
+            }
+        }
 
         auto sortBy = getSortBy("callActivity", "callsign");
         bool reverse = false;
@@ -12686,104 +13122,79 @@ void MainWindow::displayCallActivity() {
             reverse = true;
         }
 
-        auto compareOffset = [this](const QString left, QString right) {
-            auto leftActivity = m_callActivity[left];
-            auto rightActivity = m_callActivity[right];
-
-            return leftActivity.offset < rightActivity.offset;
-        };
-
-        auto compareDistance = [this, reverse](const QString left, QString right) {
-            auto leftActivity = m_callActivity[left];
-            auto rightActivity = m_callActivity[right];
-
-            int leftDistance = reverse ? -100000 : 100000;
-            int rightDistance = reverse ? -100000 : 100000;
-            if(!leftActivity.grid.isEmpty()){
-                calculateDistance(leftActivity.grid, &leftDistance);
-            }
-            if(!rightActivity.grid.isEmpty()){
-                calculateDistance(rightActivity.grid, &rightDistance);
-            }
-
-            return leftDistance < rightDistance;
-        };
-
-        auto compareTimestamp = [this](const QString left, QString right) {
-            auto leftActivity = m_callActivity[left];
-            auto rightActivity = m_callActivity[right];
-
-            return leftActivity.utcTimestamp < rightActivity.utcTimestamp;
-        };
-
-        auto compareAckTimestamp = [this, reverse](const QString left, QString right) {
-            auto leftActivity = m_callActivity[left];
-            auto rightActivity = m_callActivity[right];
-
-            return rightActivity.ackTimestamp < leftActivity.ackTimestamp;
+        // the sort key of each callsign is taken once (the distance is
+        // a grid calculation) instead of in every comparison
+        struct SortKey {
+            QString call;
+            qint64 key;
+            bool pinned;
         };
 
-        auto compareSNR = [this, reverse](const QString left, QString right) {
-            auto leftActivity = m_callActivity[left];
-            auto rightActivity = m_callActivity[right];
-
-            if(leftActivity.snr < -60 || leftActivity.snr > 60) {
-                leftActivity.snr *= reverse ? 1 : -1;
-            }
-            if(rightActivity.snr < -60 || rightActivity.snr > 60) {
-                rightActivity.snr *= reverse ? 1 : -1;
+        QVector<SortKey> keys;
+        keys.reserve(m_callActivity.size());
+        for(auto it = m_callActivity.constBegin(); it != m_callActivity.constEnd(); ++it){
+            auto const &d = it.value();
+            qint64 key = 0;
+            if(sortBy == "offset"){
+                key = d.offset;
+            } else if(sortBy == "distance"){
+                int distance = reverse ? -100000 : 100000;
+                if(!d.grid.isEmpty()){
+                    calculateDistance(d.grid, &distance);
+                }
+                key = distance;
+            } else if(sortBy == "timestamp"){
+                key = d.utcTimestamp.isValid() ? d.utcTimestamp.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+            } else if(sortBy == "ackTimestamp"){
+                // most recent first
+                key = d.ackTimestamp.isValid() ? -d.ackTimestamp.toMSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+            } else if(sortBy == "snr"){
+                key = d.snr;
+                if(key < -60 || key > 60) {
+                    key *= reverse ? 1 : -1;
+                }
+            } else if(sortBy == "submode"){
+                key = d.submode == Varicode::JS8CallSlow ? -d.submode : d.submode;
             }
+            keys.append({it.key(), key, m_rxInboxCountCache.value(it.key(), 0) > 0});
+        }
 
-            return leftActivity.snr < rightActivity.snr;
-        };
-
-        auto compareSubmode= [this](const QString left, QString right) {
-            auto leftActivity = m_callActivity[left];
-            auto rightActivity = m_callActivity[right];
-
-            int leftSubmode = leftActivity.submode;
-            int rightSubmode = rightActivity.submode;
-
-            if(leftSubmode == Varicode::JS8CallSlow){ leftSubmode = -leftSubmode; }
-            if(rightSubmode == Varicode::JS8CallSlow){ rightSubmode = -rightSubmode; }
-
-            return leftSubmode < rightSubmode;
-        };
-
-
-        // compare callsign
-        qStableSort(keys.begin(), keys.end());
-
-        if(sortBy == "offset"){
-            qStableSort(keys.begin(), keys.end(), compareOffset);
-        } else if(sortBy == "distance"){
-            qStableSort(keys.begin(), keys.end(), compareDistance);
-        } else if(sortBy == "timestamp"){
-            qStableSort(keys.begin(), keys.end(), compareTimestamp);
-        } else if(sortBy == "ackTimestamp"){
-            qStableSort(keys.begin(), keys.end(), compareAckTimestamp);
-        } else if(sortBy == "snr"){
-            qStableSort(keys.begin(), keys.end(), compareSNR);
-        } else if(sortBy == "submode"){
-            qStableSort(keys.begin(), keys.end(), compareSubmode);
+        // compare callsign (the map keeps them in order)
+        if(sortBy == "offset" || sortBy == "distance" || sortBy == "timestamp" || sortBy == "ackTimestamp" || sortBy == "snr" || sortBy == "submode"){
+            qStableSort(keys.begin(), keys.end(), [](SortKey const &left, SortKey const &right){
+                return left.key < right.key;
+            });
         }
 
         if(reverse){
-            keys = listCopyReverse(keys);
+            std::reverse(keys.begin(), keys.end());
         }
 
         // pin messages to the top
-        qStableSort(keys.begin(), keys.end(), [this](const QString left, QString right){
-            int leftHas = (int)!(m_rxInboxCountCache.value(left, 0) > 0);
-            int rightHas = (int)!(m_rxInboxCountCache.value(right, 0) > 0);
-
-            return leftHas < rightHas;
+        qStableSort(keys.begin(), keys.end(), [](SortKey const &left, SortKey const &right){
+            return left.pinned && !right.pinned;
         });
 
         bool showIconColumn = false;
+        bool rowsChanged = false;
+
+        // what a row looks like besides its own call details
+        auto settings = QStringList{
+            QString::number(m_logBookGeneration),
+            m_config.my_grid(),
+            QString::number(m_config.miles()),
+            m_config.color_CQ().name(),
+            m_config.color_primary_highlight().name(),
+            m_config.color_secondary_highlight().name(),
+            QString::number(showColumn("call", "grid", false)),
+            QString::number(showColumn("call", "log")),
+            QString::number(showColumn("call", "logName")),
+            QString::number(showColumn("call", "logComment")),
+        }.join("\t");
 
         int callsignAging = m_config.callsign_aging();
-        foreach(QString call, keys) {
+        foreach(SortKey const &sortKey, keys) {
+            QString const &call = sortKey.call;
             if(call.trimmed().isEmpty()){
                 continue;
             }
@@ -12808,8 +13219,38 @@ void MainWindow::displayCallActivity() {
                 continue;
             }
 
-            ui->tableWidgetCalls->insertRow(ui->tableWidgetCalls->rowCount());
-            int row = ui->tableWidgetCalls->rowCount() - 1;
+            if (isCallSelected) {
+                selectedRow = row;
+            }
+
+            bool hasThrough = !d.through.isEmpty();
+            if(hasMessage || hasACK || hasCQ || hasThrough){
+                showIconColumn = true;
+            }
+
+            if(row == ui->tableWidgetCalls->rowCount()){
+                ui->tableWidgetCalls->insertRow(row);
+            }
+            if(ui->tableWidgetCalls->columnSpan(row, 1) > 1){
+                // a group row before
+                ui->tableWidgetCalls->setSpan(row, 1, 1, 1);
+            }
+
+            // skip the row (and its log lookup) if it shows this already
+            auto signature = QStringList{
+                d.call, d.through, d.grid, QString::number(d.snr), QString::number(d.offset),
+                QString::number(d.tdrift), QString::number(d.submode), d.utcTimestamp.toString(), since(d.utcTimestamp),
+                QString::number(hasMessage), hasACK ? since(d.ackTimestamp) : QString(), hasCQ ? since(d.cqTimestamp) : QString(),
+                QString::number(m_config.secondary_highlight_words().contains(call)),
+                QString::number(m_config.primary_highlight_words().contains(call)),
+                settings
+            }.join("\t");
+            if(isTableRowCurrent(ui->tableWidgetCalls, row, signature)){
+                row++;
+                continue;
+            }
+            rowsChanged = true;
+
             int col = 0;
 
 #if SHOW_THROUGH_CALLS
@@ -12817,69 +13258,46 @@ void MainWindow::displayCallActivity() {
 #else
             QString displayCall = d.call;
 #endif
-            bool hasThrough = !d.through.isEmpty();
 
-            auto iconItem = new QTableWidgetItem(hasMessage ? "\u2691" : hasACK ? "\u2605" : hasCQ ? "\u260E" : hasThrough ? "\u269F" : "");
-            iconItem->setData(Qt::UserRole, QVariant(d.call));
-            iconItem->setToolTip(
+            setTableItem(ui->tableWidgetCalls, row, col++,
+                hasMessage ? "\u2691" : hasACK ? "\u2605" : hasCQ ? "\u260E" : hasThrough ? "\u269F" : "",
+                d.call,
                 hasMessage ? "Message Available" :
                 hasACK ? QString("Hearing Your Station (%1)").arg(since(d.ackTimestamp)) :
                 hasCQ ? QString("Calling CQ (%1)").arg(since(d.cqTimestamp)) :
                 hasThrough ? QString("Heard Through Relay (%1)").arg(d.through) :
-                "");
-            iconItem->setTextAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
-            ui->tableWidgetCalls->setItem(row, col++, iconItem);
-            if(hasMessage || hasACK || hasCQ || hasThrough){
-                showIconColumn = true;
-            }
+                "",
+                Qt::AlignHCenter | Qt::AlignVCenter);
 
-            auto displayItem = new QTableWidgetItem(displayCall);
-            displayItem->setData(Qt::UserRole, QVariant(d.call));
-            displayItem->setToolTip(generateCallDetail(displayCall));
-            ui->tableWidgetCalls->setItem(row, col++, displayItem);
+            setTableItem(ui->tableWidgetCalls, row, col++, displayCall, d.call, generateCallDetail(displayCall));
 
 #if ONLY_SHOW_HEARD_CALLSIGNS
             if(d.utcTimestamp.isValid()){
 #else
             if(true){
 #endif
-                auto ageItem = new QTableWidgetItem(since(d.utcTimestamp));
-                ageItem->setTextAlignment(Qt::AlignCenter | Qt::AlignVCenter);
-                ageItem->setToolTip(d.utcTimestamp.toString());
-                ui->tableWidgetCalls->setItem(row, col++, ageItem);
+                setTableItem(ui->tableWidgetCalls, row, col++, since(d.utcTimestamp), QVariant(), d.utcTimestamp.toString(), Qt::AlignCenter | Qt::AlignVCenter);
 
                 auto snrText = Varicode::formatSNR(d.snr);
-                ui->tableWidgetCalls->setItem(row, col++, new QTableWidgetItem(snrText.isEmpty() ? "" : QString("%1 dB").arg(snrText)));
+                setTableItem(ui->tableWidgetCalls, row, col++, snrText.isEmpty() ? "" : QString("%1 dB").arg(snrText));
 
-                auto offsetItem = new QTableWidgetItem(QString("%1 Hz").arg(d.offset));
-                offsetItem->setData(Qt::UserRole, QVariant(d.offset));
-                ui->tableWidgetCalls->setItem(row, col++, offsetItem);
+                setTableItem(ui->tableWidgetCalls, row, col++, QString("%1 Hz").arg(d.offset), d.offset);
 
-                ui->tableWidgetCalls->setItem(row, col++, new QTableWidgetItem(QString("%1 ms").arg((int)(1000*d.tdrift))));
+                setTableItem(ui->tableWidgetCalls, row, col++, QString("%1 ms").arg((int)(1000*d.tdrift)));
 
                 auto name = submodeName(d.submode);
-                auto modeItem = new QTableWidgetItem(name.left(1).replace("H", "N"));
-                modeItem->setToolTip(name);
-                modeItem->setData(Qt::UserRole, QVariant(name));
-                modeItem->setTextAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
-                ui->tableWidgetCalls->setItem(row, col++, modeItem);
+                setTableItem(ui->tableWidgetCalls, row, col++, name.left(1).replace("H", "N"), name, name, Qt::AlignHCenter | Qt::AlignVCenter);
 
-                auto gridItem = new QTableWidgetItem(QString("%1").arg(d.grid.trimmed().left(4)));
-                gridItem->setToolTip(d.grid.trimmed());
-                ui->tableWidgetCalls->setItem(row, col++, gridItem);
+                auto gridItem = setTableItem(ui->tableWidgetCalls, row, col++, QString("%1").arg(d.grid.trimmed().left(4)), QVariant(), d.grid.trimmed());
 
-                auto distanceItem = new QTableWidgetItem(calculateDistance(d.grid));
-                distanceItem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
-                ui->tableWidgetCalls->setItem(row, col++, distanceItem);
+                auto distanceItem = setTableItem(ui->tableWidgetCalls, row, col++, calculateDistance(d.grid), QVariant(), QString(), Qt::AlignRight | Qt::AlignVCenter);
 
                 QString flag;
                 if(m_logBook.hasWorkedBefore(d.call, "")){
                     // unicode checkmark
                     flag = "\u2713";
                 }
-                auto workedBeforeItem = new QTableWidgetItem(flag);
-                workedBeforeItem->setTextAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
-                ui->tableWidgetCalls->setItem(row, col++, workedBeforeItem);
+                auto workedBeforeItem = setTableItem(ui->tableWidgetCalls, row, col++, flag, QVariant(), QString(), Qt::AlignHCenter | Qt::AlignVCenter);
 
                 QString logDetailGrid;
                 QString logDetailDate;
@@ -12908,83 +13326,55 @@ void MainWindow::displayCallActivity() {
                     workedBeforeItem->setToolTip(QString("Last Logged: %1").arg(lastLogged.toString()));
                 }
 
-                auto logNameItem = new QTableWidgetItem(logDetailName);
-                logNameItem->setTextAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
-                logNameItem->setToolTip(logDetailName);
-                ui->tableWidgetCalls->setItem(row, col++, logNameItem);
+                setTableItem(ui->tableWidgetCalls, row, col++, logDetailName, QVariant(), logDetailName, Qt::AlignHCenter | Qt::AlignVCenter);
 
-                auto logCommentItem = new QTableWidgetItem(logDetailComment);
-                logCommentItem->setTextAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
-                logCommentItem->setToolTip(logDetailComment);
-                ui->tableWidgetCalls->setItem(row, col++, logCommentItem);
+                setTableItem(ui->tableWidgetCalls, row, col++, logDetailComment, QVariant(), logDetailComment, Qt::AlignHCenter | Qt::AlignVCenter);
 
             } else {
-                ui->tableWidgetCalls->setItem(row, col++, new QTableWidgetItem("")); // age
-                ui->tableWidgetCalls->setItem(row, col++, new QTableWidgetItem("")); // snr
-                ui->tableWidgetCalls->setItem(row, col++, new QTableWidgetItem("")); // freq
-                ui->tableWidgetCalls->setItem(row, col++, new QTableWidgetItem("")); // tdrift
-                ui->tableWidgetCalls->setItem(row, col++, new QTableWidgetItem("")); // mode
-                ui->tableWidgetCalls->setItem(row, col++, new QTableWidgetItem("")); // grid
-                ui->tableWidgetCalls->setItem(row, col++, new QTableWidgetItem("")); // distance
-                ui->tableWidgetCalls->setItem(row, col++, new QTableWidgetItem("")); // worked before
-                ui->tableWidgetCalls->setItem(row, col++, new QTableWidgetItem("")); // log name
-                ui->tableWidgetCalls->setItem(row, col++, new QTableWidgetItem("")); // log comment
+                setTableItem(ui->tableWidgetCalls, row, col++, ""); // age
+                setTableItem(ui->tableWidgetCalls, row, col++, ""); // snr
+                setTableItem(ui->tableWidgetCalls, row, col++, ""); // freq
+                setTableItem(ui->tableWidgetCalls, row, col++, ""); // tdrift
+                setTableItem(ui->tableWidgetCalls, row, col++, ""); // mode
+                setTableItem(ui->tableWidgetCalls, row, col++, ""); // grid
+                setTableItem(ui->tableWidgetCalls, row, col++, ""); // distance
+                setTableItem(ui->tableWidgetCalls, row, col++, ""); // worked before
+                setTableItem(ui->tableWidgetCalls, row, col++, ""); // log name
+                setTableItem(ui->tableWidgetCalls, row, col++, ""); // log comment
             }
 
-            if (isCallSelected) {
-                for(int i = 0; i < ui->tableWidgetCalls->columnCount(); i++){
-                    ui->tableWidgetCalls->item(row, i)->setSelected(true);
-                }
-            }
+            QBrush background;
 
             if(hasCQ){
-                for(int i = 0; i < ui->tableWidgetCalls->columnCount(); i++){
-                    ui->tableWidgetCalls->item(row, i)->setBackground(QBrush(m_config.color_CQ()));
-                }
+                background = QBrush(m_config.color_CQ());
             }
 
             if (m_config.secondary_highlight_words().contains(call)){
-                for(int i = 0; i < ui->tableWidgetCalls->columnCount(); i++){
-                    ui->tableWidgetCalls->item(row, i)->setBackground(QBrush(m_config.color_secondary_highlight()));
-                }
+                background = QBrush(m_config.color_secondary_highlight());
             }
 
             if (m_config.primary_highlight_words().contains(call)){
-                for(int i = 0; i < ui->tableWidgetCalls->columnCount(); i++){
-                    ui->tableWidgetCalls->item(row, i)->setBackground(QBrush(m_config.color_primary_highlight()));
-                }
+                background = QBrush(m_config.color_primary_highlight());
             }
+
+            setTableRowBackground(ui->tableWidgetCalls, row, background);
+            setTableRowSignature(ui->tableWidgetCalls, row, signature);
+
+            row++;
+        }
+
+        if(row != ui->tableWidgetCalls->rowCount()){
+            rowsChanged = true;
         }
+        setTableRows(ui->tableWidgetCalls, row, selectedRow);
 
         // Set table color
-        auto style = QString("QTableWidget { background:%1; selection-background-color:%2; alternate-background-color:%1; color:%3; } "
-                             "QTableWidget::item:selected { background-color: %2; color: %3; }");
-        style = style.arg(m_config.color_table_background().name());
-        style = style.arg(m_config.color_table_highlight().name());
-        style = style.arg(m_config.color_table_foreground().name());
-        ui->tableWidgetCalls->setStyleSheet(style);
-
-        // Set the table palette for inactive selected row
-        auto p = ui->tableWidgetCalls->palette();
-        p.setColor(QPalette::Highlight, m_config.color_table_highlight());
-        p.setColor(QPalette::HighlightedText, m_config.color_table_foreground());
-        p.setColor(QPalette::Inactive, QPalette::Highlight, p.color(QPalette::Active, QPalette::Highlight));
-        ui->tableWidgetCalls->setPalette(p);
+        setTableStyle(ui->tableWidgetCalls, m_config.color_table_background(), m_config.color_table_highlight(), m_config.color_table_foreground());
 
-        // Set item fonts
-        for(int row = 0; row < ui->tableWidgetCalls->rowCount(); row++){
-            auto bold = ui->tableWidgetCalls->item(row,  0)->text() == "\u2691";
-            for(int col = 0; col < ui->tableWidgetCalls->columnCount(); col++){
-                auto item = ui->tableWidgetCalls->item(row, col);
-                if(item){
-                    auto f = m_config.table_font();
-                    if(bold){
-                        f.setBold(true);
-                    }
-                    item->setFont(f);
-                }
-            }
-        }
+        // Set item fonts, bold for a call with a message waiting
+        auto boldFont = m_config.table_font();
+        boldFont.setBold(true);
+        setTableFonts(ui->tableWidgetCalls, m_config.table_font(), boldFont, 0, "\u2691");
 
         // Column labels
         ui->tableWidgetCalls->horizontalHeader()->setVisible(showColumn("call", "labels"));
@@ -13003,18 +13393,20 @@ void MainWindow::displayCallActivity() {
         ui->tableWidgetCalls->setColumnHidden(10, !showColumn("call", "logName"));
         ui->tableWidgetCalls->setColumnHidden(11, !showColumn("call", "logComment"));
 
-        // Resize the table columns
-        ui->tableWidgetCalls->resizeColumnToContents(0);
-        ui->tableWidgetCalls->resizeColumnToContents(1);
-        ui->tableWidgetCalls->resizeColumnToContents(2);
-        ui->tableWidgetCalls->resizeColumnToContents(3);
-        ui->tableWidgetCalls->resizeColumnToContents(4);
-        ui->tableWidgetCalls->resizeColumnToContents(5);
-        ui->tableWidgetCalls->resizeColumnToContents(6);
-        ui->tableWidgetCalls->resizeColumnToContents(7);
-        ui->tableWidgetCalls->resizeColumnToContents(8);
-        ui->tableWidgetCalls->resizeColumnToContents(9);
-        ui->tableWidgetCalls->resizeColumnToContents(10);
+        // Resize the table columns, only when what's in them changed
+        if(rowsChanged){
+            ui->tableWidgetCalls->resizeColumnToContents(0);
+            ui->tableWidgetCalls->resizeColumnToContents(1);
+            ui->tableWidgetCalls->resizeColumnToContents(2);
+            ui->tableWidgetCalls->resizeColumnToContents(3);
+            ui->tableWidgetCalls->resizeColumnToContents(4);
+            ui->tableWidgetCalls->resizeColumnToContents(5);
+            ui->tableWidgetCalls->resizeColumnToContents(6);
+            ui->tableWidgetCalls->resizeColumnToContents(7);
+            ui->tableWidgetCalls->resizeColumnToContents(8);
+            ui->tableWidgetCalls->resizeColumnToContents(9);
+            ui->tableWidgetCalls->resizeColumnToContents(10);
+        }
 
         // Reset the scroll position
         ui->tableWidgetCalls->verticalScrollBar()->setValue(currentScrollPos);
@@ -13385,6 +13777,57 @@ void MainWindow::networkMessage(Message const &message)
         return;
     }
 
+    // TRACE.GET_STATS - Get the decode pipeline latency percentiles (ms) and counters
+    // TRACE.RESET - Clear the collected latencies
+    // TRACE.DUMP - Write the latency percentiles to decode_trace.csv in the data directory
+    if(type == "TRACE.GET_STATS"){
+        QMap<QString, QVariant> stages = {
+            {"_ID", id},
+        };
+
+        auto stats = DecodeTrace::stats();
+        foreach(auto stage, stats.keys()){
+            auto st = stats.value(stage);
+
+            QMap<QString, QVariant> detail;
+            detail["COUNT"] = QVariant(st.count);
+            detail["TOTAL"] = QVariant(st.total);
+            detail["P50"] = QVariant(st.p50);
+            detail["P95"] = QVariant(st.p95);
+            detail["P99"] = QVariant(st.p99);
+            detail["MAX"] = QVariant(st.max);
+            stages[stage] = QVariant(detail);
+        }
+
+        QMap<QString, QVariant> counts;
+        auto totals = DecodeTrace::counts();
+        foreach(auto counter, totals.keys()){
+            counts[counter] = QVariant(totals.value(counter));
+        }
+        stages["COUNTS"] = QVariant(counts);
+
+        sendNetworkMessage("TRACE.STATS", "", stages);
+        return;
+    }
+
+    if(type == "TRACE.RESET"){
+        DecodeTrace::reset();
+        return;
+    }
+
+    if(type == "TRACE.DUMP"){
+        // always our own file, a client must not pick what gets overwritten
+        QString path = m_config.writeable_data_dir().absoluteFilePath("decode_trace.csv");
+        if(!DecodeTrace::writeCsv(path)){
+            path = "";
+        }
+
+        sendNetworkMessage("TRACE.DUMP", QDir::toNativeSeparators(path), {
+            {"_ID", id},
+        });
+        return;
+    }
+
     // WINDOW.RAISE
 
     if(type == "WINDOW.RAISE"){
@@ -52,6 +52,7 @@
 #include "NotificationAudio.h"
 #include "ProcessThread.h"
 #include "Decoder.h"
+#include "DecoderEngine.h"
 
 #define NUM_JT4_SYMBOLS 206                //(72+31)*2, embedded sync
 #define NUM_JT65_SYMBOLS 126               //63 data + 63 sync
@@ -92,6 +93,7 @@ class MultiSettings;
 class EqualizationToolsDialog;
 class DecodedText;
 class JSCChecker;
+class HeardStore;
 
 using namespace std;
 typedef std::function<void()> Callback;
@@ -137,6 +139,7 @@ public slots:
   bool hasClosedExistingMessageBuffer(int offset);
   void logCallActivity(CallDetail d, bool spot=true);
   void logHeardGraph(QString from, QString to);
+  void addHeardGraph(QString from, QString to);
   QString lookupCallInCompoundCache(QString const &call);
   void cacheActivity(QString key);
   void restoreActivity(QString key);
@@ -144,7 +147,7 @@ public slots:
   void clearBandActivity();
   void clearRXActivity();
   void clearCallActivity();
-  void createGroupCallsignTableRows(QTableWidget *table, const QString &selectedCall);
+  int createGroupCallsignTableRows(QTableWidget *table);
   void displayTextForFreq(QString text, int freq, QDateTime date, bool isTx, bool isNewLine, bool isLast);
   void writeNoticeTextToUI(QDateTime date, QString text);
   int writeMessageTextToUI(QDateTime date, QString text, int freq, bool isTx, int block=-1);
@@ -172,6 +175,9 @@ public slots:
   int rxThreshold(int submode);
   int rxSnrThreshold(int submode);
   void processDecodedLine(QByteArray t);
+  void processDecodedText(DecodedText const &decodedtext, QString const &rawText);
+  void processDecodeEvent(decode_event event);
+  void processDecodeEvents(QVector<decode_event> events);
 
 protected:
   void keyPressEvent (QKeyEvent *) override;
@@ -254,6 +260,11 @@ private slots:
   void decodePrepareSaveAudio(int submode);
   void decodeBusy(bool b);
   void decodeDone ();
+  void decodeStarted();
+  void decodeTiming(int m, float tslot, float tsync, float tdecode, int nfft, int nfftreused);
+  void decodePlanned(float tplan);
+  void decodeSyncStat(int m, int f, int s, float xdt, bool decoded);
+  void decodeFinished(int ndecoded);
   void decodeCheckHangingDecoder();
   void on_EraseButton_clicked();
   void set_dateTimeQSO(int m_ntx);
@@ -448,6 +459,7 @@ private slots:
   void checkStartupWarnings ();
   void clearCallsignSelected();
   void refreshTextDisplay();
+  void textFramesBuilt(QString text, QString transmitText, int frames);
 
 private:
   Q_SIGNAL void apiSetMaxConnections(int n);
@@ -529,12 +541,15 @@ private:
   Modulator * m_modulator;
   SoundOutput * m_soundOutput;
   NotificationAudio * m_notification;
+  BuildMessageFramesWorker * m_buildFramesWorker;
 
   QMutex m_networkThreadMutex;
   QThread m_networkThread;
   QThread m_audioThread;
   QThread m_notificationAudioThread;
+  QThread m_buildFramesThread;
   Decoder m_decoder;
+  DecoderEngine m_decoderEngine;
 
   qint64  m_msErase;
   qint64  m_secBandChanged;
@@ -562,6 +577,8 @@ private:
   qint32  m_XIT;
   qint32  m_setftx;
   qint32  m_ndepth;
+  qint32  m_decoderThreads;
+  bool    m_decoderInProcess;
   qint32  m_sec0;
   qint32  m_RxLog;
   qint32  m_nutc0;
@@ -824,6 +841,8 @@ private:
   QDateTime m_lastTxStopTime;
   qint32 m_driftMsMMA;
   qint32 m_driftMsMMA_N;
+  qint32 m_decodeSyncStart;
+  QList<qint32> m_driftQueue;
 
   enum Priority {
     PriorityLow    =   10,
@@ -855,6 +874,7 @@ private:
       int submode;
       int start;
       int sz;
+      qint64 queued;    // DecodeTrace::now()
   };
 
   struct CachedFrame {
@@ -888,11 +908,11 @@ private:
 
   QMap<QString, int> m_rxInboxCountCache; // call -> count
 
-  QMap<QString, QMap<QString, CallDetail>> m_callActivityBandCache; // band -> call activity
   QMap<QString, QMap<int, QList<ActivityDetail>>> m_bandActivityBandCache; // band -> band activity
   QMap<QString, QString> m_rxTextBandCache; // band -> rx text
-  QMap<QString, QMap<QString, QSet<QString>>> m_heardGraphOutgoingBandCache; // band -> heard in
-  QMap<QString, QMap<QString, QSet<QString>>> m_heardGraphIncomingBandCache; // band -> heard out
+  QScopedPointer<HeardStore> m_heardStore; // band -> call activity and heard graph, across sessions
+  QTimer m_heardStoreFlush;
+  QMap<QString, QDateTime> m_callActivityClearedAt; // band -> when its call activity was last cleared
 
   JSCChecker * m_checker;
 
@@ -933,6 +953,7 @@ private:
   QSharedMemory *mem_js8;
 
   LogBook m_logBook;
+  int m_logBookGeneration;      // bumped when the log changes, the call table rows show it
   QString m_QSOText;
   unsigned m_msAudioOutputBuffered;
   unsigned m_framesAudioInputBuffered;
@@ -1040,6 +1061,8 @@ private:
   void processBufferedActivity();
   void processCommandActivity();
   QString inboxPath();
+  QString heardPath();
+  QDateTime heardSince(QString band);
   void refreshInboxCounts();
   bool hasMessageHistory(QString call);
   int addCommandToMyInbox(CommandDetail d);
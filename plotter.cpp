@@ -95,13 +95,10 @@ void CPlotter::resizeEvent(QResizeEvent* )                    //resizeEvent()
     m_DialOverlayPixmap.fill(Qt::transparent);
     m_HoverOverlayPixmap = QPixmap(m_Size.width(), m_h);
     m_HoverOverlayPixmap.fill(Qt::transparent);
-    m_2DPixmap = QPixmap(m_Size.width(), m_h2);
-    m_2DPixmap.fill(Qt::black);
-    m_WaterfallPixmap = QPixmap(m_Size.width(), m_h1);
+    m_Waterfall.resize(m_Size.width(), m_h1);
     m_OverlayPixmap = QPixmap(m_Size.width(), m_h2);
     m_OverlayPixmap.fill(Qt::black);
-    m_WaterfallPixmap.fill(Qt::black);
-    m_2DPixmap.fill(Qt::black);
+    m_2DLine.clear();
     m_ScalePixmap = QPixmap(m_w,30);
     m_ScalePixmap.fill(Qt::white);
     m_Percent2DScreen0 = m_Percent2DScreen;
@@ -115,8 +112,16 @@ void CPlotter::paintEvent(QPaintEvent *)                                // paint
   m_paintEventBusy=true;
   QPainter painter(this);
   painter.drawPixmap(0,0,m_ScalePixmap);
-  painter.drawPixmap(0,30,m_WaterfallPixmap);
-  painter.drawPixmap(0,m_h1,m_2DPixmap);
+  m_Waterfall.draw(painter,0,30);
+  painter.drawPixmap(0,m_h1,m_OverlayPixmap);
+  if(!m_2DLine.isEmpty()) {
+    painter.save();
+    painter.setClipRect(0,m_h1,m_w,m_h2);
+    painter.translate(0,m_h1);
+    painter.setPen(m_2DColor);
+    painter.drawPolyline(m_2DLine);
+    painter.restore();
+  }
 
   int x = XfromFreq(m_rxFreq);
   painter.drawPixmap(x,0,m_DialOverlayPixmap);
@@ -135,7 +140,6 @@ void CPlotter::paintEvent(QPaintEvent *)                                // paint
 void CPlotter::draw(float swide[], bool bScroll, bool bRed)
 {
   int j,j0;
-  static int ktop=0;
   float y,y2,ymin;
   double fac = sqrt(m_binsPerPixel*m_waterfallAvg/15.0);
   double gain = fac*pow(10.0,0.015*m_plotGain);
@@ -143,30 +147,18 @@ void CPlotter::draw(float swide[], bool bScroll, bool bRed)
 
   if(m_bReference != m_bReference0) resizeEvent(NULL);
   m_bReference0=m_bReference;
-
-//move current data down one line (must do this before attaching a QPainter object)
-  if(bScroll and !m_bReplot) m_WaterfallPixmap.scroll(0,1,0,0,m_w,m_h1);
-  QPainter painter1(&m_WaterfallPixmap);
-  m_2DPixmap = m_OverlayPixmap.copy(0,0,m_w,m_h2);
-  QPainter painter2D(&m_2DPixmap);
-  if(!painter2D.isActive()) return;
-  QFont Font("Arial");
-  Font.setPointSize(12);
-  Font.setWeight(QFont::Normal);
-  painter2D.setFont(Font);
+  if(m_Waterfall.isNull()) return;
 
   if(m_bLinearAvg) {
-    painter2D.setPen(Qt::yellow);
+    m_2DColor=Qt::yellow;
   } else if(m_bReference) {
-    painter2D.setPen(Qt::blue);
+    m_2DColor=Qt::blue;
   } else {
-    painter2D.setPen(Qt::green);
+    m_2DColor=Qt::green;
   }
-  static QPoint LineBuf[MAX_SCREENSIZE];
-  static QPoint LineBuf2[MAX_SCREENSIZE];
   j=0;
   j0=int(m_startFreq/m_fftBinWidth + 0.5);
-  int iz=XfromFreq(5000.0);
+  int iz=qMin(XfromFreq(5000.0), MAX_SCREENSIZE);   //swide holds MAX_SCREENSIZE
   int jz=iz*m_binsPerPixel;
   m_fMax=FreqfromX(iz);
 
@@ -175,27 +167,35 @@ void CPlotter::draw(float swide[], bool bScroll, bool bRed)
     // if(!m_bReplot) flat4_(&dec_data.savg[j0],&jz,&m_Flatten);
   }
 
-  ymin=1.e30;
-  if(swide[0]>1.e29 and swide[0]< 1.5e30) painter1.setPen(Qt::green); // horizontal line
-  if(swide[0]>1.4e30) painter1.setPen(Qt::yellow);
+  // the color of the horizontal lines, which have no levels
+  QRgb marker=qRgb(0,0,0);
+  if(swide[0]>1.e29 and swide[0]< 1.5e30) marker=qRgb(0,255,0);
+  if(swide[0]>1.4e30) marker=qRgb(255,255,0);
 
   if(!m_bReplot) {
     m_j=0;
     int irow=-1;
     plotsave_(swide,&m_w,&m_h1,&irow);
   }
+
+//write the row straight into the waterfall, scrolling it moves the top
+//row rather than the pixels
+  QRgb *row = (bScroll and !m_bReplot) ? m_Waterfall.scroll() : m_Waterfall.row(m_j);
+  QRgb const *palette = m_Waterfall.palette();
+  ymin=1.e30;
   for(int i=0; i<iz; i++) {
     y=swide[i];
     if(y<ymin) ymin=y;
     int y1 = 10.0*gain*y + m_plotZero;
     if (y1<0) y1=0;
     if (y1>254) y1=254;
-    if (swide[i]<1.e29) painter1.setPen(g_ColorTbl[y1]);
-    painter1.drawPoint(i,m_j);
+    row[i] = (swide[i]<1.e29) ? palette[y1] : marker;
   }
+  for(int i=iz; i<m_Waterfall.width(); i++) row[i]=qRgb(0,0,0);
 
   m_line++;
 
+  m_2DLine.resize(iz);
   float y2min=1.e30;
   float y2max=-1.e30;
   for(int i=0; i<iz; i++) {
@@ -231,15 +231,7 @@ void CPlotter::draw(float swide[], bool bScroll, bool bRed)
 
     }
 
-    if(i==iz-1) {
-      painter2D.drawPolyline(LineBuf,j);
-      if(m_mode=="QRA64") {
-        painter2D.setPen(Qt::red);
-        painter2D.drawPolyline(LineBuf2,ktop);
-      }
-    }
-    LineBuf[j].setX(i);
-    LineBuf[j].setY(int(0.9*m_h2-y2*m_h2/70.0));
+    m_2DLine.setPoint(j,i,int(0.9*m_h2-y2*m_h2/70.0));
     if(y2<y2min) y2min=y2;
     if(y2>y2max) y2max=y2;
     j++;
@@ -247,8 +239,9 @@ void CPlotter::draw(float swide[], bool bScroll, bool bRed)
   if(m_bReplot) return;
 
   if(swide[0]>1.0e29) m_line=0;
-  if(m_line == painter1.fontMetrics ().height ()) {
-    painter1.setPen(Qt::white);
+  QFont rowFont;
+  QFontMetrics fm {rowFont};
+  if(m_line == fm.height ()) {
     QString t;
     qint64 ms = DriftingDateTime::currentMSecsSinceEpoch() % 86400000;
     int n=(ms/1000) % m_TRperiod;
@@ -258,23 +251,11 @@ void CPlotter::draw(float swide[], bool bScroll, bool bRed)
     } else {
       t=t1.toString("hh:mm") + "    " + m_rxBand;
     }
-    painter1.drawText (5, painter1.fontMetrics ().ascent (), t);
-  }
-
-  if(m_mode=="JT4" or m_mode=="QRA64") {
-    QPen pen3(Qt::yellow);                     //Mark freqs of JT4 single-tone msgs
-    painter2D.setPen(pen3);
-    Font.setWeight(QFont::Bold);
-    painter2D.setFont(Font);
-    int x1=XfromFreq(m_rxFreq);
-    y=0.2*m_h2;
-    painter2D.drawText(x1-4,y,"T");
-    x1=XfromFreq(m_rxFreq+250);
-    painter2D.drawText(x1-4,y,"M");
-    x1=XfromFreq(m_rxFreq+500);
-    painter2D.drawText(x1-4,y,"R");
-    x1=XfromFreq(m_rxFreq+750);
-    painter2D.drawText(x1-4,y,"73");
+    m_Waterfall.paintRows([&](QPainter &painter1){
+      painter1.setFont(rowFont);
+      painter1.setPen(Qt::white);
+      painter1.drawText (5, fm.ascent (), t);
+    });
   }
 
   update();                                    //trigger a new paintEvent
@@ -288,20 +269,22 @@ void CPlotter::drawDecodeLine(const QColor &color, int ia, int ib)
 
   QPen pen0(color, 1);
 
-  QPainter painter1(&m_WaterfallPixmap);
-  painter1.setPen(pen0);
-  painter1.drawLine(qMin(x1, x2),4,qMax(x1, x2),4);
-  painter1.drawLine(qMin(x1, x2),0,qMin(x1, x2),9);
-  painter1.drawLine(qMax(x1, x2),0,qMax(x1, x2),9);
+  m_Waterfall.paintRows([&](QPainter &painter1){
+    painter1.setPen(pen0);
+    painter1.drawLine(qMin(x1, x2),4,qMax(x1, x2),4);
+    painter1.drawLine(qMin(x1, x2),0,qMin(x1, x2),9);
+    painter1.drawLine(qMax(x1, x2),0,qMax(x1, x2),9);
+  });
 }
 
 void CPlotter::drawHorizontalLine(const QColor &color, int x, int width)
 {
   QPen pen0(color, 1);
 
-  QPainter painter1(&m_WaterfallPixmap);
-  painter1.setPen(pen0);
-  painter1.drawLine(x,0,width <= 0 ? m_w : x+width,0);
+  m_Waterfall.paintRows([&](QPainter &painter1){
+    painter1.setPen(pen0);
+    painter1.drawLine(x,0,width <= 0 ? m_w : x+width,0);
+  });
 }
 
 void CPlotter::replot()
@@ -320,8 +303,8 @@ void CPlotter::replot()
 void CPlotter::DrawOverlay()                   //DrawOverlay()
 {
   if(m_OverlayPixmap.isNull()) return;
-  if(m_WaterfallPixmap.isNull()) return;
-  int w = m_WaterfallPixmap.width();
+  if(m_Waterfall.isNull()) return;
+  int w = m_Waterfall.width();
   int x,y,x1,x2,x3,x4,x5,x6;
   float pixperdiv;
 
@@ -664,7 +647,7 @@ int CPlotter::startFreq()                              //startFreq()
   return m_startFreq;
 }
 
-int CPlotter::plotWidth(){return m_WaterfallPixmap.width();}     //plotWidth
+int CPlotter::plotWidth(){return m_Waterfall.width();}           //plotWidth
 void CPlotter::UpdateOverlay() {DrawOverlay();}                  //UpdateOverlay
 void CPlotter::setDataFromDisk(bool b) {m_dataFromDisk=b;}       //setDataFromDisk
 
@@ -886,6 +869,7 @@ QVector<QColor> const& CPlotter::colors(){
 void CPlotter::setColours(QVector<QColor> const& cl)
 {
   g_ColorTbl = cl;
+  m_Waterfall.setColors(cl);
 }
 
 void CPlotter::SetPercent2DScreen(int percent)
@@ -15,9 +15,12 @@
 #endif
 #include <QFrame>
 #include <QImage>
+#include <QPolygon>
 #include <QVector>
 #include <cstring>
 
+#include "WaterfallImage.h"
+
 #define VERT_DIVS 7	//specify grid screen divisions
 #define HORZ_DIVS 20
 
@@ -148,10 +151,11 @@ private:
   QPixmap m_FilterOverlayPixmap;
   QPixmap m_DialOverlayPixmap;
   QPixmap m_HoverOverlayPixmap;
-  QPixmap m_WaterfallPixmap;
-  QPixmap m_2DPixmap;
+  WaterfallImage m_Waterfall;
   QPixmap m_ScalePixmap;
   QPixmap m_OverlayPixmap;
+  QPolygon m_2DLine;        // the 2D spectrum, drawn over m_OverlayPixmap
+  QColor  m_2DColor;
 
   QSize   m_Size;
   QString m_Str;
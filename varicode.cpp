@@ -27,7 +27,6 @@
 
 #include "varicode.h"
 #include "jsc.h"
-#include "decodedtext.h"
 
 #include <cmath>
 
@@ -205,6 +204,150 @@ QMap<QString, QString> hufftable = {
 QChar ESC = '\\';   // Escape char
 QChar EOT = '\x04'; // EOT char
 
+namespace {
+    /**
+     * a huffman table compiled once for encoding and decoding
+     *
+     * The text is encoded by looking up the keys starting with the next
+     * character, longest first. The bits are decoded by looking up the
+     * next maxLength bits in a table of every code padded out to
+     * maxLength bits, which for a prefix free code holds the one code
+     * they start with.
+     */
+    class HuffCodec {
+    public:
+        explicit HuffCodec(QMap<QString, QString> const &huff):
+            m_maxLength(0)
+        {
+            QList<QString> keys;
+            for(auto it = huff.constBegin(); it != huff.constEnd(); ++it){
+                // an empty key or code would never advance
+                if(it.key().isEmpty() || it.value().isEmpty()){
+                    continue;
+                }
+                keys.append(it.key());
+                m_maxLength = qMax(m_maxLength, it.value().length());
+            }
+
+            // the codes are short, 8 bits for the default table
+            Q_ASSERT(m_maxLength <= 16);
+
+            // longest keys first, as the encoder has always tried them
+            qSort(keys.begin(), keys.end(), [](QString const &a, QString const &b){
+                if(a.length() != b.length()){
+                    return b.length() < a.length();
+                }
+                return b < a;
+            });
+            foreach(auto key, keys){
+                m_keys[key.at(0)].append({ key, Varicode::strToBits(huff[key]) });
+            }
+
+            // the first key of the table wins where codes overlap
+            m_codes.resize(1 << m_maxLength);
+            for(auto it = huff.constEnd(); it != huff.constBegin(); ){
+                --it;
+                int length = it.value().length();
+                if(it.key().isEmpty() || length == 0){
+                    continue;
+                }
+                int first = Varicode::bitsToInt(Varicode::strToBits(it.value())) << (m_maxLength - length);
+                int last = first + (1 << (m_maxLength - length));
+                for(int i = first; i < last; i++){
+                    m_codes[i] = { it.key(), length };
+                }
+            }
+        }
+
+        // the codes of the keys in text, until the codes would take maxBits
+        QList<QPair<int, BitVector>> encode(QString const &text, int maxBits=-1) const {
+            QList<QPair<int, BitVector>> out;
+
+            int bits = 0;
+            int i = 0;
+            while(i < text.length()){
+                bool found = false;
+                auto keys = m_keys.constFind(text.at(i));
+                if(keys != m_keys.constEnd()){
+                    foreach(auto const &key, *keys){
+                        if(text.midRef(i).startsWith(key.key)){
+                            bits += key.bits.length();
+                            if(maxBits >= 0 && bits >= maxBits){
+                                return out;
+                            }
+                            out.append({ key.key.length(), key.bits });
+                            i += key.key.length();
+                            found = true;
+                            break;
+                        }
+                    }
+                }
+
+                if(!found){
+                    i++;
+                }
+            }
+
+            return out;
+        }
+
+        QString decode(BitVector const &bitvec) const {
+            QString text;
+
+            int n = bitvec.length();
+            int i = 0;
+            while(i < n){
+                // the next m_maxLength bits, zero filled past the end
+                int peek = qMin(m_maxLength, n - i);
+                int value = bitvec.value(i, peek) << (m_maxLength - peek);
+
+                auto const &code = m_codes.at(value);
+                if(code.length == 0 || i + code.length > n){
+                    break;
+                }
+                if(code.key == EOT){
+                    text.append(" ");
+                    break;
+                }
+                text.append(code.key);
+                i += code.length;
+            }
+
+            return text;
+        }
+
+        QSet<QString> validChars() const {
+            QSet<QString> chars;
+            foreach(auto const &keys, m_keys){
+                foreach(auto const &key, keys){
+                    chars.insert(key.key);
+                }
+            }
+            return chars;
+        }
+
+    private:
+        struct Key {
+            QString key;
+            BitVector bits;
+        };
+
+        struct Code {
+            QString key;
+            int length;         // 0 where no code starts with the bits
+        };
+
+        QHash<QChar, QList<Key>> m_keys;    // first char -> keys, longest first
+        QVector<Code> m_codes;              // next m_maxLength bits -> code
+        int m_maxLength;
+    };
+
+    HuffCodec const &defaultHuffCodec(){
+        static HuffCodec const codec(hufftable);
+        return codec;
+    }
+}
+
 quint32 nbasecall = 37 * 36 * 10 * 27 * 27 * 27;
 quint16 nbasegrid = 180 * 180;
 quint16 nusergrid = nbasegrid + 10;
@@ -546,139 +689,74 @@ QStringList Varicode::parseGrids(const QString &input){
     return grids;
 }
 
-QList<QPair<int, QVector<bool>>> Varicode::huffEncode(const QMap<QString, QString> &huff, QString const& text){
-    QList<QPair<int, QVector<bool>>> out;
-
-    int i = 0;
-
-    auto keys = huff.keys();
-    qSort(keys.begin(), keys.end(), [](QString const &a, QString const &b){
-        auto alen = a.length();
-        auto blen = b.length();
-        if(blen < alen){
-            return true;
-        }
-        if(alen < blen){
-            return false;
-        }
-
-        return b < a;
-    });
-
-    while(i < text.length()){
-        bool found = false;
-        foreach(auto ch, keys){
-            if(text.midRef(i).startsWith(ch)){
-                out.append({ ch.length(), Varicode::strToBits(huff[ch])});
-                i += ch.length();
-                found = true;
-                break;
-            }
-        }
-
-        if(!found){
-            i++;
-        }
+QList<QPair<int, BitVector>> Varicode::huffEncode(const QMap<QString, QString> &huff, QString const& text){
+    if(huff == hufftable){
+        return defaultHuffCodec().encode(text);
     }
-
-    return out;
+    return HuffCodec(huff).encode(text);
 }
 
-QString Varicode::huffDecode(QMap<QString, QString> const &huff, QVector<bool> const& bitvec){
-    QString text;
-
-    QString bits = Varicode::bitsToStr(bitvec);
-
-    // TODO: jsherer - this is naive...
-    while(bits.length() > 0){
-        bool found = false;
-        foreach(auto key, huff.keys()){
-            if(bits.startsWith(huff[key])){
-                if(key == EOT){
-                    text.append(" ");
-                    found = false;
-                    break;
-                }
-                text.append(key);
-                bits = bits.mid(huff[key].length());
-                found = true;
-            }
-        }
-        if(!found){
-            break;
-        }
+QString Varicode::huffDecode(QMap<QString, QString> const &huff, BitVector const& bitvec){
+    if(huff == hufftable){
+        return defaultHuffCodec().decode(bitvec);
     }
-
-    return text;
+    return HuffCodec(huff).decode(bitvec);
 }
 
 QSet<QString> Varicode::huffValidChars(const QMap<QString, QString> &huff){
+    if(huff == hufftable){
+        static QSet<QString> const chars = defaultHuffCodec().validChars();
+        return chars;
+    }
     return QSet<QString>::fromList(huff.keys());
 }
 
-// convert char* array of 0 bytes and 1 bytes to bool vector
-QVector<bool> Varicode::bytesToBits(char *bitvec, int n){
-    QVector<bool> bits;
+// convert char* array of 0 bytes and 1 bytes to bit vector
+BitVector Varicode::bytesToBits(char *bitvec, int n){
+    BitVector bits;
     for(int i = 0; i < n; i++){
         bits.append(bitvec[i] == 0x01);
     }
     return bits;
 }
 
-// convert string of 0s and 1s to bool vector
-QVector<bool> Varicode::strToBits(QString const& bitvec){
-    QVector<bool> bits;
+// convert string of 0s and 1s to bit vector
+BitVector Varicode::strToBits(QString const& bitvec){
+    BitVector bits;
     foreach(auto ch, bitvec){
         bits.append(ch == '1');
     }
     return bits;
 }
 
-QString Varicode::bitsToStr(QVector<bool> const& bitvec){
+QString Varicode::bitsToStr(BitVector const& bitvec){
     QString bits;
-    foreach(auto bit, bitvec){
-        bits.append(bit ? "1" : "0");
+    for(int i = 0, n = bitvec.size(); i < n; i++){
+        bits.append(bitvec.at(i) ? "1" : "0");
     }
     return bits;
 }
 
-QVector<bool> Varicode::intToBits(quint64 value, int expected){
-    QVector<bool> bits;
-
-    while(value){
-        bits.prepend((bool)(value & 1));
-        value = value >> 1;
-    }
-
-    if(expected){
-        while(bits.count() < expected){
-            bits.prepend((bool) 0);
-        }
+// the bits of value, zero padded on the left to at least expected bits
+BitVector Varicode::intToBits(quint64 value, int expected){
+    int n = 0;
+    while(n < 64 && (value >> n)){
+        n++;
     }
 
+    BitVector bits;
+    bits.append(value, qMax(n, qMin(expected, 64)));
     return bits;
 }
 
-quint64 Varicode::bitsToInt(QVector<bool> const value){
-    quint64 v = 0;
-    foreach(bool bit, value){
-        v = (v << 1) + (int)(bit);
-    }
-    return v;
+// the value of the last 64 bits
+quint64 Varicode::bitsToInt(BitVector const& value){
+    int n = qMin(value.size(), 64);
+    return value.value(value.size() - n, n);
 }
 
-quint64 Varicode::bitsToInt(QVector<bool>::ConstIterator start, int n){
-    quint64 v = 0;
-    for(int i = 0; i < n; i++){
-        int bit = (int)(*start);
-        v = (v << 1) + (int)(bit);
-        start++;
-    }
-    return v;
-}
-
-QVector<bool> Varicode::bitsListToBits(QList<QVector<bool>> &list){
-    QVector<bool> out;
+BitVector Varicode::bitsListToBits(QList<BitVector> &list){
+    BitVector out;
     foreach(auto vec, list){
         out += vec;
     }
@@ -1477,13 +1555,12 @@ QString Varicode::packCompoundFrame(const QString &callsign, quint8 type, quint1
     quint8 packed_8 = (packed_5 << 3) | bits3;
 
     // [3][50][11],[5][3] = 72
-    auto bits = (
-        Varicode::intToBits(packed_flag,  3) +
-        Varicode::intToBits(packed_callsign, 50) +
-        Varicode::intToBits(packed_11,   11)
-    );
+    BitVector bits;
+    bits.append(packed_flag,      3);
+    bits.append(packed_callsign, 50);
+    bits.append(packed_11,       11);
 
-    return Varicode::pack72bits(Varicode::bitsToInt(bits), packed_8);
+    return Varicode::pack72bits(bits.value(0, 64), packed_8);
 }
 
 QStringList Varicode::unpackCompoundFrame(const QString &text, quint8 *pType, quint16 *pNum, quint8 *pBits3){
@@ -1500,15 +1577,15 @@ QStringList Varicode::unpackCompoundFrame(const QString &text, quint8 *pType, qu
     quint8 packed_5 = packed_8 >> 3;
     quint8 packed_3 = packed_8 & ((1<<3)-1);
 
-    quint8 packed_flag = Varicode::bitsToInt(bits.mid(0, 3));
+    quint8 packed_flag = bits.value(0, 3);
 
     // needs to be a ping type...
     if(packed_flag == Varicode::FrameData || packed_flag == Varicode::FrameDirected){
         return unpacked;
     }
 
-    quint64 packed_callsign = Varicode::bitsToInt(bits.mid(3, 50));
-    quint16 packed_11 = Varicode::bitsToInt(bits.mid(53, 11));
+    quint64 packed_callsign = bits.value(3, 50);
+    quint16 packed_11 = bits.value(53, 11);
 
     QString callsign = Varicode::unpackAlphaNumeric50(packed_callsign);
 
@@ -1615,16 +1692,15 @@ QString Varicode::packDirectedMessage(const QString &text, const QString &mycall
     );
 
     // [3][28][28][5],[2][6] = 72
-    auto bits = (
-        Varicode::intToBits(packed_flag,      3) +
-        Varicode::intToBits(packed_from,     28) +
-        Varicode::intToBits(packed_to,       28) +
-        Varicode::intToBits(packed_cmd % 32,  5)
-    );
+    BitVector bits;
+    bits.append(packed_flag,      3);
+    bits.append(packed_from,     28);
+    bits.append(packed_to,       28);
+    bits.append(packed_cmd % 32,  5);
 
     if(pCmd) *pCmd = cmdOut;
     if(n) *n = match.captured(0).length();
-    return Varicode::pack72bits(Varicode::bitsToInt(bits), packed_extra);
+    return Varicode::pack72bits(bits.value(0, 64), packed_extra);
 }
 
 QStringList Varicode::unpackDirectedMessage(const QString &text, quint8 *pType){
@@ -1638,14 +1714,14 @@ QStringList Varicode::unpackDirectedMessage(const QString &text, quint8 *pType){
     quint8 extra = 0;
     auto bits = Varicode::intToBits(Varicode::unpack72bits(text, &extra), 64);
 
-    quint8 packed_flag = Varicode::bitsToInt(bits.mid(0, 3));
+    quint8 packed_flag = bits.value(0, 3);
     if(packed_flag != Varicode::FrameDirected){
         return unpacked;
     }
 
-    quint32 packed_from = Varicode::bitsToInt(bits.mid(3, 28));
-    quint32 packed_to = Varicode::bitsToInt(bits.mid(31, 28));
-    quint8 packed_cmd = Varicode::bitsToInt(bits.mid(59, 5));
+    quint32 packed_from = bits.value(3, 28);
+    quint32 packed_to = bits.value(31, 28);
+    quint8 packed_cmd = bits.value(59, 5);
 
     bool portable_from = ((extra >> 7) & 1) == 1;
     bool portable_to = ((extra >> 6) & 1) == 1;
@@ -1671,7 +1747,18 @@ QStringList Varicode::unpackDirectedMessage(const QString &text, quint8 *pType){
     return unpacked;
 }
 
-QString packHuffMessage(const QString &input, const QVector<bool> prefix, int *n){
+// only messages made of valid chars can be huffman coded
+bool isHuffEncodable(QString const &input){
+    static const QSet<QString> validChars = Varicode::huffValidChars(Varicode::defaultHuffTable());
+    foreach(auto ch, input){
+        if(!validChars.contains(ch.toUpper())){
+            return false;
+        }
+    }
+    return true;
+}
+
+QString packHuffMessage(const QString &input, BitVector const &prefix, int *n){
     static const int frameSize = 72;
 
     QString frame;
@@ -1681,7 +1768,7 @@ QString packHuffMessage(const QString &input, const QVector<bool> prefix, int *n
     // but, since none of the other frame types start with a 0, we can drop the two zeros and use
     // them for encoding the first two bits of the actuall data sent. boom!
     // The second bit is a flag that indicates this is not compressed frame (huffman coding)
-    QVector<bool> frameBits;
+    BitVector frameBits;
     if(!prefix.isEmpty()){
         frameBits << prefix;
     }
@@ -1689,26 +1776,17 @@ QString packHuffMessage(const QString &input, const QVector<bool> prefix, int *n
     int i = 0;
 
     // only pack huff messages that only contain valid chars
-    QString::const_iterator it;
-    QSet<QString> validChars = Varicode::huffValidChars(Varicode::defaultHuffTable());
-    for(it = input.constBegin(); it != input.constEnd(); it++){
-        auto ch = (*it).toUpper();
-        if(!validChars.contains(ch)){
-            if(n) *n = 0;
-            return frame;
-        }
+    if(!isHuffEncodable(input)){
+        if(n) *n = 0;
+        return frame;
     }
 
-    // pack using the default huff table
-    foreach(auto pair, Varicode::huffEncode(Varicode::defaultHuffTable(), input)){
+    // pack using the default huff table, only as much of the input as fits
+    foreach(auto pair, defaultHuffCodec().encode(input, frameSize - frameBits.length())){
         auto charN = pair.first;
         auto charBits = pair.second;
-        if(frameBits.length() + charBits.length() < frameSize){
-            frameBits += charBits;
-            i += charN;
-            continue;
-        }
-        break;
+        frameBits += charBits;
+        i += charN;
     }
 
     qDebug() << "Huff bits" << frameBits.length() << "chars" << i;
@@ -1718,13 +1796,14 @@ QString packHuffMessage(const QString &input, const QVector<bool> prefix, int *n
         // the way we will pad is this...
         // set the bit after the frame to 0 and every bit after that a 1
         // to unpad, seek from the end of the bits until you hit a zero... the rest is the actual frame.
-        for(int i = 0; i < pad; i++){
-            frameBits.append(i == 0 ? (bool)0 : (bool)1);
+        frameBits.append(false);
+        for(int i = 1; i < pad; i += 64){
+            frameBits.append(~quint64(0), qMin(64, pad - i));
         }
     }
 
-    quint64 value = Varicode::bitsToInt(frameBits.constBegin(), 64);
-    quint8 rem = (quint8)Varicode::bitsToInt(frameBits.constBegin() + 64, 8);
+    quint64 value = frameBits.value(0, 64);
+    quint8 rem = (quint8)frameBits.value(64, 8);
     frame = Varicode::pack72bits(value, rem);
 
     if(n) *n = i;
@@ -1732,7 +1811,7 @@ QString packHuffMessage(const QString &input, const QVector<bool> prefix, int *n
     return frame;
 }
 
-QString packCompressedMessage(const QString &input, QVector<bool> prefix, int *n){
+QString packCompressedMessage(const QString &input, BitVector const &prefix, int *n){
     static const int frameSize = 72;
 
     QString frame;
@@ -1743,7 +1822,7 @@ QString packCompressedMessage(const QString &input, QVector<bool> prefix, int *n
     // them for encoding the first two bits of the actuall data sent. boom!
     // The second bit is a flag that indicates this is a compressed frame (dense coding)
     // For fast modes, we don't use the prefix since it is indicated by the JS8CallData flag.
-    QVector<bool> frameBits;
+    BitVector frameBits;
     if(!prefix.isEmpty()){
         frameBits << prefix;
     }
@@ -1769,13 +1848,14 @@ QString packCompressedMessage(const QString &input, QVector<bool> prefix, int *n
         // the way we will pad is this...
         // set the bit after the frame to 0 and every bit after that a 1
         // to unpad, seek from the end of the bits until you hit a zero... the rest is the actual frame.
-        for(int i = 0; i < pad; i++){
-            frameBits.append(i == 0 ? (bool)0 : (bool)1);
+        frameBits.append(false);
+        for(int i = 1; i < pad; i += 64){
+            frameBits.append(~quint64(0), qMin(64, pad - i));
         }
     }
 
-    quint64 value = Varicode::bitsToInt(frameBits.constBegin(), 64);
-    quint8 rem = (quint8)Varicode::bitsToInt(frameBits.constBegin() + 64, 8);
+    quint64 value = frameBits.value(0, 64);
+    quint8 rem = (quint8)frameBits.value(64, 8);
     frame = Varicode::pack72bits(value, rem);
 
     if(n) *n = i;
@@ -1814,7 +1894,9 @@ QString Varicode::unpackDataMessage(const QString &text){
 
     quint8 rem = 0;
     quint64 value = Varicode::unpack72bits(text, &rem);
-    auto bits = Varicode::intToBits(value, 64) + Varicode::intToBits(rem, 8);
+    BitVector bits;
+    bits.append(value, 64);
+    bits.append(rem,    8);
 
     bool isData = bits.at(0);
     if(!isData){
@@ -1880,7 +1962,9 @@ QString Varicode::unpackFastDataMessage(const QString &text){
 
     quint8 rem = 0;
     quint64 value = Varicode::unpack72bits(text, &rem);
-    auto bits = Varicode::intToBits(value, 64) + Varicode::intToBits(rem, 8);
+    BitVector bits;
+    bits.append(value, 64);
+    bits.append(rem,    8);
 
 #if JS8_FAST_DATA_CAN_USE_HUFF
     bool compressed = bits.at(0);
@@ -1909,6 +1993,50 @@ QString Varicode::unpackFastDataMessage(const QString &text){
     return unpacked;
 }
 
+namespace {
+    // the end of the text a frame step could have read past what it
+    // packed: the rest of the word it stopped in and the word after it,
+    // where a dictionary word, a command or a number could go on
+    int frameStepLookahead(QString const &line, int from){
+        int i = qMin(from, line.length());
+        while(i < line.length() && !line.at(i).isSpace()) i++;
+        while(i < line.length() && line.at(i).isSpace()) i++;
+        while(i < line.length() && !line.at(i).isSpace()) i++;
+        return i;
+    }
+
+    // can a step packed from the cached line be used for the line of this step
+    bool canReuseFrameStep(Varicode::FrameStep const &cached, Varicode::FrameStep const &step, bool forceIdentify, int submode){
+        // identified steps pack text that isn't in the line
+        if(cached.identified || cached.frames.isEmpty()){
+            return false;
+        }
+
+        if(cached.first != step.first || cached.hasDirected != step.hasDirected || cached.hasData != step.hasData){
+            return false;
+        }
+
+        // the first frame is identified if our call isn't anywhere in the line
+        if(cached.first && forceIdentify && step.line != cached.line){
+            return false;
+        }
+
+        // the normal data frame is huffman coded only if all of the rest of the line can be
+        if(cached.data && submode == Varicode::JS8CallNormal && cached.huffEncodable != isHuffEncodable(step.line)){
+            return false;
+        }
+
+        int end = frameStepLookahead(cached.line, cached.consumed);
+        if(end >= cached.line.length()){
+            // the step read to the end of the line, which could go on now
+            return step.line == cached.line;
+        }
+
+        // up to and including the space that ended the last word read
+        return step.line.length() > end && step.line.leftRef(end + 1) == cached.line.leftRef(end + 1);
+    }
+}
+
 // TODO: remove the dependence on providing all this data?
 QList<QPair<QString, int>> Varicode::buildMessageFrames(QString const& mycall,
     QString const& mygrid,
@@ -1917,7 +2045,9 @@ QList<QPair<QString, int>> Varicode::buildMessageFrames(QString const& mycall,
     bool forceIdentify,
     bool forceData,
     int submode,
-    MessageInfo *pInfo){
+    MessageInfo *pInfo,
+    FrameCache *pCache,
+    std::function<bool()> isCancelled){
 
     #define ALLOW_SEND_COMPOUND 1
     #define ALLOW_SEND_COMPOUND_DIRECTED 1
@@ -1928,7 +2058,12 @@ QList<QPair<QString, int>> Varicode::buildMessageFrames(QString const& mycall,
 
     bool mycallCompound = Varicode::isCompoundCallsign(mycall);
 
+    // the cached steps were packed for the same station and settings or not at all
+    QString key = QStringList{ mycall, mygrid, selectedCall, QString::number(forceIdentify), QString::number(forceData), QString::number(submode) }.join("\n");
+    FrameCache const *cached = (pCache && pCache->key == key) ? pCache : nullptr;
+
     QList<QPair<QString, int>> allFrames;
+    QStringList packed;
 
 #if JS8_NO_MULTILINE
     // auto lines = text.split(QRegExp("[\\r\\n]"), QString::SkipEmptyParts);
@@ -1997,145 +2132,182 @@ QList<QPair<QString, int>> Varicode::buildMessageFrames(QString const& mycall,
         }
 #endif
 
+        QList<FrameStep> steps;
         while(line.size() > 0){
-          QString frame;
+          // a newer build is waiting, so this one will never be used
+          if(isCancelled && isCancelled()){
+              return {};
+          }
+
+          FrameStep step;
+          step.line = line;
+          step.first = lineFrames.isEmpty();
+          step.hasDirected = hasDirected;
+          step.hasData = hasData;
+
+          int index = steps.length();
+          if(cached && index < cached->steps.length() && canReuseFrameStep(cached->steps.at(index), step, forceIdentify, submode)){
+              // the text this step looked at hasn't changed, so neither have its frames
+              step = cached->steps.at(index);
+              step.line = line;
+          } else {
+              QString frame;
 
-          bool useBcn = false;
+              bool useBcn = false;
 #if ALLOW_SEND_COMPOUND
-          bool useCmp = false;
+              bool useCmp = false;
 #endif
-          bool useDir = false;
-          bool useDat = false;
+              bool useDir = false;
+              bool useDat = false;
 
-          int l = 0;
-          QString bcnFrame = Varicode::packHeartbeatMessage(line, mycall, &l);
+              int l = 0;
+              QString bcnFrame = Varicode::packHeartbeatMessage(line, mycall, &l);
 
 #if ALLOW_SEND_COMPOUND
-          int o = 0;
-          QString cmpFrame = Varicode::packCompoundMessage(line, &o);
+              int o = 0;
+              QString cmpFrame = Varicode::packCompoundMessage(line, &o);
 #endif
 
-          int n = 0;
-          QString dirCmd;
-          QString dirTo;
-          QString dirNum;
-          bool dirToCompound = false;
-          QString dirFrame = Varicode::packDirectedMessage(line, mycall, &dirTo, &dirToCompound, &dirCmd, &dirNum, &n);
-          if(dirToCompound){
-              qDebug() << "directed message to field is compound" << dirTo;
-          }
+              int n = 0;
+              QString dirCmd;
+              QString dirTo;
+              QString dirNum;
+              bool dirToCompound = false;
+              QString dirFrame = Varicode::packDirectedMessage(line, mycall, &dirTo, &dirToCompound, &dirCmd, &dirNum, &n);
+              if(dirToCompound){
+                  qDebug() << "directed message to field is compound" << dirTo;
+              }
 
 #if ALLOW_FORCE_IDENTIFY
-          // if we're sending a data message, then ensure our callsign is included automatically
-          bool isLikelyDataFrame = lineFrames.isEmpty() && selectedCall.isEmpty() && dirTo.isEmpty() && l == 0 && o == 0;
-          if(forceIdentify && isLikelyDataFrame && !line.contains(mycall)){
-              line = QString("%1: %2").arg(mycall).arg(line);
-          }
+              // if we're sending a data message, then ensure our callsign is included automatically
+              bool isLikelyDataFrame = lineFrames.isEmpty() && selectedCall.isEmpty() && dirTo.isEmpty() && l == 0 && o == 0;
+              if(forceIdentify && isLikelyDataFrame && !line.contains(mycall)){
+                  line = QString("%1: %2").arg(mycall).arg(line);
+                  step.identified = true;
+              }
 #endif
-          int m = 0;
-          bool fastDataFrame = false;
-          QString datFrame;
-          // TODO: DEPRECATED in 2.2 (the following release will remove transmission of these frames)
-          if(submode == Varicode::JS8CallNormal){
-              datFrame = Varicode::packDataMessage(line, &m);
-              fastDataFrame = false;
-          } else {
-              datFrame = Varicode::packFastDataMessage(line, &m);
-              fastDataFrame = true;
-          }
+              int m = 0;
+              bool fastDataFrame = false;
+              QString datFrame;
+              // TODO: DEPRECATED in 2.2 (the following release will remove transmission of these frames)
+              if(submode == Varicode::JS8CallNormal){
+                  datFrame = Varicode::packDataMessage(line, &m);
+                  fastDataFrame = false;
+              } else {
+                  datFrame = Varicode::packFastDataMessage(line, &m);
+                  fastDataFrame = true;
+              }
 
-          // if this parses to a standard FT8 free text message
-          // but it can be parsed as a directed message, then we
-          // should send the directed version. if we've already sent
-          // a directed message or a data frame, we will only follow it
-          // with more data frames.
+              // if this parses to a standard FT8 free text message
+              // but it can be parsed as a directed message, then we
+              // should send the directed version. if we've already sent
+              // a directed message or a data frame, we will only follow it
+              // with more data frames.
 
-          if(!hasDirected && !hasData && l > 0){
-              useBcn = true;
-              hasDirected = false;
-              frame = bcnFrame;
-          }
+              if(!hasDirected && !hasData && l > 0){
+                  useBcn = true;
+                  frame = bcnFrame;
+              }
 #if ALLOW_SEND_COMPOUND
-          else if(!hasDirected && !hasData && o > 0){
-              useCmp = true;
-              hasDirected = false;
-              frame = cmpFrame;
-          }
+              else if(!hasDirected && !hasData && o > 0){
+                  useCmp = true;
+                  frame = cmpFrame;
+              }
 #endif
-          else if(!hasDirected && !hasData && n > 0){
-              useDir = true;
-              hasDirected = true;
-              frame = dirFrame;
-          }
-          else if (m > 0) {
-              useDat = true;
-              hasData = true;
-              frame = datFrame;
-          }
+              else if(!hasDirected && !hasData && n > 0){
+                  useDir = true;
+                  frame = dirFrame;
+              }
+              else if (m > 0) {
+                  useDat = true;
+                  frame = datFrame;
+              }
 
-          if(useBcn){
-              lineFrames.append({ frame, Varicode::JS8Call });
-              line = line.mid(l);
-          }
+              if(useBcn){
+                  step.frames.append({ frame, Varicode::JS8Call });
+                  step.consumed = l;
+              }
 
 #if ALLOW_SEND_COMPOUND
-          if(useCmp){
-              lineFrames.append({ frame, Varicode::JS8Call });
-              line = line.mid(o);
-          }
+              if(useCmp){
+                  step.frames.append({ frame, Varicode::JS8Call });
+                  step.consumed = o;
+              }
 #endif
 
-          if(useDir){
-              bool shouldUseStandardFrame = true;
+              if(useDir){
+                  bool shouldUseStandardFrame = true;
 
 #if ALLOW_SEND_COMPOUND_DIRECTED
-              /**
-               * We have a few special cases when we are sending to a compound call, or our call is a compound call, or both.
-               * CASE 0: Non-compound:       KN4CRD: J1Y ACK
-               * -> One standard directed message frame
-               *
-               * CASE 1: Compound From:      KN4CRD/P: J1Y ACK
-               * -> One standard compound frame, followed by a standard directed message frame with placeholder
-               * -> The second standard directed frame _could_ be replaced with a compound directed frame
-               * -> <KN4CRD/P EM73> then <....>: J1Y ACK
-               * -> <KN4CRD/P EM73> then <J1Y ACK>
-               *
-               * CASE 2: Compound To:        KN4CRD: J1Y/P ACK
-               * -> One standard compound frame, followed by a compound directed frame
-               * -> <KN4CRD EM73> then <J1Y/P ACK>
-               *
-               * CASE 3: Compound From & To: KN4CRD/P: J1Y/P ACK
-               * -> One standard compound frame, followed by a compound directed frame
-               * -> <KN4CRD/P EM73> then <J1Y/P ACK>
-               **/
-              if(mycallCompound || dirToCompound){
-                  qDebug() << "compound?" << mycallCompound << dirToCompound;
-                  // Cases 1, 2, 3 all send a standard compound frame first...
-                  QString deCompoundMessage = QString("`%1 %2").arg(mycall).arg(mygrid);
-                  QString deCompoundFrame = Varicode::packCompoundMessage(deCompoundMessage, nullptr);
-                  if(!deCompoundFrame.isEmpty()){
-                      lineFrames.append({ deCompoundFrame, Varicode::JS8Call });
+                  /**
+                   * We have a few special cases when we are sending to a compound call, or our call is a compound call, or both.
+                   * CASE 0: Non-compound:       KN4CRD: J1Y ACK
+                   * -> One standard directed message frame
+                   *
+                   * CASE 1: Compound From:      KN4CRD/P: J1Y ACK
+                   * -> One standard compound frame, followed by a standard directed message frame with placeholder
+                   * -> The second standard directed frame _could_ be replaced with a compound directed frame
+                   * -> <KN4CRD/P EM73> then <....>: J1Y ACK
+                   * -> <KN4CRD/P EM73> then <J1Y ACK>
+                   *
+                   * CASE 2: Compound To:        KN4CRD: J1Y/P ACK
+                   * -> One standard compound frame, followed by a compound directed frame
+                   * -> <KN4CRD EM73> then <J1Y/P ACK>
+                   *
+                   * CASE 3: Compound From & To: KN4CRD/P: J1Y/P ACK
+                   * -> One standard compound frame, followed by a compound directed frame
+                   * -> <KN4CRD/P EM73> then <J1Y/P ACK>
+                   **/
+                  if(mycallCompound || dirToCompound){
+                      qDebug() << "compound?" << mycallCompound << dirToCompound;
+                      // Cases 1, 2, 3 all send a standard compound frame first...
+                      QString deCompoundMessage = QString("`%1 %2").arg(mycall).arg(mygrid);
+                      QString deCompoundFrame = Varicode::packCompoundMessage(deCompoundMessage, nullptr);
+                      if(!deCompoundFrame.isEmpty()){
+                          step.frames.append({ deCompoundFrame, Varicode::JS8Call });
+                      }
+
+                      // Followed, by a standard OR compound directed message...
+                      QString dirCompoundMessage = QString("`%1%2%3").arg(dirTo).arg(dirCmd).arg(dirNum);
+                      QString dirCompoundFrame = Varicode::packCompoundMessage(dirCompoundMessage, nullptr);
+                      if(!dirCompoundFrame.isEmpty()){
+                          step.frames.append({ dirCompoundFrame, Varicode::JS8Call });
+                      }
+                      shouldUseStandardFrame = false;
                   }
+#endif
 
-                  // Followed, by a standard OR compound directed message...
-                  QString dirCompoundMessage = QString("`%1%2%3").arg(dirTo).arg(dirCmd).arg(dirNum);
-                  QString dirCompoundFrame = Varicode::packCompoundMessage(dirCompoundMessage, nullptr);
-                  if(!dirCompoundFrame.isEmpty()){
-                      lineFrames.append({ dirCompoundFrame, Varicode::JS8Call });
+                  if(shouldUseStandardFrame) {
+                      // otherwise, just send the standard directed frame
+                      step.frames.append({ frame, Varicode::JS8Call });
                   }
-                  shouldUseStandardFrame = false;
+
+                  step.consumed = n;
+                  step.directed = true;
+                  step.dirCmd = dirCmd;
+                  step.dirTo = dirTo;
+                  step.dirNum = dirNum;
               }
-#endif
 
-              if(shouldUseStandardFrame) {
-                  // otherwise, just send the standard directed frame
-                  lineFrames.append({ frame, Varicode::JS8Call });
+              if(useDat){
+                  // use the standard data frame
+                  step.frames.append({ frame, fastDataFrame ? Varicode::JS8CallData : Varicode::JS8Call });
+                  step.consumed = m;
+                  step.data = true;
+                  step.huffEncodable = !fastDataFrame && isHuffEncodable(line);
               }
+          }
 
-              line = line.mid(n);
+          steps.append(step);
+          lineFrames.append(step.frames);
+          packed.append(line.left(step.consumed));
+          line = line.mid(step.consumed);
+
+          if(step.directed){
+              hasDirected = true;
 
               // generate a checksum for buffered commands with line data
-              if(Varicode::isCommandBuffered(dirCmd) && !line.isEmpty()){
+              if(Varicode::isCommandBuffered(step.dirCmd) && !line.isEmpty()){
                   qDebug() << "generating checksum for line" << line << line.mid(1);
 
                   // strip leading whitespace after a buffered directed command
@@ -2144,7 +2316,7 @@ QList<QPair<QString, int>> Varicode::buildMessageFrames(QString const& mycall,
                   qDebug() << "before:" << line;
 
 #if 1
-                  int checksumSize = Varicode::isCommandChecksumed(dirCmd);
+                  int checksumSize = Varicode::isCommandChecksumed(step.dirCmd);
 #else
                   int checksumSize = 0;
 #endif
@@ -2155,22 +2327,20 @@ QList<QPair<QString, int>> Varicode::buildMessageFrames(QString const& mycall,
                       line = line + " " + Varicode::checksum16(line);
                   } else if (checksumSize == 0) {
                       // pass
-                      qDebug() << "no checksum required for cmd" << dirCmd;
+                      qDebug() << "no checksum required for cmd" << step.dirCmd;
                   }
                   qDebug() << "after:" << line;
               }
 
               if(pInfo){
-                  pInfo->dirCmd = dirCmd;
-                  pInfo->dirTo = dirTo;
-                  pInfo->dirNum = dirNum;
+                  pInfo->dirCmd = step.dirCmd;
+                  pInfo->dirTo = step.dirTo;
+                  pInfo->dirNum = step.dirNum;
               }
           }
 
-          if(useDat){
-              // use the standard data frame
-              lineFrames.append({ frame, fastDataFrame ? Varicode::JS8CallData : Varicode::JS8Call });
-              line = line.mid(m);
+          if(step.data){
+              hasData = true;
           }
         }
 
@@ -2180,50 +2350,86 @@ QList<QPair<QString, int>> Varicode::buildMessageFrames(QString const& mycall,
         }
 
         allFrames.append(lineFrames);
+
+        if(pCache){
+            pCache->key = key;
+            pCache->steps = steps;
+        }
+    }
+
+    if(pInfo){
+        pInfo->text = packed.join("");
     }
 
     return allFrames;
 }
 
-BuildMessageFramesThread::BuildMessageFramesThread(const QString &mycall,
+BuildMessageFramesWorker::BuildMessageFramesWorker(QObject *parent):
+    QObject(parent),
+    m_queued{false}
+{
+}
+
+/**
+ * @brief BuildMessageFramesWorker::request
+ * replaces the text waiting to be built, starting a build on the worker's thread
+ * if one isn't already waiting there, and cancels the build that's running
+ */
+void BuildMessageFramesWorker::request(const QString &mycall,
     const QString &mygrid,
     const QString &selectedCall,
     const QString &text,
     bool forceIdentify,
     bool forceData,
-    int submode,
-    QObject *parent):
-    QThread(parent),
-    m_mycall{mycall},
-    m_mygrid{mygrid},
-    m_selectedCall{selectedCall},
-    m_text{text},
-    m_forceIdentify{forceIdentify},
-    m_forceData{forceData},
-    m_submode{submode}
+    int submode)
 {
+    QMutexLocker locker(&m_mutex);
+    m_request = { mycall, mygrid, selectedCall, text, forceIdentify, forceData, submode };
+    m_generation.ref();
+
+    if(!m_queued){
+        m_queued = true;
+        QMetaObject::invokeMethod(this, "build", Qt::QueuedConnection);
+    }
 }
 
-void BuildMessageFramesThread::run(){
-    auto results = Varicode::buildMessageFrames(
-        m_mycall,
-        m_mygrid,
-        m_selectedCall,
-        m_text,
-        m_forceIdentify,
-        m_forceData,
-        m_submode
+/**
+ * @brief BuildMessageFramesWorker::cancel
+ * stops the running build without a result
+ */
+void BuildMessageFramesWorker::cancel(){
+    m_generation.ref();
+}
+
+void BuildMessageFramesWorker::build(){
+    Request r;
+    int generation;
+    {
+        QMutexLocker locker(&m_mutex);
+        r = m_request;
+        generation = m_generation.load();
+        m_queued = false;
+    }
+
+    Varicode::MessageInfo info;
+    auto frames = Varicode::buildMessageFrames(
+        r.mycall,
+        r.mygrid,
+        r.selectedCall,
+        r.text,
+        r.forceIdentify,
+        r.forceData,
+        r.submode,
+        &info,
+        &m_cache,
+        [this, generation](){ return m_generation.load() != generation; }
     );
 
-    // TODO: jsherer - we wouldn't normally use decodedtext.h here... but it's useful for computing the actual frames transmitted.
-    QStringList textList;
-    qDebug() << "frames:";
-    foreach(auto frame, results){
-        auto dt = DecodedText(frame.first, frame.second, m_submode);
-        qDebug() << "->" << frame << dt.message() << Varicode::frameTypeString(dt.frameType()) << "submode:" << m_submode;
-        textList.append(dt.message());
+    // a newer request or a cancel came in, the build that follows has the result
+    if(m_generation.load() != generation){
+        return;
     }
 
-    auto transmitText = textList.join("");
-    emit resultReady(transmitText, results.length());
+    qDebug() << "frames:" << frames.length() << info.text;
+    emit resultReady(r.text, info.text, frames.length());
 }
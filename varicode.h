@@ -5,12 +5,18 @@
  * (C) 2018 Jordan Sherer <kn4crd@gmail.com> - All Rights Reserved
  **/
 
+#include <functional>
+
+#include <QAtomicInt>
 #include <QBitArray>
+#include <QMutex>
+#include <QObject>
 #include <QRegularExpression>
 #include <QRegExp>
 #include <QString>
 #include <QVector>
-#include <QThread>
+
+#include "BitVector.h"
 
 
 class Varicode
@@ -21,6 +27,32 @@ public:
         QString dirTo;
         QString dirCmd;
         QString dirNum;
+        QString text;   // the text packed into the frames
+    };
+
+    // one trip through the frame packer: the frames packed from the start
+    // of the line left and how much of it they took
+    struct FrameStep {
+        QString line;                       // the line left before this step
+        bool first = false;                 // no frames packed before it
+        bool hasDirected = false;           // state before this step
+        bool hasData = false;
+
+        int consumed = 0;
+        bool identified = false;            // our call was put in front of the line
+        bool directed = false;
+        bool data = false;
+        bool huffEncodable = false;         // all of line could be huffman coded
+        QString dirCmd;
+        QString dirTo;
+        QString dirNum;
+        QList<QPair<QString, int>> frames;
+    };
+
+    // the steps of the last build, so an edit only packs the frames after it
+    struct FrameCache {
+        QString key;
+        QList<FrameStep> steps;
     };
 
     // submode types
@@ -104,18 +136,17 @@ public:
     static QStringList parseCallsigns(QString const &input);
     static QStringList parseGrids(QString const &input);
 
-    static QList<QPair<int, QVector<bool>>> huffEncode(const QMap<QString, QString> &huff, QString const& text);
-    static QString huffDecode(const QMap<QString, QString> &huff, QVector<bool> const& bitvec);
+    static QList<QPair<int, BitVector>> huffEncode(const QMap<QString, QString> &huff, QString const& text);
+    static QString huffDecode(const QMap<QString, QString> &huff, BitVector const& bitvec);
     static QSet<QString> huffValidChars(const QMap<QString, QString> &huff);
 
-    static QVector<bool> bytesToBits(char * bitvec, int n);
-    static QVector<bool> strToBits(QString const& bitvec);
-    static QString bitsToStr(QVector<bool> const& bitvec);
+    static BitVector bytesToBits(char * bitvec, int n);
+    static BitVector strToBits(QString const& bitvec);
+    static QString bitsToStr(BitVector const& bitvec);
 
-    static QVector<bool> intToBits(quint64 value, int expected=0);
-    static quint64 bitsToInt(QVector<bool> const value);
-    static quint64 bitsToInt(QVector<bool>::ConstIterator start, int n);
-    static QVector<bool> bitsListToBits(QList<QVector<bool>> &list);
+    static BitVector intToBits(quint64 value, int expected=0);
+    static quint64 bitsToInt(BitVector const& value);
+    static BitVector bitsListToBits(QList<BitVector> &list);
 
     static quint8 unpack5bits(QString const& value);
     static QString pack5bits(quint8 packed);
@@ -188,34 +219,60 @@ public:
         bool forceIdentify,
         bool forceData,
         int submode,
-        MessageInfo *pInfo=nullptr);
+        MessageInfo *pInfo=nullptr,
+        FrameCache *pCache=nullptr,
+        std::function<bool()> isCancelled=nullptr);
 };
 
 
-class BuildMessageFramesThread : public QThread
+/**
+ * BuildMessageFramesWorker builds the frames of the text being typed,
+ * on whatever thread it's moved to, to count them while the text is
+ * edited.
+ *
+ * Requests made while a build is running replace each other, and the
+ * running build gives up, so only the latest text is ever built. The
+ * steps of the last build are kept, so an edit only packs the frames
+ * from the edit on.
+ */
+class BuildMessageFramesWorker : public QObject
 {
     Q_OBJECT
 public:
-    BuildMessageFramesThread(QString const& mycall,
-                             QString const& mygrid,
-                             QString const& selectedCall,
-                             QString const& text,
-                             bool forceIdentify,
-                             bool forceData,
-                             int submode,
-                             QObject *parent=nullptr);
-    void run() override;
+    explicit BuildMessageFramesWorker(QObject *parent=nullptr);
+
+    // thread safe
+    void request(QString const& mycall,
+                 QString const& mygrid,
+                 QString const& selectedCall,
+                 QString const& text,
+                 bool forceIdentify,
+                 bool forceData,
+                 int submode);
+    void cancel();
+
 signals:
-    void resultReady(QString, int);
+    void resultReady(QString text, QString transmitText, int frames);
+
+private slots:
+    void build();
 
 private:
-    QString m_mycall;
-    QString m_mygrid;
-    QString m_selectedCall;
-    QString m_text;
-    bool m_forceIdentify;
-    bool m_forceData;
-    int m_submode;
+    struct Request {
+        QString mycall;
+        QString mygrid;
+        QString selectedCall;
+        QString text;
+        bool forceIdentify;
+        bool forceData;
+        int submode;
+    };
+
+    QMutex m_mutex;
+    Request m_request;          // guarded by m_mutex
+    bool m_queued;              // guarded by m_mutex
+    QAtomicInt m_generation;    // bumped by every request and cancel
+    Varicode::FrameCache m_cache;
 };
 
 #endif // VARICODE_H
@@ -0,0 +1,562 @@
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+/**
+ * varicode_bench - checks the compiled huffman codec against the table
+ * scans it replaced and times them both
+ *
+ * Encodes and decodes long free text messages with Varicode::huffEncode
+ * and huffDecode and with the scans they used to do, checking that the
+ * codes and the text come out the same, including for bits that end in
+ * a partial code. Then packs the messages into data frames and unpacks
+ * them again, the way a long message is sent, and reports the frames
+ * per second.
+ *
+ * Then it packs and unpacks the bits of directed and data frames with a
+ * BitVector and with the bool vectors the packers used before it, and
+ * reports the frames per second of each.
+ *
+ * Last it types, edits and backspaces messages a character at a time,
+ * building the frames of every edit with a FrameCache carried from one
+ * edit to the next and from scratch, checking that the frames and the
+ * text packed come out the same, for free text, directed and
+ * multi-word commands, checksummed buffered commands and heartbeats,
+ * with and without a selected call, identify or data forced, and a
+ * compound call of our own.
+ *
+ *   varicode_bench [messages] [characters]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <QCoreApplication>
+#include <QMap>
+#include <QStringList>
+#include <QVector>
+
+#include "jsc.h"
+#include "varicode.h"
+
+namespace {
+    // Varicode::huffEncode before the codec, every key tried at every position
+    QList<QPair<int, BitVector>> scanEncode(const QMap<QString, QString> &huff, QString const& text){
+        QList<QPair<int, BitVector>> out;
+
+        int i = 0;
+
+        auto keys = huff.keys();
+        qSort(keys.begin(), keys.end(), [](QString const &a, QString const &b){
+            auto alen = a.length();
+            auto blen = b.length();
+            if(blen < alen){
+                return true;
+            }
+            if(alen < blen){
+                return false;
+            }
+
+            return b < a;
+        });
+
+        while(i < text.length()){
+            bool found = false;
+            foreach(auto ch, keys){
+                if(text.midRef(i).startsWith(ch)){
+                    out.append({ ch.length(), Varicode::strToBits(huff[ch])});
+                    i += ch.length();
+                    found = true;
+                    break;
+                }
+            }
+
+            if(!found){
+                i++;
+            }
+        }
+
+        return out;
+    }
+
+    // Varicode::huffDecode before the codec, every code tried against a string of the bits
+    QString scanDecode(QMap<QString, QString> const &huff, BitVector const& bitvec){
+        QString text;
+
+        QString bits = Varicode::bitsToStr(bitvec);
+
+        while(bits.length() > 0){
+            bool found = false;
+            foreach(auto key, huff.keys()){
+                if(bits.startsWith(huff[key])){
+                    if(key == QChar('\x04')){
+                        text.append(" ");
+                        found = false;
+                        break;
+                    }
+                    text.append(key);
+                    bits = bits.mid(huff[key].length());
+                    found = true;
+                }
+            }
+            if(!found){
+                break;
+            }
+        }
+
+        return text;
+    }
+
+    // Varicode::intToBits before BitVector
+    QVector<bool> boolIntToBits(quint64 value, int expected){
+        QVector<bool> bits;
+
+        while(value){
+            bits.prepend((bool)(value & 1));
+            value = value >> 1;
+        }
+
+        while(bits.count() < expected){
+            bits.prepend((bool) 0);
+        }
+
+        return bits;
+    }
+
+    // Varicode::bitsToInt before BitVector
+    quint64 boolBitsToInt(QVector<bool>::ConstIterator start, int n){
+        quint64 v = 0;
+        for(int i = 0; i < n; i++){
+            v = (v << 1) + (int)(*start);
+            start++;
+        }
+        return v;
+    }
+
+    // JSC::codeword before BitVector
+    QVector<bool> boolCodeword(quint32 index, bool separate){
+        const quint32 s = 7;
+        const quint32 c = 9;
+
+        QList<QVector<bool>> out;
+        out.prepend(boolIntToBits(((index % s) << 1) + (quint32)separate, 5));
+
+        quint32 x = index / s;
+        while(x > 0){
+            x -= 1;
+            out.prepend(boolIntToBits((x % c) + s, 4));
+            x /= c;
+        }
+
+        QVector<bool> word;
+        foreach(auto w, out){
+            word.append(w);
+        }
+        return word;
+    }
+
+    // the fields of a directed frame, [3][28][28][5],[8], and the words of a data frame
+    struct FrameFields {
+        quint32 flag;
+        quint32 from;
+        quint32 to;
+        quint32 cmd;
+        quint32 extra;
+        quint32 words[8];
+    };
+
+    QVector<FrameFields> frameFields(int count){
+        unsigned seed = 88172645u;
+        auto next = [&seed](){
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            return seed;
+        };
+
+        QVector<FrameFields> out;
+        for(int i = 0; i < count; i++){
+            FrameFields f;
+            f.flag = next() % 8;
+            f.from = next() % (1 << 28);
+            f.to = next() % (1 << 28);
+            f.cmd = next() % 32;
+            f.extra = next() % 256;
+            for(auto &w : f.words){
+                w = next() % JSC::size;
+            }
+            out.append(f);
+        }
+        return out;
+    }
+
+    // the frames packed and unpacked with bool vectors, returning a sum of the fields unpacked
+    quint64 boolFrames(QVector<FrameFields> const &fields){
+        quint64 sum = 0;
+        for(auto const &f : fields){
+            auto bits = (
+                boolIntToBits(f.flag, 3) +
+                boolIntToBits(f.from, 28) +
+                boolIntToBits(f.to, 28) +
+                boolIntToBits(f.cmd, 5)
+            );
+            quint64 value = boolBitsToInt(bits.constBegin(), 64);
+
+            bits = boolIntToBits(value, 64) + boolIntToBits(f.extra, 8);
+            sum += boolBitsToInt(bits.constBegin(), 3);
+            sum += boolBitsToInt(bits.constBegin() + 3, 28);
+            sum += boolBitsToInt(bits.constBegin() + 31, 28);
+            sum += boolBitsToInt(bits.constBegin() + 59, 5);
+            sum += boolBitsToInt(bits.constBegin() + 64, 8);
+
+            QVector<bool> frameBits;
+            for(auto w : f.words){
+                auto word = boolCodeword(w, true);
+                if(frameBits.length() + word.length() >= 72){
+                    break;
+                }
+                frameBits.append(word);
+            }
+            int pad = 72 - frameBits.length();
+            for(int i = 0; i < pad; i++){
+                frameBits.append(i != 0);
+            }
+            value = boolBitsToInt(frameBits.constBegin(), 64);
+            quint8 rem = boolBitsToInt(frameBits.constBegin() + 64, 8);
+
+            bits = boolIntToBits(value, 64) + boolIntToBits(rem, 8);
+            bits = bits.mid(0, bits.lastIndexOf(0));
+            for(int i = 0; i + 4 <= bits.count(); i += 4){
+                auto b = bits.mid(i, 4);
+                quint64 byte = boolBitsToInt(b.constBegin(), 4);
+                sum += byte;
+                if(byte < 7){
+                    i += 1;
+                }
+            }
+        }
+        return sum;
+    }
+
+    // the frames packed and unpacked with BitVector, as the packers do now
+    quint64 packedFrames(QVector<FrameFields> const &fields){
+        quint64 sum = 0;
+        for(auto const &f : fields){
+            BitVector bits;
+            bits.append(f.flag, 3);
+            bits.append(f.from, 28);
+            bits.append(f.to, 28);
+            bits.append(f.cmd, 5);
+            quint64 value = bits.value(0, 64);
+
+            bits.clear();
+            bits.append(value, 64);
+            bits.append(f.extra, 8);
+            sum += bits.value(0, 3);
+            sum += bits.value(3, 28);
+            sum += bits.value(31, 28);
+            sum += bits.value(59, 5);
+            sum += bits.value(64, 8);
+
+            BitVector frameBits;
+            for(auto w : f.words){
+                auto word = JSC::codeword(w, true, 4, 7, 9);
+                if(frameBits.length() + word.length() >= 72){
+                    break;
+                }
+                frameBits.append(word);
+            }
+            int pad = 72 - frameBits.length();
+            frameBits.append(false);
+            for(int i = 1; i < pad; i += 64){
+                frameBits.append(~quint64(0), qMin(64, pad - i));
+            }
+            value = frameBits.value(0, 64);
+            quint8 rem = frameBits.value(64, 8);
+
+            bits.clear();
+            bits.append(value, 64);
+            bits.append(rem, 8);
+            bits = bits.mid(0, bits.lastIndexOf(false));
+            for(int i = 0; i + 4 <= bits.count(); i += 4){
+                quint64 byte = bits.value(i, 4);
+                sum += byte;
+                if(byte < 7){
+                    i += 1;
+                }
+            }
+        }
+        return sum;
+    }
+
+    QStringList messages(int count, int length){
+        QStringList const words = {
+            "CQ", "DE", "KN4CRD", "OH8STN", "K0OG", "VA3OSO", "HELLO", "THE", "WEATHER", "HERE",
+            "IS", "SUNNY", "AND", "WARM", "73", "TNX", "FOR", "QSO", "RIG", "IC-7300", "ANT",
+            "DIPOLE", "PWR", "5W", "NAME", "JORDAN", "QTH", "EM73", "WILL", "QSY", "TO", "7.078",
+            "MHZ", "PSE", "QSL?", "GOOD", "SIGNAL", "+05", "DB", "SEE", "YOU", "AGAIN", "SOON!",
+            "\"QUOTE\"", "A/B", "1234567890",
+        };
+
+        // a fixed xorshift seed so every run packs the same text
+        unsigned seed = 2463534242u;
+        QStringList out;
+        for(int i = 0; i < count; i++){
+            QString text;
+            while(text.length() < length){
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                text += words.at(seed % words.size()) + " ";
+            }
+            out.append(text.left(length));
+        }
+        return out;
+    }
+
+    BitVector joined(QList<QPair<int, BitVector>> const &codes){
+        BitVector bits;
+        for(auto const &code : codes){
+            bits += code.second;
+        }
+        return bits;
+    }
+
+    double seconds(std::chrono::steady_clock::time_point start){
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // the text after each edit of typing text in, changing it in the middle and backspacing it out
+    QStringList edits(QString const &text){
+        QStringList out;
+        for(int i = 1; i <= text.length(); i++){
+            out.append(text.left(i));
+        }
+        for(int i = text.length() - 1; i >= 0; i--){
+            out.append(text.left(i) + text.mid(i + 1));
+        }
+        for(int i = 0; i <= text.length(); i++){
+            if(i == 0 || i == text.length() || text.at(i - 1) == ' '){
+                out.append(text.left(i) + "QSL " + text.mid(i));
+            }
+        }
+        for(int i = text.length() - 1; i > 0; i--){
+            out.append(text.left(i));
+        }
+        return out;
+    }
+
+    struct FrameSettings {
+        QString mycall;
+        QString selectedCall;
+        bool forceIdentify;
+        bool forceData;
+        int submode;
+    };
+
+    bool sameBuild(QList<QPair<QString, int>> const &a, Varicode::MessageInfo const &ai,
+                   QList<QPair<QString, int>> const &b, Varicode::MessageInfo const &bi){
+        return a == b && ai.text == bi.text && ai.dirCmd == bi.dirCmd && ai.dirTo == bi.dirTo && ai.dirNum == bi.dirNum;
+    }
+
+    // the frame packers log every frame
+    void quiet(QtMsgType type, QMessageLogContext const &, QString const &msg){
+        if(type != QtDebugMsg){
+            fprintf(stderr, "%s\n", qPrintable(msg));
+        }
+    }
+}
+
+int main(int argc, char *argv[]){
+    QCoreApplication app(argc, argv);
+    qInstallMessageHandler(quiet);
+
+    int count = argc > 1 ? std::atoi(argv[1]) : 200;
+    int length = argc > 2 ? std::atoi(argv[2]) : 500;
+    if(count <= 0 || length <= 0){
+        fprintf(stderr, "usage: varicode_bench [messages] [characters]\n");
+        return 1;
+    }
+
+    auto huff = Varicode::defaultHuffTable();
+    auto texts = messages(count, length);
+    qint64 chars = qint64(count) * length;
+
+    // codes
+    QList<QList<QPair<int, BitVector>>> before;
+    auto start = std::chrono::steady_clock::now();
+    for(auto const &text : texts){
+        before.append(scanEncode(huff, text));
+    }
+    double encodeBefore = seconds(start);
+
+    QList<QList<QPair<int, BitVector>>> after;
+    start = std::chrono::steady_clock::now();
+    for(auto const &text : texts){
+        after.append(Varicode::huffEncode(huff, text));
+    }
+    double encodeAfter = seconds(start);
+
+    bool ok = true;
+    int mismatch = 0;
+    for(int i = 0; i < count; i++){
+        if(before.at(i) != after.at(i)){
+            mismatch++;
+        }
+    }
+    ok = ok && !mismatch;
+    printf("%d messages of %d characters\n", count, length);
+    printf("%-8s %14s %14s %8s %10s\n", "", "before Mch/s", "after Mch/s", "speedup", "mismatch");
+    printf("%-8s %14.3f %14.3f %7.1fx %10d\n", "encode",
+           chars / encodeBefore / 1e6, chars / encodeAfter / 1e6, encodeBefore / encodeAfter, mismatch);
+
+    // text, from whole messages and from messages cut off mid code
+    QList<BitVector> bits;
+    for(int i = 0; i < count; i++){
+        auto b = joined(after.at(i));
+        if(i % 2){
+            b = b.mid(0, b.size() - 3);
+        }
+        bits.append(b);
+    }
+
+    QStringList decodedBefore;
+    start = std::chrono::steady_clock::now();
+    for(auto const &b : bits){
+        decodedBefore.append(scanDecode(huff, b));
+    }
+    double decodeBefore = seconds(start);
+
+    QStringList decodedAfter;
+    start = std::chrono::steady_clock::now();
+    for(auto const &b : bits){
+        decodedAfter.append(Varicode::huffDecode(huff, b));
+    }
+    double decodeAfter = seconds(start);
+
+    mismatch = 0;
+    for(int i = 0; i < count; i++){
+        if(decodedBefore.at(i) != decodedAfter.at(i) || (i % 2 == 0 && decodedAfter.at(i) != texts.at(i))){
+            mismatch++;
+        }
+    }
+    ok = ok && !mismatch;
+    printf("%-8s %14.3f %14.3f %7.1fx %10d\n", "decode",
+           chars / decodeBefore / 1e6, chars / decodeAfter / 1e6, decodeBefore / decodeAfter, mismatch);
+
+    // data frames, packed and unpacked the way a long message is sent
+    int frames = 0;
+    int unpacked = 0;
+    start = std::chrono::steady_clock::now();
+    for(auto const &text : texts){
+        QString rest = text;
+        while(!rest.isEmpty()){
+            int n = 0;
+            auto frame = Varicode::packDataMessage(rest, &n);
+            if(n <= 0){
+                break;
+            }
+            unpacked += Varicode::unpackDataMessage(frame).length();
+            rest = rest.mid(n);
+            frames++;
+        }
+    }
+    double pack = seconds(start);
+    printf("%d data frames packed and unpacked (%d characters), %.0f frames/s\n", frames, unpacked, frames / pack);
+
+    // frame bits, a directed frame and a data frame of codewords per field set
+    auto fields = frameFields(count * 100);
+
+    start = std::chrono::steady_clock::now();
+    quint64 sumBefore = boolFrames(fields);
+    double bitsBefore = seconds(start);
+
+    start = std::chrono::steady_clock::now();
+    quint64 sumAfter = packedFrames(fields);
+    double bitsAfter = seconds(start);
+
+    mismatch = sumBefore != sumAfter;
+    ok = ok && !mismatch;
+    printf("%-8s %14s %14s %8s %10s\n", "", "before fr/s", "after fr/s", "speedup", "mismatch");
+    printf("%-8s %14.0f %14.0f %7.1fx %10d\n", "bits",
+           2 * fields.size() / bitsBefore, 2 * fields.size() / bitsAfter, bitsBefore / bitsAfter, mismatch);
+
+    // frames of edits, from scratch and with the cache of the edit before
+    QStringList const frameTexts = {
+        "HELLO WORLD HOW ARE YOU 73",
+        "OH8STN QUERY MSGS",
+        "OH8STN QUERY MSGS?",
+        "OH8STN QUERY CALL K0OG?",
+        "OH8STN MSG TO:K0OG SEE YOU AGAIN SOON",
+        "@ALLCALL MSG TO:VA3OSO/P TNX FOR QSO",
+        "OH8STN MSG PSE QSY TO 7.078",
+        "OH8STN GRID EM73",
+        "OH8STN/P SNR? HW CPY?",
+        "CQ CQ CQ EM73",
+        "@HB HEARTBEAT EM73",
+        "KN4CRD: OH8STN ACK",
+    };
+    QList<FrameSettings> const frameSettings = {
+        { "KN4CRD",   "",       false, false, Varicode::JS8CallNormal },
+        { "KN4CRD",   "",       true,  false, Varicode::JS8CallNormal },
+        { "KN4CRD",   "OH8STN", false, false, Varicode::JS8CallNormal },
+        { "KN4CRD",   "",       false, true,  Varicode::JS8CallNormal },
+        { "KN4CRD",   "",       true,  false, Varicode::JS8CallFast   },
+        { "KN4CRD/P", "",       false, false, Varicode::JS8CallNormal },
+    };
+
+    int builds = 0;
+    double uncachedTime = 0;
+    double cachedTime = 0;
+    mismatch = 0;
+    for(auto const &s : frameSettings){
+        for(auto const &text : frameTexts){
+            Varicode::FrameCache cache;
+            for(auto const &edit : edits(text)){
+                Varicode::MessageInfo uncachedInfo;
+                start = std::chrono::steady_clock::now();
+                auto uncached = Varicode::buildMessageFrames(s.mycall, "EM73", s.selectedCall, edit, s.forceIdentify, s.forceData, s.submode, &uncachedInfo);
+                uncachedTime += seconds(start);
+
+                Varicode::MessageInfo cachedInfo;
+                start = std::chrono::steady_clock::now();
+                auto cached = Varicode::buildMessageFrames(s.mycall, "EM73", s.selectedCall, edit, s.forceIdentify, s.forceData, s.submode, &cachedInfo, &cache);
+                cachedTime += seconds(start);
+
+                builds++;
+                if(!sameBuild(uncached, uncachedInfo, cached, cachedInfo)){
+                    if(mismatch < 10){
+                        fprintf(stderr, "cached frames differ: \"%s\" (%s selected \"%s\" identify %d data %d submode %d)\n",
+                                qPrintable(edit), qPrintable(s.mycall), qPrintable(s.selectedCall), s.forceIdentify, s.forceData, s.submode);
+                    }
+                    mismatch++;
+                }
+            }
+        }
+    }
+    ok = ok && !mismatch;
+    printf("%-8s %14s %14s %8s %10s\n", "", "before b/s", "after b/s", "speedup", "mismatch");
+    printf("%-8s %14.0f %14.0f %7.1fx %10d\n", "edits",
+           builds / uncachedTime, builds / cachedTime, uncachedTime / cachedTime, mismatch);
+
+    if(!ok){
+        printf("huffman codec, frame bits or cached frames differ from the code they replaced\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,169 @@
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+/**
+ * waterfall_bench - rows per second of the waterfall renderer
+ *
+ * Times adding a row to the waterfall and painting the plot at a range of
+ * widths, the way CPlotter did it before (scrolling a QPixmap and drawing
+ * each pixel as a point, then copying the 2D overlay) and the way it does
+ * it now (a palette row written into a WaterfallImage scanline).
+ *
+ *   waterfall_bench [-platform offscreen] [rows] [height]
+ */
+
+#include <cstdio>
+
+#include <QColor>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QPixmap>
+#include <QPolygon>
+#include <QStringList>
+#include <QVector>
+
+#include "WaterfallImage.h"
+
+namespace {
+    int const H2 = 100;    // height of the 2D spectrum
+
+    // a spectrum with some structure to it, as palette levels
+    QVector<int> levels(int width, int row){
+        QVector<int> y(width);
+        quint32 seed = 2463534242u + row;
+        for(int i = 0; i < width; i++){
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            y[i] = (seed % 40) + ((i / 50) % 7 == 0 ? 120 : 20);
+        }
+        return y;
+    }
+
+    QPolygon spectrum(QVector<int> const &y){
+        QPolygon line(y.size());
+        for(int i = 0; i < y.size(); i++){
+            line.setPoint(i, i, H2 - y.at(i) * H2 / 255);
+        }
+        return line;
+    }
+
+    double pixmapRows(int width, int height, int rows, QVector<QColor> const &colors){
+        QPixmap screen(width, height + H2);
+        QPixmap waterfall(width, height);
+        QPixmap overlay(width, H2);
+        waterfall.fill(Qt::black);
+        overlay.fill(Qt::black);
+
+        QVector<QVector<int>> data;
+        for(int r = 0; r < 16; r++){
+            data.append(levels(width, r));
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        for(int r = 0; r < rows; r++){
+            auto const &y = data.at(r % data.size());
+
+            waterfall.scroll(0, 1, 0, 0, width, height);
+            {
+                QPainter painter1(&waterfall);
+                for(int i = 0; i < width; i++){
+                    painter1.setPen(colors.at(y.at(i)));
+                    painter1.drawPoint(i, 0);
+                }
+            }
+
+            QPixmap plot2d = overlay.copy(0, 0, width, H2);
+            {
+                QPainter painter2D(&plot2d);
+                painter2D.setPen(Qt::green);
+                painter2D.drawPolyline(spectrum(y));
+            }
+
+            QPainter painter(&screen);
+            painter.drawPixmap(0, 0, waterfall);
+            painter.drawPixmap(0, height, plot2d);
+        }
+        return rows * 1e9 / timer.nsecsElapsed();
+    }
+
+    double scanlineRows(int width, int height, int rows, QVector<QColor> const &colors){
+        QPixmap screen(width, height + H2);
+        WaterfallImage waterfall;
+        QPixmap overlay(width, H2);
+        waterfall.resize(width, height);
+        waterfall.setColors(colors);
+        overlay.fill(Qt::black);
+
+        QVector<QVector<int>> data;
+        for(int r = 0; r < 16; r++){
+            data.append(levels(width, r));
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        for(int r = 0; r < rows; r++){
+            auto const &y = data.at(r % data.size());
+
+            QRgb *row = waterfall.scroll();
+            QRgb const *palette = waterfall.palette();
+            for(int i = 0; i < width; i++){
+                row[i] = palette[y.at(i)];
+            }
+
+            QPolygon line = spectrum(y);
+
+            QPainter painter(&screen);
+            waterfall.draw(painter, 0, 0);
+            painter.drawPixmap(0, height, overlay);
+            painter.translate(0, height);
+            painter.setPen(Qt::green);
+            painter.drawPolyline(line);
+        }
+        return rows * 1e9 / timer.nsecsElapsed();
+    }
+}
+
+int main(int argc, char *argv[]){
+    QGuiApplication app(argc, argv);
+
+    auto args = app.arguments();
+    int rows = args.size() > 1 ? args.at(1).toInt() : 500;
+    int height = args.size() > 2 ? args.at(2).toInt() : 600;
+    if(rows <= 0 || height <= 0){
+        fprintf(stderr, "usage: waterfall_bench [-platform offscreen] [rows] [height]\n");
+        return 1;
+    }
+
+    QVector<QColor> colors;
+    for(int i = 0; i < 256; i++){
+        colors.append(QColor::fromHsv((240 - i * 240 / 255), 255, qMin(255, 64 + i)));
+    }
+
+    printf("%d rows, waterfall height %d\n", rows, height);
+    printf("%8s %14s %14s %8s\n", "width", "pixmap row/s", "scanline row/s", "speedup");
+    foreach(int width, QList<int>({800, 1280, 1920, 2560, 3840})){
+        double before = pixmapRows(width, height, rows, colors);
+        double after = scanlineRows(width, height, rows, colors);
+        printf("%8d %14.0f %14.0f %7.1fx\n", width, before, after, after / before);
+    }
+
+    return 0;
+}